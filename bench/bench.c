@@ -0,0 +1,229 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark harness for the X-macro containers                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#define BENCH_MAIN
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "bench.h"
+
+/// @brief Number of allocation calls done by the containers so far.
+unsigned long bench_allocs = 0;
+
+/// @brief Results of the operations are added here, so that they are
+//  not optimized away.
+volatile unsigned long bench_sink = 0;
+
+/// @brief Everything a benchmark child sends back to the parent.
+struct bench_report
+{
+  unsigned            count;
+  long                peak_rss;
+  struct bench_result results[BENCH_MAX_OPS];
+};
+
+
+void*
+bench_malloc(size_t size)
+{
+  bench_allocs++;
+  return malloc(size);
+}
+
+
+void*
+bench_realloc(void* ptr, size_t size)
+{
+  bench_allocs++;
+  return realloc(ptr, size);
+}
+
+
+void*
+bench_aligned_alloc(size_t alignment, size_t size)
+{
+  bench_allocs++;
+  return aligned_alloc(alignment, size);
+}
+
+
+/// @brief Count an allocation done by a container helper that cannot be
+//  redirected, such as vector_realloc.
+void
+bench_count(size_t size)
+{
+  (void)size;
+  bench_allocs++;
+}
+
+
+/// @brief Return the current time in nanoseconds.
+static double
+bench_now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+/// @brief Start measuring an operation.
+void
+bench_start(struct bench_result* result)
+{
+  result->allocs = bench_allocs;
+  result->start = bench_now();
+}
+
+
+/// @brief Stop measuring an operation that was repeated n times.
+void
+bench_stop(struct bench_result* result, const char* op, unsigned n)
+{
+  result->ns = (bench_now() - result->start) / (n ? n : 1);
+  result->allocs = bench_allocs - result->allocs;
+  result->op = op;
+  result->n = n;
+}
+
+
+/// @brief Run a benchmark in a child process, so that its peak RSS is not
+//  polluted by the previous runs, and get its report through a pipe.
+///
+/// @return 0 if all went ok, 1 otherwise
+static int
+bench_fork(struct bench* b, unsigned n, struct bench_report* report)
+{
+  struct rusage usage;
+  int fd[2];
+  int status = 0;
+  pid_t pid = 0;
+
+  if (pipe(fd) || (pid = fork()) < 0)
+    return 1;
+
+  if (!pid)
+  {
+    close(fd[0]);
+    report->count = b->run(n, report->results);
+    getrusage(RUSAGE_SELF, &usage);
+    report->peak_rss = usage.ru_maxrss;
+    _exit(write(fd[1], report, sizeof (*report)) != sizeof (*report));
+  }
+
+  close(fd[1]);
+  status = read(fd[0], report, sizeof (*report)) != sizeof (*report);
+  close(fd[0]);
+  waitpid(pid, NULL, 0);
+
+  return status;
+}
+
+
+/// @brief Print one line (CSV) or one object (JSON) per operation.
+static void
+bench_print(FILE* out, int json, int* first, struct bench* b,
+            struct bench_report* report)
+{
+  struct bench_result* r = NULL;
+
+  for (unsigned i = 0; i < report->count; i++)
+  {
+    r = &report->results[i];
+    if (json)
+      fprintf(out, "%s\n  {\"container\": \"%s\", \"type\": \"%s\", "
+              "\"size\": %u, \"op\": \"%s\", \"ns_per_op\": %.3f, "
+              "\"mops\": %.3f, \"allocs\": %lu, \"peak_rss_kb\": %ld}",
+              *first ? "" : ",", b->container, b->type, r->n, r->op, r->ns,
+              r->ns ? 1e3 / r->ns : 0, r->allocs, report->peak_rss);
+    else
+      fprintf(out, "%s,%s,%u,%s,%.3f,%.3f,%lu,%ld\n", b->container, b->type,
+              r->n, r->op, r->ns, r->ns ? 1e3 / r->ns : 0, r->allocs,
+              report->peak_rss);
+    *first = 0;
+  }
+}
+
+
+/// @brief Main function of the benchmark harness.
+//  Usage : ./bench [-f csv|json] [-n max_size] [-o output]
+//  Every container is run for each type, for sizes 1e3, 1e4, ... up to
+//  max_size (1e6 by default).
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  struct bench* types[] = { bench_int, bench_blob, bench_ptr };
+  struct bench_report report;
+  unsigned long max = 1000000;
+  FILE* out = stdout;
+  int json = 0;
+  int first = 1;
+  int opt = 0;
+
+  while ((opt = getopt(argc, argv, "f:n:o:")) != -1)
+    switch (opt)
+    {
+      case 'f':
+        json = !strcmp(optarg, "json");
+        break;
+      case 'n':
+        max = strtod(optarg, NULL);
+        break;
+      case 'o':
+        if (!(out = fopen(optarg, "w")))
+        {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-f csv|json] [-n max_size] [-o file]\n",
+                argv[0]);
+        return 1;
+    }
+
+  fprintf(out, json ? "[" : "container,type,size,op,ns_per_op,mops,"
+          "allocs,peak_rss_kb\n");
+
+  for (unsigned t = 0; t < sizeof (types) / sizeof (*types); t++)
+    for (struct bench* b = types[t]; b->container; b++)
+      for (unsigned long n = 1000; n <= max; n *= 10)
+      {
+        fflush(out);
+        if (bench_fork(b, n, &report))
+        {
+          fprintf(stderr, "%s<%s>(%lu) failed\n", b->container, b->type, n);
+          return 1;
+        }
+        bench_print(out, json, &first, b, &report);
+      }
+
+  fprintf(out, json ? "\n]\n" : "");
+  if (out != stdout)
+    fclose(out);
+
+  return 0;
+}
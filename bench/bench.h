@@ -0,0 +1,257 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark harness for the X-macro containers                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+/**
+** @file bench.h
+**
+** @brief Helpers shared by the benchmarks of every container. Each type
+**  under test has its own source file (int.c, blob.c, ptr.c) that
+**  specializes the containers and calls the BENCH_* macros below, which
+**  define one function per container running a fixed sequence of
+**  operations on n elements.
+**
+**  This header must be included *after* the container headers : it
+**  redefines malloc, realloc and aligned_alloc so that the allocations
+**  done by the containers are counted. The vectors allocate through
+**  vector_realloc, compiled before that, and are counted by its hook.
+*/
+
+#ifndef BENCH_H_
+# define BENCH_H_
+
+# include <stdint.h>
+# include <stdlib.h>
+
+/// @brief Maximum number of operations reported by a container.
+# define BENCH_MAX_OPS 8
+
+/// @brief 64-byte element, to see the cost of copying elements around.
+typedef struct
+{
+  unsigned long id;
+  char          pad[56];
+} blob;
+
+/// @brief Measure of a single operation, repeated n times.
+struct bench_result
+{
+  const char*   op;
+  unsigned      n;
+  double        ns;
+  unsigned long allocs;
+  double        start;
+};
+
+/// @brief Run the operations of a container on n elements, fill results
+//  and return the number of operations measured.
+typedef unsigned (*bench_func)(unsigned n, struct bench_result* results);
+
+/// @brief A container specialized for a type.
+struct bench
+{
+  const char* container;
+  const char* type;
+  bench_func  run;
+};
+
+extern struct bench bench_int[];
+extern struct bench bench_blob[];
+extern struct bench bench_ptr[];
+
+extern unsigned long bench_allocs;
+extern volatile unsigned long bench_sink;
+
+void* bench_malloc(size_t size);
+void* bench_realloc(void* ptr, size_t size);
+void* bench_aligned_alloc(size_t alignment, size_t size);
+void bench_count(size_t size);
+
+void bench_start(struct bench_result* result);
+void bench_stop(struct bench_result* result, const char* op, unsigned n);
+
+# ifndef BENCH_MAIN
+#  define malloc(size) bench_malloc(size)
+#  define realloc(ptr, size) bench_realloc(ptr, size)
+#  define aligned_alloc(alignment, size) bench_aligned_alloc(alignment, size)
+# endif
+
+
+/// @brief Conversions between the index of an element and the element.
+static inline int make_int(unsigned i) { return i; }
+static inline unsigned long value_int(int e) { return e; }
+
+static inline blob make_blob(unsigned i) { blob b = { .id = i }; return b; }
+static inline unsigned long value_blob(blob e) { return e.id; }
+
+static inline void* make_ptr(unsigned i) { return (void*)(uintptr_t)i; }
+static inline unsigned long value_ptr(void* e) { return (uintptr_t)e; }
+
+
+/**
+** @brief Define the visitor used by the benchmarks of NAME, that sums the
+**  value of the elements so that the visit cannot be optimized away.
+*/
+# define BENCH_VISITOR(TYPE, NAME, VALUE)                                     \
+  static void NAME##_bench_visit(TYPE elt, void* data)                        \
+  {                                                                           \
+    *(unsigned long*)data += VALUE(elt);                                      \
+  }
+
+
+/**
+** @brief Define bench_NAME for a vector specialized with VECTOR_SOURCE.
+*/
+# define BENCH_VECTOR(TYPE, NAME, MAKE, VALUE)                                \
+  static unsigned bench_##NAME(unsigned n, struct bench_result* r)            \
+  {                                                                           \
+    NAME* vector = NULL;                                                      \
+    unsigned long sum = 0;                                                    \
+                                                                              \
+    vector_alloc_hook = bench_count;                                          \
+    vector = NAME##_create();                                                 \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push_back(vector, MAKE(i));                                      \
+    bench_stop(r++, "push_back", n);                                          \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      sum += VALUE(NAME##_at(vector, i));                                     \
+    bench_stop(r++, "at", n);                                                 \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_assign(vector, i, MAKE(n - i));                                  \
+    bench_stop(r++, "assign", n);                                             \
+                                                                              \
+    bench_start(r);                                                           \
+    NAME##_clear(vector, NULL);                                               \
+    bench_stop(r++, "clear", n);                                              \
+                                                                              \
+    NAME##_delete(vector, NULL);                                              \
+    bench_sink += sum;                                                        \
+                                                                              \
+    return 4;                                                                 \
+  }
+
+
+/**
+** @brief Define bench_NAME for a list specialized with LIST_SOURCE,
+**  LIST_SOURCE_POOLED or ULIST_SOURCE.
+*/
+# define BENCH_LIST(TYPE, NAME, MAKE, VALUE)                                  \
+  BENCH_VISITOR(TYPE, NAME, VALUE)                                            \
+  static unsigned bench_##NAME(unsigned n, struct bench_result* r)            \
+  {                                                                           \
+    NAME* list = NAME##_create();                                             \
+    unsigned long sum = 0;                                                    \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push_back(list, MAKE(i));                                        \
+    bench_stop(r++, "push_back", n);                                          \
+                                                                              \
+    bench_start(r);                                                           \
+    NAME##_visit(list, NAME##_bench_visit, &sum);                             \
+    bench_stop(r++, "visit", n);                                              \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      sum += VALUE(NAME##_pop_front(list));                                   \
+    bench_stop(r++, "pop_front", n);                                          \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push_front(list, MAKE(i));                                       \
+    bench_stop(r++, "push_front", n);                                         \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      sum += VALUE(NAME##_pop_back(list));                                    \
+    bench_stop(r++, "pop_back", n);                                           \
+                                                                              \
+    NAME##_delete(list, NULL);                                                \
+    bench_sink += sum;                                                        \
+                                                                              \
+    return 5;                                                                 \
+  }
+
+
+/**
+** @brief Define bench_NAME for a queue specialized with QUEUE_SOURCE.
+*/
+# define BENCH_QUEUE(TYPE, NAME, MAKE, VALUE)                                 \
+  BENCH_VISITOR(TYPE, NAME, VALUE)                                            \
+  static unsigned bench_##NAME(unsigned n, struct bench_result* r)            \
+  {                                                                           \
+    NAME* queue = NAME##_create();                                            \
+    unsigned long sum = 0;                                                    \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push(queue, MAKE(i));                                            \
+    bench_stop(r++, "push", n);                                               \
+                                                                              \
+    bench_start(r);                                                           \
+    NAME##_visit(queue, NAME##_bench_visit, &sum);                            \
+    bench_stop(r++, "visit", n);                                              \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      sum += VALUE(NAME##_pop(queue));                                        \
+    bench_stop(r++, "pop", n);                                                \
+                                                                              \
+    NAME##_delete(queue, NULL);                                               \
+    bench_sink += sum;                                                        \
+                                                                              \
+    return 3;                                                                 \
+  }
+
+
+/**
+** @brief Define bench_NAME for a stack specialized with STACK_SOURCE.
+*/
+# define BENCH_STACK(TYPE, NAME, MAKE, VALUE)                                 \
+  BENCH_VISITOR(TYPE, NAME, VALUE)                                            \
+  static unsigned bench_##NAME(unsigned n, struct bench_result* r)            \
+  {                                                                           \
+    NAME* stack = NAME##_create();                                            \
+    unsigned long sum = 0;                                                    \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push(stack, MAKE(i));                                            \
+    bench_stop(r++, "push", n);                                               \
+                                                                              \
+    bench_start(r);                                                           \
+    NAME##_visit(stack, NAME##_bench_visit, &sum);                            \
+    bench_stop(r++, "visit", n);                                              \
+                                                                              \
+    bench_start(r);                                                           \
+    for (unsigned i = 0; i < n; i++)                                          \
+      sum += VALUE(NAME##_pop(stack));                                        \
+    bench_stop(r++, "pop", n);                                                \
+                                                                              \
+    NAME##_delete(stack, NULL);                                               \
+    bench_sink += sum;                                                        \
+                                                                              \
+    return 3;                                                                 \
+  }
+
+#endif /* !BENCH_H_ */
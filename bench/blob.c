@@ -0,0 +1,65 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark harness for the X-macro containers                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include "../vector/vector.hxx"
+#include "../list/list.hxx"
+#include "../list/ulist.hxx"
+#include "../queue/queue.hxx"
+#include "../stack/stack.hxx"
+#include "../stack/segstack.hxx"
+#include "bench.h"
+
+/// @brief This macro calls will be replaced at compile-time by the
+//  declarations and definitions of the containers of blob.
+VECTOR_HEADER(blob, vector_blob)
+VECTOR_SOURCE(blob, vector_blob)
+LIST_HEADER(blob, list_blob)
+LIST_SOURCE(blob, list_blob)
+LIST_HEADER_POOLED(blob, plist_blob)
+LIST_SOURCE_POOLED(blob, plist_blob)
+ULIST_HEADER(blob, ulist_blob)
+ULIST_SOURCE(blob, ulist_blob)
+QUEUE_HEADER(blob, queue_blob)
+QUEUE_SOURCE(blob, queue_blob)
+STACK_HEADER(blob, stack_blob)
+STACK_SOURCE(blob, stack_blob)
+SEGSTACK_HEADER(blob, segstack_blob)
+SEGSTACK_SOURCE(blob, segstack_blob)
+
+/// @brief This macro calls will be replaced at compile-time by the
+//  benchmark functions of each container.
+BENCH_VECTOR(blob, vector_blob, make_blob, value_blob)
+BENCH_LIST(blob, list_blob, make_blob, value_blob)
+BENCH_LIST(blob, plist_blob, make_blob, value_blob)
+BENCH_LIST(blob, ulist_blob, make_blob, value_blob)
+BENCH_QUEUE(blob, queue_blob, make_blob, value_blob)
+BENCH_STACK(blob, stack_blob, make_blob, value_blob)
+BENCH_STACK(blob, segstack_blob, make_blob, value_blob)
+
+struct bench bench_blob[] =
+{
+  { "vector", "blob", bench_vector_blob },
+  { "list", "blob", bench_list_blob },
+  { "list_pooled", "blob", bench_plist_blob },
+  { "ulist", "blob", bench_ulist_blob },
+  { "queue", "blob", bench_queue_blob },
+  { "stack", "blob", bench_stack_blob },
+  { "segstack", "blob", bench_segstack_blob },
+  { NULL, NULL, NULL }
+};
@@ -0,0 +1,65 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark harness for the X-macro containers                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include "../vector/vector.hxx"
+#include "../list/list.hxx"
+#include "../list/ulist.hxx"
+#include "../queue/queue.hxx"
+#include "../stack/stack.hxx"
+#include "../stack/segstack.hxx"
+#include "bench.h"
+
+/// @brief This macro calls will be replaced at compile-time by the
+//  declarations and definitions of the containers of int.
+VECTOR_HEADER(int, vector_int)
+VECTOR_SOURCE(int, vector_int)
+LIST_HEADER(int, list_int)
+LIST_SOURCE(int, list_int)
+LIST_HEADER_POOLED(int, plist_int)
+LIST_SOURCE_POOLED(int, plist_int)
+ULIST_HEADER(int, ulist_int)
+ULIST_SOURCE(int, ulist_int)
+QUEUE_HEADER(int, queue_int)
+QUEUE_SOURCE(int, queue_int)
+STACK_HEADER(int, stack_int)
+STACK_SOURCE(int, stack_int)
+SEGSTACK_HEADER(int, segstack_int)
+SEGSTACK_SOURCE(int, segstack_int)
+
+/// @brief This macro calls will be replaced at compile-time by the
+//  benchmark functions of each container.
+BENCH_VECTOR(int, vector_int, make_int, value_int)
+BENCH_LIST(int, list_int, make_int, value_int)
+BENCH_LIST(int, plist_int, make_int, value_int)
+BENCH_LIST(int, ulist_int, make_int, value_int)
+BENCH_QUEUE(int, queue_int, make_int, value_int)
+BENCH_STACK(int, stack_int, make_int, value_int)
+BENCH_STACK(int, segstack_int, make_int, value_int)
+
+struct bench bench_int[] =
+{
+  { "vector", "int", bench_vector_int },
+  { "list", "int", bench_list_int },
+  { "list_pooled", "int", bench_plist_int },
+  { "ulist", "int", bench_ulist_int },
+  { "queue", "int", bench_queue_int },
+  { "stack", "int", bench_stack_int },
+  { "segstack", "int", bench_segstack_int },
+  { NULL, NULL, NULL }
+};
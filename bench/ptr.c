@@ -0,0 +1,65 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark harness for the X-macro containers                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include "../vector/vector.hxx"
+#include "../list/list.hxx"
+#include "../list/ulist.hxx"
+#include "../queue/queue.hxx"
+#include "../stack/stack.hxx"
+#include "../stack/segstack.hxx"
+#include "bench.h"
+
+/// @brief This macro calls will be replaced at compile-time by the
+//  declarations and definitions of the containers of void*.
+VECTOR_HEADER(void*, vector_ptr)
+VECTOR_SOURCE(void*, vector_ptr)
+LIST_HEADER(void*, list_ptr)
+LIST_SOURCE(void*, list_ptr)
+LIST_HEADER_POOLED(void*, plist_ptr)
+LIST_SOURCE_POOLED(void*, plist_ptr)
+ULIST_HEADER(void*, ulist_ptr)
+ULIST_SOURCE(void*, ulist_ptr)
+QUEUE_HEADER(void*, queue_ptr)
+QUEUE_SOURCE(void*, queue_ptr)
+STACK_HEADER(void*, stack_ptr)
+STACK_SOURCE(void*, stack_ptr)
+SEGSTACK_HEADER(void*, segstack_ptr)
+SEGSTACK_SOURCE(void*, segstack_ptr)
+
+/// @brief This macro calls will be replaced at compile-time by the
+//  benchmark functions of each container.
+BENCH_VECTOR(void*, vector_ptr, make_ptr, value_ptr)
+BENCH_LIST(void*, list_ptr, make_ptr, value_ptr)
+BENCH_LIST(void*, plist_ptr, make_ptr, value_ptr)
+BENCH_LIST(void*, ulist_ptr, make_ptr, value_ptr)
+BENCH_QUEUE(void*, queue_ptr, make_ptr, value_ptr)
+BENCH_STACK(void*, stack_ptr, make_ptr, value_ptr)
+BENCH_STACK(void*, segstack_ptr, make_ptr, value_ptr)
+
+struct bench bench_ptr[] =
+{
+  { "vector", "ptr", bench_vector_ptr },
+  { "list", "ptr", bench_list_ptr },
+  { "list_pooled", "ptr", bench_plist_ptr },
+  { "ulist", "ptr", bench_ulist_ptr },
+  { "queue", "ptr", bench_queue_ptr },
+  { "stack", "ptr", bench_stack_ptr },
+  { "segstack", "ptr", bench_segstack_ptr },
+  { NULL, NULL, NULL }
+};
@@ -0,0 +1,190 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the B+tree data structure                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "tree.h"
+
+/// @brief Length of the range scans.
+#define SCAN 100
+
+
+/// @brief Baseline : binary search in a sorted array.
+static unsigned
+lower_bound(const uint64_t* keys, unsigned n, uint64_t key)
+{
+  unsigned lo = 0;
+
+  while (n)
+  {
+    unsigned half = n / 2;
+
+    if (keys[lo + half] < key)
+    {
+      lo += half + 1;
+      n -= half + 1;
+    }
+    else
+      n = half;
+  }
+
+  return lo;
+}
+
+
+/// @brief Visitor of the range scans : sum the values.
+static void
+sum_visitor(uint64_t key, uint64_t value, void* data)
+{
+  *(uint64_t*)data += value;
+}
+
+
+/// @brief splitmix64, to pick pseudo-random positions.
+static uint64_t
+mix(uint64_t i)
+{
+  uint64_t z = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+/// @brief The i-th key, in increasing order with random gaps. Lookups
+//  compute their key rather than reading it from the sorted array, which
+//  would bring in cache the very line the binary search ends on.
+static uint64_t
+key(unsigned i)
+{
+  return 4ull * i + (mix(i) & 3);
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+/// @brief Build a tree of n sorted keys (bulk load and one by one
+//  insertions), then print the ns/op of point lookups and of scans of SCAN
+//  keys for the tree and for binary search in the sorted arrays.
+static void
+bench(unsigned n)
+{
+  uint64_t* keys = malloc(n * sizeof (uint64_t));
+  uint64_t* values = malloc(n * sizeof (uint64_t));
+  tree* t = tree_create();
+  double load = 0;
+  double insert = 0;
+  double t_get = 0;
+  double t_scan = 0;
+  double a_get = 0;
+  double a_scan = 0;
+  uint64_t sum = 0;
+  uint64_t k = 0;
+  unsigned lookups = n < 1000000 ? 1000000 : n;
+  unsigned scans = lookups / SCAN;
+
+  for (unsigned i = 0; i < n; i++)
+  {
+    keys[i] = key(i);
+    values[i] = i;
+  }
+
+  insert = now();
+  for (unsigned i = 0; i < n; i++)
+    tree_insert(t, key(mix(i) % n), i);
+  insert = now() - insert;
+
+  load = now();
+  tree_load(t, keys, values, n);
+  load = now() - load;
+
+  t_get = now();
+  for (unsigned i = 0; i < lookups; i++)
+    sum += *tree_get(t, key(mix(i) % n));
+  t_get = now() - t_get;
+
+  a_get = now();
+  for (unsigned i = 0; i < lookups; i++)
+  {
+    k = key(mix(i) % n);
+    sum += values[lower_bound(keys, n, k)];
+  }
+  a_get = now() - a_get;
+
+  t_scan = now();
+  for (unsigned i = 0; i < scans; i++)
+  {
+    k = key(mix(i) % n);
+    tree_visit_range(t, k, k + 4 * SCAN - 1, sum_visitor, &sum);
+  }
+  t_scan = now() - t_scan;
+
+  a_scan = now();
+  for (unsigned i = 0; i < scans; i++)
+  {
+    k = key(mix(i) % n);
+    for (unsigned j = lower_bound(keys, n, k);
+         j < n && keys[j] <= k + 4 * SCAN - 1; j++)
+      sum += values[j];
+  }
+  a_scan = now() - a_scan;
+
+  printf("%10u %8.1f %8.1f   %8.2f %8.2f   %8.1f %8.1f\n", n, insert / n,
+         load / n, t_get / lookups, a_get / lookups, t_scan / scans,
+         a_scan / scans);
+  fprintf(stderr, "%lu\r", (unsigned long)sum);
+
+  tree_delete(t, NULL);
+  free(keys);
+  free(values);
+}
+
+
+/// @brief Main function to benchmark the B+tree against binary search in
+//  a sorted array, from 1000 keys to max keys.
+//  Usage : ./bench [max]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned max = 10000000;
+
+  if (argc > 1)
+    max = strtoul(argv[1], NULL, 10);
+
+  printf("\033[33m > B+tree (%u bytes nodes) vs sorted array, ns/op, "
+         "scans of %u keys\033[37m :\n\n", BTREE_NODE_BYTES, SCAN);
+  printf("%10s %8s %8s   %8s %8s   %8s %8s\n", "keys", "insert", "load",
+         "get", "bsearch", "visit", "scan");
+
+  for (unsigned n = 1000; n <= max; n *= 10)
+    bench(n);
+
+  return 0;
+}
@@ -0,0 +1,882 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of B+trees (ordered maps) using X-macros              **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file btree.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  ordered maps, based on B+trees. Every node is an array of about
+**  BTREE_NODE_BYTES bytes : inner nodes hold keys and children, leaves hold
+**  keys and values and are linked together, so that an ordered visit is a
+**  walk through the leaves. Looking a key up touches one node per level,
+**  instead of one node per key as a binary tree would.
+**
+**  After specialization, assuming that you used NAME as the name of the
+**  structure, the names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_delete
+**    ~ NAME_clear
+**    ~ NAME_load
+**
+**    ~ NAME_visit
+**    ~ NAME_visit_range
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**
+**    ~ NAME_get
+**    ~ NAME_contains
+**
+**    ~ NAME_insert
+**    ~ NAME_erase
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef BTREE_HXX_
+# define BTREE_HXX_
+
+# include <stdlib.h>
+# include <string.h>
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Approximate size in bytes of the arrays of a node : a few cache
+**  lines by default. Define it before including btree.hxx to change it
+**  (4096 gives page-sized nodes).
+*/
+# ifndef BTREE_NODE_BYTES
+#  define BTREE_NODE_BYTES 512
+# endif
+
+/**
+** @brief Maximum depth of a tree, way more than enough for 2^32 keys.
+*/
+# define BTREE_MAX_HEIGHT 32
+
+/**
+** @brief Ask for every cache line of the n keys of a node at once, so that
+**  the misses of the binary search overlap instead of following each other.
+*/
+static inline void btree_prefetch(const void* keys, size_t size)
+{
+# if defined(__GNUC__)
+  for (const char* p = keys; p < (const char*)keys + size; p += 64)
+    __builtin_prefetch(p);
+# else
+  (void)keys;
+  (void)size;
+# endif
+}
+
+/**
+** @brief Number of entries of a leaf and of keys of an inner node (never
+**  less than 4).
+*/
+# define BTREE_LEAF_CAPACITY(KEY, VALUE)                                      \
+  (BTREE_NODE_BYTES / (sizeof (KEY) + sizeof (VALUE)) < 4 ? 4                 \
+   : BTREE_NODE_BYTES / (sizeof (KEY) + sizeof (VALUE)))
+
+# define BTREE_INNER_CAPACITY(KEY)                                            \
+  (BTREE_NODE_BYTES / (sizeof (KEY) + sizeof (void*)) < 4 ? 4                 \
+   : BTREE_NODE_BYTES / (sizeof (KEY) + sizeof (void*)))
+
+/**
+** @brief Ready-to-use comparison function for integer keys. CMP functions
+**  return a negative number, 0 or a positive number when a is lower, equal
+**  or greater than b.
+*/
+static inline int btree_cmp_int(long long a, long long b)
+{
+  return (a > b) - (a < b);
+}
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  B+tree data structure. As mentionned in the README, you should create a
+**  header file for your "specialized" structure, include btree.hxx and call
+**  this macro.
+**
+** @param KEY Is the type of the keys.
+** @param VALUE Is the type of the values.
+** @param CMP Is a function (or a macro) comparing two KEYs (see
+**  btree_cmp_int).
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro. For exemple :
+**
+**    BTREE_HEADER(int, double, btree_cmp_int, tree)
+**
+**  As for hash maps, the visitor and destructor types are named
+**  NAME_visitor_func and NAME_destructor_func.
+*/
+# define BTREE_HEADER(KEY, VALUE, CMP, NAME)                                  \
+  typedef struct NAME NAME;                                                   \
+  typedef struct s_leaf_##NAME s_leaf_##NAME;                                 \
+  typedef struct s_inner_##NAME s_inner_##NAME;                               \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    void*           root;                                                     \
+    unsigned        height;                                                   \
+    unsigned        count;                                                    \
+    s_leaf_##NAME*  first;                                                    \
+  };                                                                          \
+                                                                              \
+  struct s_leaf_##NAME                                                        \
+  {                                                                           \
+    unsigned        count;                                                    \
+    s_leaf_##NAME*  previous;                                                 \
+    s_leaf_##NAME*  next;                                                     \
+    KEY             keys[BTREE_LEAF_CAPACITY(KEY, VALUE)];                    \
+    VALUE           values[BTREE_LEAF_CAPACITY(KEY, VALUE)];                  \
+  };                                                                          \
+                                                                              \
+  struct s_inner_##NAME                                                       \
+  {                                                                           \
+    unsigned        count;                                                    \
+    KEY             keys[BTREE_INNER_CAPACITY(KEY)];                          \
+    void*           children[BTREE_INNER_CAPACITY(KEY) + 1];                  \
+  };                                                                          \
+                                                                              \
+  typedef void (*NAME##_visitor_func)(KEY, VALUE, void*);                     \
+  typedef void (*NAME##_destructor_func)(KEY, VALUE);                         \
+                                                                              \
+  BTREE_CREATE_HEADER(KEY, VALUE, NAME);                                      \
+  BTREE_DELETE_HEADER(KEY, VALUE, NAME);                                      \
+  BTREE_CLEAR_HEADER(KEY, VALUE, NAME);                                       \
+  BTREE_LOAD_HEADER(KEY, VALUE, NAME);                                        \
+  BTREE_VISIT_HEADER(KEY, VALUE, NAME);                                       \
+  BTREE_VISIT_RANGE_HEADER(KEY, VALUE, NAME);                                 \
+  BTREE_EMPTY_HEADER(KEY, VALUE, NAME);                                       \
+  BTREE_SIZE_HEADER(KEY, VALUE, NAME);                                        \
+  BTREE_GET_HEADER(KEY, VALUE, NAME);                                         \
+  BTREE_CONTAINS_HEADER(KEY, VALUE, NAME);                                    \
+  BTREE_INSERT_HEADER(KEY, VALUE, NAME);                                      \
+  BTREE_ERASE_HEADER(KEY, VALUE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on B+trees. Call it with the *same
+**  arguments* as BTREE_HEADER.
+*/
+# define BTREE_SOURCE(KEY, VALUE, CMP, NAME)                                  \
+  BTREE_SEARCH(KEY, VALUE, CMP, NAME)                                         \
+  BTREE_FIND_LEAF(KEY, VALUE, CMP, NAME)                                      \
+  BTREE_FREE_NODE(KEY, VALUE, NAME)                                           \
+  BTREE_CREATE(KEY, VALUE, NAME)                                              \
+  BTREE_DELETE(KEY, VALUE, NAME)                                              \
+  BTREE_CLEAR(KEY, VALUE, NAME)                                               \
+  BTREE_LOAD(KEY, VALUE, NAME)                                                \
+  BTREE_VISIT(KEY, VALUE, NAME)                                               \
+  BTREE_VISIT_RANGE(KEY, VALUE, CMP, NAME)                                    \
+  BTREE_EMPTY(KEY, VALUE, NAME)                                               \
+  BTREE_SIZE(KEY, VALUE, NAME)                                                \
+  BTREE_GET(KEY, VALUE, CMP, NAME)                                            \
+  BTREE_CONTAINS(KEY, VALUE, NAME)                                            \
+  BTREE_INSERT(KEY, VALUE, CMP, NAME)                                         \
+  BTREE_ERASE(KEY, VALUE, CMP, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define BTREE_CREATE_HEADER(KEY, VALUE, NAME)                                \
+  NAME* NAME##_create()
+
+# define BTREE_DELETE_HEADER(KEY, VALUE, NAME)                                \
+  void NAME##_delete(NAME* tree, NAME##_destructor_func dest)
+
+# define BTREE_CLEAR_HEADER(KEY, VALUE, NAME)                                 \
+  void NAME##_clear(NAME* tree, NAME##_destructor_func dest)
+
+# define BTREE_LOAD_HEADER(KEY, VALUE, NAME)                                  \
+  bool NAME##_load(NAME* tree, const KEY* keys, const VALUE* values,          \
+                   unsigned n)
+
+
+// Visiting
+
+# define BTREE_VISIT_HEADER(KEY, VALUE, NAME)                                 \
+  void NAME##_visit(NAME* tree, NAME##_visitor_func v, void* data)
+
+# define BTREE_VISIT_RANGE_HEADER(KEY, VALUE, NAME)                           \
+  void NAME##_visit_range(NAME* tree, KEY lo, KEY hi,                         \
+                          NAME##_visitor_func v, void* data)
+
+
+// Capacity
+
+# define BTREE_EMPTY_HEADER(KEY, VALUE, NAME)                                 \
+  bool NAME##_empty(NAME* tree)
+
+# define BTREE_SIZE_HEADER(KEY, VALUE, NAME)                                  \
+  unsigned NAME##_size(NAME* tree)
+
+
+// Lookup
+
+# define BTREE_GET_HEADER(KEY, VALUE, NAME)                                   \
+  VALUE* NAME##_get(NAME* tree, KEY key)
+
+# define BTREE_CONTAINS_HEADER(KEY, VALUE, NAME)                              \
+  bool NAME##_contains(NAME* tree, KEY key)
+
+
+// Modifiers
+
+# define BTREE_INSERT_HEADER(KEY, VALUE, NAME)                                \
+  bool NAME##_insert(NAME* tree, KEY key, VALUE value)
+
+# define BTREE_ERASE_HEADER(KEY, VALUE, NAME)                                 \
+  bool NAME##_erase(NAME* tree, KEY key, NAME##_destructor_func dest)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Binary searches in the keys of a node : NAME_lower returns the
+**  position of the first key >= key, NAME_upper the position of the first
+**  key > key (which is also the index of the child to follow in an inner
+**  node). The loops have a fixed number of iterations for a given n and no
+**  branch depending on the keys, so they compile to conditional moves.
+*/
+# define BTREE_SEARCH(KEY, VALUE, CMP, NAME)                                  \
+  static inline unsigned NAME##_lower(const KEY* keys, unsigned n, KEY key)   \
+  {                                                                           \
+    unsigned base = 0;                                                        \
+    unsigned half = 0;                                                        \
+                                                                              \
+    if (!n)                                                                   \
+      return 0;                                                               \
+                                                                              \
+    while (n > 1)                                                             \
+    {                                                                         \
+      half = n / 2;                                                           \
+      base = CMP(keys[base + half], key) < 0 ? base + half : base;            \
+      n -= half;                                                              \
+    }                                                                         \
+                                                                              \
+    return base + (CMP(keys[base], key) < 0);                                 \
+  }                                                                           \
+                                                                              \
+  static inline unsigned NAME##_upper(const KEY* keys, unsigned n, KEY key)   \
+  {                                                                           \
+    unsigned base = 0;                                                        \
+    unsigned half = 0;                                                        \
+                                                                              \
+    if (!n)                                                                   \
+      return 0;                                                               \
+                                                                              \
+    while (n > 1)                                                             \
+    {                                                                         \
+      half = n / 2;                                                           \
+      base = CMP(keys[base + half], key) <= 0 ? base + half : base;           \
+      n -= half;                                                              \
+    }                                                                         \
+                                                                              \
+    return base + (CMP(keys[base], key) <= 0);                                \
+  }
+
+
+/**
+** @brief Walk down from the root to the leaf that may hold key. If path is
+**  not NULL, the inner nodes and the index of the child followed in each
+**  of them are stored in path / index (from the root).
+*/
+# define BTREE_FIND_LEAF(KEY, VALUE, CMP, NAME)                               \
+  static s_leaf_##NAME* NAME##_find_leaf(NAME* tree, KEY key,                 \
+                                         s_inner_##NAME** path,               \
+                                         unsigned* index)                     \
+  {                                                                           \
+    void* node = tree->root;                                                  \
+    s_inner_##NAME* inner = NULL;                                             \
+    s_leaf_##NAME* leaf = NULL;                                               \
+    unsigned i = 0;                                                           \
+                                                                              \
+    for (unsigned h = 0; h < tree->height; h++)                               \
+    {                                                                         \
+      inner = node;                                                           \
+      btree_prefetch(inner->keys, inner->count * sizeof (KEY));               \
+      i = NAME##_upper(inner->keys, inner->count, key);                       \
+      if (path)                                                               \
+      {                                                                       \
+        path[h] = inner;                                                      \
+        index[h] = i;                                                         \
+      }                                                                       \
+      node = inner->children[i];                                              \
+    }                                                                         \
+                                                                              \
+    leaf = node;                                                              \
+    btree_prefetch(leaf->keys, leaf->count * sizeof (KEY));                   \
+    return leaf;                                                              \
+  }
+
+
+/**
+** @brief Free a sub-tree of the given height, calling the destructor on
+**  each entry of its leaves if one is given.
+*/
+# define BTREE_FREE_NODE(KEY, VALUE, NAME)                                    \
+  static void NAME##_free_node(void* node, unsigned height,                   \
+                               NAME##_destructor_func dest)                   \
+  {                                                                           \
+    s_inner_##NAME* inner = node;                                             \
+    s_leaf_##NAME* leaf = node;                                               \
+                                                                              \
+    if (height)                                                               \
+      for (unsigned i = 0; i <= inner->count; i++)                            \
+        NAME##_free_node(inner->children[i], height - 1, dest);               \
+    else if (dest)                                                            \
+      for (unsigned i = 0; i < leaf->count; i++)                              \
+        dest(leaf->keys[i], leaf->values[i]);                                 \
+                                                                              \
+    free(node);                                                               \
+  }
+
+
+/**
+** @brief Create a new, empty tree. No node is allocated until the first
+**  entry is inserted.
+**
+** @return a pointer on the new allocated tree. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define BTREE_CREATE(KEY, VALUE, NAME)                                       \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    NAME* new_tree = malloc(sizeof (NAME));                                   \
+                                                                              \
+    if (!new_tree)                                                            \
+      return NULL;                                                            \
+                                                                              \
+    new_tree->root = NULL;                                                    \
+    new_tree->height = 0;                                                     \
+    new_tree->count = 0;                                                      \
+    new_tree->first = NULL;                                                   \
+                                                                              \
+    return new_tree;                                                          \
+  }
+
+
+/**
+** @brief Clear the tree, then free it.
+**
+** @param tree The tree to delete
+** @param dest The function pointer to call on each entry so as to delete
+**  it if needed (this pointer could be NULL if no freeing is needed).
+*/
+# define BTREE_DELETE(KEY, VALUE, NAME)                                       \
+  void NAME##_delete(NAME* tree, NAME##_destructor_func dest)                 \
+  {                                                                           \
+    NAME##_clear(tree, dest);                                                 \
+    free(tree);                                                               \
+  }
+
+
+/**
+** @brief Free every node of the tree, calling the destructor on each entry
+**  if one is given.
+*/
+# define BTREE_CLEAR(KEY, VALUE, NAME)                                        \
+  void NAME##_clear(NAME* tree, NAME##_destructor_func dest)                  \
+  {                                                                           \
+    if (tree->root)                                                           \
+      NAME##_free_node(tree->root, tree->height, dest);                       \
+                                                                              \
+    tree->root = NULL;                                                        \
+    tree->height = 0;                                                         \
+    tree->count = 0;                                                          \
+    tree->first = NULL;                                                       \
+  }
+
+
+/**
+** @brief Replace the content of the tree by the n entries of keys / values,
+**  that must be sorted by strictly increasing keys. The tree is built
+**  bottom-up in O(n) : leaves are filled one after the other, then each
+**  level of inner nodes is built from the level bellow, until a single
+**  node is left.
+**
+** @return TRUE if all went ok, FALSE if an allocation failed (the tree is
+**  then empty).
+*/
+# define BTREE_LOAD(KEY, VALUE, NAME)                                         \
+  bool NAME##_load(NAME* tree, const KEY* keys, const VALUE* values,          \
+                   unsigned n)                                                \
+  {                                                                           \
+    const unsigned leaf_cap = BTREE_LEAF_CAPACITY(KEY, VALUE);                \
+    const unsigned inner_cap = BTREE_INNER_CAPACITY(KEY);                     \
+    unsigned count = (n + leaf_cap - 1) / leaf_cap;                           \
+    unsigned nodes = 0;                                                       \
+    unsigned i = 0;                                                           \
+    unsigned j = 0;                                                           \
+    unsigned end = 0;                                                         \
+    void** level = NULL;                                                      \
+    KEY* low = NULL;                                                          \
+    s_leaf_##NAME* leaf = NULL;                                               \
+    s_inner_##NAME* inner = NULL;                                             \
+                                                                              \
+    NAME##_clear(tree, NULL);                                                 \
+    if (!n)                                                                   \
+      return TRUE;                                                            \
+                                                                              \
+    if (!(level = malloc(count * sizeof (void*)))                             \
+        || !(low = malloc(count * sizeof (KEY))))                             \
+    {                                                                         \
+      free(level);                                                            \
+      return FALSE;                                                           \
+    }                                                                         \
+                                                                              \
+    for (j = 0; j < count; j++)                                               \
+    {                                                                         \
+      if (!(leaf = malloc(sizeof (s_leaf_##NAME))))                           \
+      {                                                                       \
+        count = j;                                                            \
+        i = 0;                                                                \
+        j = 0;                                                                \
+        goto fail;                                                            \
+      }                                                                       \
+      i = j * leaf_cap;                                                       \
+      leaf->count = n - i < leaf_cap ? n - i : leaf_cap;                      \
+      leaf->previous = j ? level[j - 1] : NULL;                               \
+      leaf->next = NULL;                                                      \
+      if (j)                                                                  \
+        leaf->previous->next = leaf;                                          \
+      else                                                                    \
+        tree->first = leaf;                                                   \
+      memcpy(leaf->keys, keys + i, leaf->count * sizeof (KEY));               \
+      memcpy(leaf->values, values + i, leaf->count * sizeof (VALUE));         \
+      level[j] = leaf;                                                        \
+      low[j] = leaf->keys[0];                                                 \
+    }                                                                         \
+    i = 0;                                                                    \
+                                                                              \
+    /* Children are spread evenly, so that no inner node is left nearly */    \
+    /* empty at the end of a level.                                      */   \
+    while (count > 1)                                                         \
+    {                                                                         \
+      nodes = (count + inner_cap) / (inner_cap + 1);                          \
+      for (j = 0; j < nodes; j++)                                             \
+      {                                                                       \
+        i = (unsigned long long)count * j / nodes;                            \
+        end = (unsigned long long)count * (j + 1) / nodes;                    \
+        if (!(inner = malloc(sizeof (s_inner_##NAME))))                       \
+          goto fail;                                                          \
+        inner->count = end - i - 1;                                           \
+        memcpy(inner->children, level + i, (end - i) * sizeof (void*));       \
+        memcpy(inner->keys, low + i + 1, inner->count * sizeof (KEY));        \
+        level[j] = inner;                                                     \
+        low[j] = low[i];                                                      \
+      }                                                                       \
+      i = 0;                                                                  \
+      count = nodes;                                                          \
+      tree->height++;                                                         \
+    }                                                                         \
+                                                                              \
+    tree->root = level[0];                                                    \
+    tree->count = n;                                                          \
+    free(level);                                                              \
+    free(low);                                                                \
+    return TRUE;                                                              \
+                                                                              \
+    /* level[0, j) holds the nodes built on the current level, and */         \
+    /* level[i, count) the nodes of the level bellow not used yet.  */        \
+  fail:                                                                       \
+    for (unsigned c = 0; c < j; c++)                                          \
+      NAME##_free_node(level[c], tree->height + 1, NULL);                     \
+    for (unsigned c = i; c < count; c++)                                      \
+      NAME##_free_node(level[c], tree->height, NULL);                         \
+    free(level);                                                              \
+    free(low);                                                                \
+    tree->height = 0;                                                         \
+    tree->first = NULL;                                                       \
+    return FALSE;                                                             \
+  }
+
+
+/**
+** @brief Call the visitor on each entry of the tree, by increasing keys.
+*/
+# define BTREE_VISIT(KEY, VALUE, NAME)                                        \
+  void NAME##_visit(NAME* tree, NAME##_visitor_func v, void* data)            \
+  {                                                                           \
+    for (s_leaf_##NAME* leaf = tree->first; leaf; leaf = leaf->next)          \
+      for (unsigned i = 0; i < leaf->count; i++)                              \
+        v(leaf->keys[i], leaf->values[i], data);                              \
+  }
+
+
+/**
+** @brief Call the visitor on each entry whose key is in [lo, hi], by
+**  increasing keys. The first leaf is found from the root, then the scan
+**  follows the links between leaves.
+*/
+# define BTREE_VISIT_RANGE(KEY, VALUE, CMP, NAME)                             \
+  void NAME##_visit_range(NAME* tree, KEY lo, KEY hi,                         \
+                          NAME##_visitor_func v, void* data)                  \
+  {                                                                           \
+    s_leaf_##NAME* leaf = NULL;                                               \
+    unsigned i = 0;                                                           \
+                                                                              \
+    if (!tree->root)                                                          \
+      return;                                                                 \
+                                                                              \
+    leaf = NAME##_find_leaf(tree, lo, NULL, NULL);                            \
+    i = NAME##_lower(leaf->keys, leaf->count, lo);                            \
+                                                                              \
+    for (; leaf; leaf = leaf->next, i = 0)                                    \
+      for (; i < leaf->count; i++)                                            \
+      {                                                                       \
+        if (CMP(leaf->keys[i], hi) > 0)                                       \
+          return;                                                             \
+        v(leaf->keys[i], leaf->values[i], data);                              \
+      }                                                                       \
+  }
+
+
+/**
+** @return TRUE (1) if the tree is empty (or NULL) and 0 otherwise
+*/
+# define BTREE_EMPTY(KEY, VALUE, NAME)                                        \
+  bool NAME##_empty(NAME* tree)                                               \
+  {                                                                           \
+    return !(tree && tree->count);                                            \
+  }
+
+
+/**
+** @return the number of entries in the tree
+*/
+# define BTREE_SIZE(KEY, VALUE, NAME)                                         \
+  unsigned NAME##_size(NAME* tree)                                            \
+  {                                                                           \
+    return tree->count;                                                       \
+  }
+
+
+/**
+** @brief Return a pointer on the value associated to key, or NULL if key is
+**  not in the tree. The pointer is valid until the next insertion or erase.
+*/
+# define BTREE_GET(KEY, VALUE, CMP, NAME)                                     \
+  VALUE* NAME##_get(NAME* tree, KEY key)                                      \
+  {                                                                           \
+    s_leaf_##NAME* leaf = NULL;                                               \
+    unsigned i = 0;                                                           \
+                                                                              \
+    if (!tree->root)                                                          \
+      return NULL;                                                            \
+                                                                              \
+    leaf = NAME##_find_leaf(tree, key, NULL, NULL);                           \
+    i = NAME##_lower(leaf->keys, leaf->count, key);                           \
+                                                                              \
+    if (i < leaf->count && !CMP(leaf->keys[i], key))                          \
+      return &leaf->values[i];                                                \
+                                                                              \
+    return NULL;                                                              \
+  }
+
+
+/**
+** @return TRUE if key is in the tree, FALSE otherwise.
+*/
+# define BTREE_CONTAINS(KEY, VALUE, NAME)                                     \
+  bool NAME##_contains(NAME* tree, KEY key)                                   \
+  {                                                                           \
+    return NAME##_get(tree, key) != NULL;                                     \
+  }
+
+
+/**
+** @brief Associate value to key, replacing the previous value if key was
+**  already in the tree. A full leaf is split in two halves, and the new
+**  separator is inserted in the parent, which may be split in turn, up to
+**  the root.
+**
+** @return TRUE if key was inserted, FALSE if it was already in the tree or
+**  if an allocation failed (the tree is then left unchanged).
+*/
+# define BTREE_INSERT(KEY, VALUE, CMP, NAME)                                  \
+  bool NAME##_insert(NAME* tree, KEY key, VALUE value)                        \
+  {                                                                           \
+    s_inner_##NAME* path[BTREE_MAX_HEIGHT];                                   \
+    unsigned index[BTREE_MAX_HEIGHT];                                         \
+    s_inner_##NAME* spare[BTREE_MAX_HEIGHT + 1];                              \
+    unsigned spares = 0;                                                      \
+    s_leaf_##NAME* leaf = NULL;                                               \
+    s_leaf_##NAME* half = NULL;                                               \
+    s_inner_##NAME* inner = NULL;                                             \
+    s_inner_##NAME* split = NULL;                                             \
+    void* child = NULL;                                                       \
+    KEY up;                                                                   \
+    KEY middle;                                                               \
+    unsigned i = 0;                                                           \
+    unsigned h = 0;                                                           \
+    unsigned mid = 0;                                                         \
+                                                                              \
+    if (!tree->root)                                                          \
+    {                                                                         \
+      if (!(leaf = malloc(sizeof (s_leaf_##NAME))))                           \
+        return FALSE;                                                         \
+      leaf->count = 0;                                                        \
+      leaf->previous = NULL;                                                  \
+      leaf->next = NULL;                                                      \
+      tree->root = leaf;                                                      \
+      tree->first = leaf;                                                     \
+    }                                                                         \
+                                                                              \
+    leaf = NAME##_find_leaf(tree, key, path, index);                          \
+    i = NAME##_lower(leaf->keys, leaf->count, key);                           \
+    if (i < leaf->count && !CMP(leaf->keys[i], key))                          \
+    {                                                                         \
+      leaf->values[i] = value;                                                \
+      return FALSE;                                                           \
+    }                                                                         \
+                                                                              \
+    /* Every node needed by the splits is allocated before anything is */     \
+    /* modified : one per full ancestor, plus a new root if they all    */    \
+    /* are.                                                             */    \
+    if (leaf->count == BTREE_LEAF_CAPACITY(KEY, VALUE))                       \
+    {                                                                         \
+      for (h = tree->height;                                                  \
+           h && path[h - 1]->count == BTREE_INNER_CAPACITY(KEY); h--)         \
+        spares++;                                                             \
+      spares += !h;                                                           \
+                                                                              \
+      for (unsigned s = 0; s < spares; s++)                                   \
+        if (!(spare[s] = malloc(sizeof (s_inner_##NAME))))                    \
+        {                                                                     \
+          while (s--)                                                         \
+            free(spare[s]);                                                   \
+          return FALSE;                                                       \
+        }                                                                     \
+      if (!(half = malloc(sizeof (s_leaf_##NAME))))                           \
+      {                                                                       \
+        while (spares--)                                                      \
+          free(spare[spares]);                                                \
+        return FALSE;                                                         \
+      }                                                                       \
+                                                                              \
+      half->count = leaf->count / 2;                                          \
+      leaf->count -= half->count;                                             \
+      memcpy(half->keys, leaf->keys + leaf->count,                            \
+             half->count * sizeof (KEY));                                     \
+      memcpy(half->values, leaf->values + leaf->count,                        \
+             half->count * sizeof (VALUE));                                   \
+      half->previous = leaf;                                                  \
+      half->next = leaf->next;                                                \
+      if (half->next)                                                         \
+        half->next->previous = half;                                          \
+      leaf->next = half;                                                      \
+                                                                              \
+      if (i > leaf->count)                                                    \
+      {                                                                       \
+        i -= leaf->count;                                                     \
+        leaf = half;                                                          \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    memmove(leaf->keys + i + 1, leaf->keys + i,                               \
+            (leaf->count - i) * sizeof (KEY));                                \
+    memmove(leaf->values + i + 1, leaf->values + i,                           \
+            (leaf->count - i) * sizeof (VALUE));                              \
+    leaf->keys[i] = key;                                                      \
+    leaf->values[i] = value;                                                  \
+    leaf->count++;                                                            \
+    tree->count++;                                                            \
+                                                                              \
+    if (!half)                                                                \
+      return TRUE;                                                            \
+                                                                              \
+    up = half->keys[0];                                                       \
+    child = half;                                                             \
+    for (h = tree->height; child && h--; )                                    \
+    {                                                                         \
+      inner = path[h];                                                        \
+      i = index[h];                                                           \
+      split = NULL;                                                           \
+                                                                              \
+      if (inner->count == BTREE_INNER_CAPACITY(KEY))                          \
+      {                                                                       \
+        split = spare[--spares];                                              \
+        mid = inner->count / 2;                                               \
+        split->count = inner->count - mid - 1;                                \
+        memcpy(split->keys, inner->keys + mid + 1,                            \
+               split->count * sizeof (KEY));                                  \
+        memcpy(split->children, inner->children + mid + 1,                    \
+               (split->count + 1) * sizeof (void*));                          \
+        middle = inner->keys[mid];                                            \
+        inner->count = mid;                                                   \
+                                                                              \
+        if (i > mid)                                                          \
+        {                                                                     \
+          i -= mid + 1;                                                       \
+          inner = split;                                                      \
+        }                                                                     \
+      }                                                                       \
+                                                                              \
+      memmove(inner->keys + i + 1, inner->keys + i,                           \
+              (inner->count - i) * sizeof (KEY));                             \
+      memmove(inner->children + i + 2, inner->children + i + 1,               \
+              (inner->count - i) * sizeof (void*));                           \
+      inner->keys[i] = up;                                                    \
+      inner->children[i + 1] = child;                                         \
+      inner->count++;                                                         \
+                                                                              \
+      child = split;                                                          \
+      if (split)                                                              \
+        up = middle;                                                          \
+    }                                                                         \
+                                                                              \
+    if (child)                                                                \
+    {                                                                         \
+      inner = spare[--spares];                                                \
+      inner->count = 1;                                                       \
+      inner->keys[0] = up;                                                    \
+      inner->children[0] = tree->root;                                        \
+      inner->children[1] = child;                                             \
+      tree->root = inner;                                                     \
+      tree->height++;                                                         \
+    }                                                                         \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Remove key from the tree. Nodes are not merged with their
+**  neighbours : a leaf is only freed once it is empty, and so are the inner
+**  nodes that lose their last child. When the root is left with a single
+**  child, the tree shrinks by one level.
+**
+** @param tree the tree
+** @param key the key to remove
+** @param dest The function pointer to call on the entry so as to delete it
+**  if needed (this pointer could be NULL if no freeing is needed).
+**
+** @return TRUE if key was in the tree, FALSE otherwise.
+*/
+# define BTREE_ERASE(KEY, VALUE, CMP, NAME)                                   \
+  bool NAME##_erase(NAME* tree, KEY key, NAME##_destructor_func dest)         \
+  {                                                                           \
+    s_inner_##NAME* path[BTREE_MAX_HEIGHT];                                   \
+    unsigned index[BTREE_MAX_HEIGHT];                                         \
+    s_leaf_##NAME* leaf = NULL;                                               \
+    s_inner_##NAME* inner = NULL;                                             \
+    unsigned i = 0;                                                           \
+    unsigned h = tree->height;                                                \
+                                                                              \
+    if (!tree->root)                                                          \
+      return FALSE;                                                           \
+                                                                              \
+    leaf = NAME##_find_leaf(tree, key, path, index);                          \
+    i = NAME##_lower(leaf->keys, leaf->count, key);                           \
+    if (i >= leaf->count || CMP(leaf->keys[i], key))                          \
+      return FALSE;                                                           \
+                                                                              \
+    if (dest)                                                                 \
+      dest(leaf->keys[i], leaf->values[i]);                                   \
+    memmove(leaf->keys + i, leaf->keys + i + 1,                               \
+            (leaf->count - i - 1) * sizeof (KEY));                            \
+    memmove(leaf->values + i, leaf->values + i + 1,                           \
+            (leaf->count - i - 1) * sizeof (VALUE));                          \
+    tree->count--;                                                            \
+                                                                              \
+    if (--leaf->count)                                                        \
+      return TRUE;                                                            \
+                                                                              \
+    if (leaf->previous)                                                       \
+      leaf->previous->next = leaf->next;                                      \
+    else                                                                      \
+      tree->first = leaf->next;                                               \
+    if (leaf->next)                                                           \
+      leaf->next->previous = leaf->previous;                                  \
+    free(leaf);                                                               \
+                                                                              \
+    while (h--)                                                               \
+    {                                                                         \
+      inner = path[h];                                                        \
+      i = index[h];                                                           \
+      if (!inner->count)                                                      \
+      {                                                                       \
+        free(inner);                                                          \
+        continue;                                                             \
+      }                                                                       \
+                                                                              \
+      memmove(inner->keys + (i ? i - 1 : 0), inner->keys + (i ? i : 1),       \
+              (inner->count - (i ? i : 1)) * sizeof (KEY));                   \
+      memmove(inner->children + i, inner->children + i + 1,                   \
+              (inner->count - i) * sizeof (void*));                           \
+      inner->count--;                                                         \
+      break;                                                                  \
+    }                                                                         \
+                                                                              \
+    if (h == (unsigned)-1)                                                    \
+    {                                                                         \
+      tree->root = NULL;                                                      \
+      tree->height = 0;                                                       \
+    }                                                                         \
+                                                                              \
+    while (tree->height && !((s_inner_##NAME*)tree->root)->count)             \
+    {                                                                         \
+      inner = tree->root;                                                     \
+      tree->root = inner->children[0];                                        \
+      tree->height--;                                                         \
+      free(inner);                                                            \
+    }                                                                         \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+#endif /* !BTREE_HXX_ */
@@ -0,0 +1,93 @@
+/******************************************************************************
+**                                                                           **
+**    Test code for the B+tree data structure                                **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include "btree.h"
+
+/// @brief Visitor for an entry of the tree. Simply print the key and
+//  the value on stdout, followed by a eol.
+///
+/// @param key The key
+/// @param value The value
+/// @param data Could possibly store data in that pointer
+void
+visitor(int key, double value, void* data)
+{
+  printf("%i : %.2f\n", key, value);
+}
+
+
+/// @brief Main function to test the B+tree structure
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(void)
+{
+  int keys[10];
+  double values[10];
+  tree* t = NULL;
+
+  printf("\033[33m > Starting B+tree test\033[37m :\n\n");
+
+  // Creating tree
+  printf("[ \033[32mCreating\033[37m tree ..\n");
+  t = tree_create();
+  if (!t)
+    return 1;
+  printf("Tree correctly created ] \n\n");
+
+  printf("Is the tree empty ? > %s\n", (tree_empty(t) ? "yes" : "no"));
+  printf("Tree size : %i\n\n", tree_size(t));
+
+  // Inserting in any order, the tree keeps the keys sorted
+  printf("[ \033[32mInserting\033[37m 20 keys in no particular order ..\n\n");
+  for (int i = 0; i < 20; i++)
+    tree_insert(t, (i * 7) % 20, i / 4.);
+
+  printf("Is the tree empty ? > %s\n", (tree_empty(t) ? "yes" : "no"));
+  printf("Tree size : %i\n\n", tree_size(t));
+
+  printf("Value of \033[32m14\033[37m : %.2f\n", *tree_get(t, 14));
+  printf("Does the tree contain \033[32m42\033[37m ? > %s\n\n",
+         (tree_contains(t, 42) ? "yes" : "no"));
+
+  printf("[ \033[32mErasing\033[37m the odd keys ..\n\n");
+  for (int i = 1; i < 20; i += 2)
+    tree_erase(t, i, NULL);
+
+  printf("\033[32mVisiting\033[37m the tree ..\n");
+  tree_visit(t, visitor, NULL);
+
+  // Building a tree from sorted keys
+  printf("\n[ \033[32mLoading\033[37m 10 sorted keys ..\n\n");
+  for (int i = 0; i < 10; i++)
+  {
+    keys[i] = i * 10;
+    values[i] = i * 1.5;
+  }
+  tree_load(t, keys, values, 10);
+
+  printf("\033[32mVisiting\033[37m the keys in [25, 65] ..\n");
+  tree_visit_range(t, 25, 65, visitor, NULL);
+
+  printf("\n[ \033[32mDeleting\033[37m the tree..\n\n");
+  tree_delete(t, NULL);
+
+  return 0;
+}
@@ -0,0 +1,252 @@
+/******************************************************************************
+**                                                                           **
+**    Memory management shared by the C++ containers                         **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file memory.hpp
+**
+** @author Remi BERSON
+**
+** @brief This file contains what the C++ containers (vector.hpp, list.hpp,
+**  queue.hpp and stack.hpp) share : the default allocator, the capacity
+**  policies and the relocation of an array. The C++ containers are the
+**  templates counterpart of the X-macros : their members are the ones of
+**  the structures generated by the macros, in the same order, but the
+**  elements are moved instead of copied, constructed in place by the
+**  emplace functions, and the visitors are template parameters that the
+**  compiler can inline.
+**
+**  The vectors, stacks and queues have the very layout of the structures,
+**  which cxx/sample/main.cc checks. The exception is an instrumented build
+**  (-DDS_STATS, see stats.hxx) : the structures then also hold their
+**  counters, that the templates do not have.
+**
+**  The allocators are the ones of the standard library (std::allocator,
+**  or any type that std::allocator_traits accepts). They only provide the
+**  memory : the elements are constructed in it with placement new. An
+**  allocation failure throws std::bad_alloc.
+**
+**  A capacity policy is a type with two constexpr members :
+**
+**    ~ initial, the capacity of a default-constructed container,
+**    ~ grow(capacity, needed), the capacity that replaces capacity when
+**      needed elements do not fit (at least needed). grow(0, n) is the
+**      capacity of a container constructed with room for n elements.
+**
+**  The headers need C++17.
+*/
+
+
+#ifndef MEMORY_HPP_
+# define MEMORY_HPP_
+
+# include <climits>
+# include <cstdlib>
+# include <cstring>
+# include <memory>
+# include <new>
+# include <stdexcept>
+# include <type_traits>
+# include <utility>
+# include "../queue/round.hxx"
+
+namespace ds
+{
+  /**
+  ** @brief The allocator of the C containers : malloc, realloc and free.
+  **  The arrays of trivially copyable elements grow with realloc, as in
+  **  the macros, instead of being copied to a new allocation.
+  */
+  template <typename T>
+  struct malloc_allocator
+  {
+    using value_type = T;
+
+    constexpr malloc_allocator() noexcept = default;
+
+    template <typename U>
+    constexpr malloc_allocator(const malloc_allocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+      void* array = std::malloc(n ? n * sizeof (T) : 1);
+
+      if (!array)
+        throw std::bad_alloc();
+      return static_cast<T*>(array);
+    }
+
+    T* reallocate(T* array, std::size_t, std::size_t n)
+    {
+      void* new_array = std::realloc(array, n ? n * sizeof (T) : 1);
+
+      if (!new_array)
+        throw std::bad_alloc();
+      return static_cast<T*>(new_array);
+    }
+
+    void deallocate(T* array, std::size_t) noexcept
+    {
+      std::free(array);
+    }
+
+    template <typename U>
+    constexpr bool operator==(const malloc_allocator<U>&) const noexcept
+    {
+      return true;
+    }
+
+    template <typename U>
+    constexpr bool operator!=(const malloc_allocator<U>&) const noexcept
+    {
+      return false;
+    }
+  };
+
+
+  /**
+  ** @brief Capacity policy of vectors and stacks : the capacity is
+  **  multiplied by Num / Den (1.5 by default, as VECTOR_GROW does).
+  */
+  template <unsigned Initial = 42, unsigned Num = 3, unsigned Den = 2>
+  struct geometric_growth
+  {
+    static_assert(Den > 0 && Num > Den, "the capacity must grow");
+
+    static constexpr unsigned initial = Initial;
+
+    static constexpr unsigned grow(unsigned capacity, unsigned needed) noexcept
+    {
+      unsigned long long next = (unsigned long long)capacity * Num / Den;
+
+      if (next > UINT_MAX)
+        next = UINT_MAX;
+      return next < needed ? needed : next;
+    }
+  };
+
+
+  /**
+  ** @brief Capacity policy of ring queues : the capacity is a power of two
+  **  (at least 2, given by queue_round as in the C queues), doubled when
+  **  the queue is full. Growing past the largest power of two throws
+  **  std::length_error.
+  */
+  template <unsigned Initial = 42>
+  struct power_of_two_growth
+  {
+    static constexpr unsigned grow(unsigned capacity, unsigned needed)
+    {
+      unsigned next = queue_round(needed > capacity ? needed : capacity);
+
+      if (!next)
+        throw std::length_error("ds: capacity too large");
+      return next;
+    }
+
+    static constexpr unsigned initial = grow(0, Initial);
+  };
+
+
+  /**
+  ** @brief A capacity that never changes : the container is allocated once,
+  **  and inserting in a full one throws std::length_error.
+  */
+  template <unsigned Capacity>
+  struct fixed_capacity
+  {
+    static constexpr unsigned initial = Capacity;
+
+    static constexpr unsigned grow(unsigned, unsigned needed)
+    {
+      if (needed > Capacity)
+        throw std::length_error("ds: fixed capacity exceeded");
+      return Capacity;
+    }
+  };
+
+
+  using vector_growth = geometric_growth<>;
+  using stack_growth = geometric_growth<>;
+  using queue_growth = power_of_two_growth<>;
+
+
+  namespace detail
+  {
+    template <typename Alloc, typename = void>
+    struct has_reallocate : std::false_type
+    {
+    };
+
+    template <typename Alloc>
+    struct has_reallocate<Alloc, std::void_t<decltype(
+      std::declval<Alloc&>().reallocate(
+        std::declval<typename Alloc::value_type*>(), 0, 0))>>
+      : std::true_type
+    {
+    };
+
+
+    /**
+    ** @brief Move the count first elements of array, of capacity elements,
+    **  to a new array of new_capacity elements, and free array. Elements
+    **  whose move constructor may throw are copied, so that array is left
+    **  untouched if an exception is thrown.
+    **
+    ** @return the new array.
+    */
+    template <typename T, typename Alloc>
+    T* relocate(Alloc& alloc, T* array, unsigned count, unsigned capacity,
+                unsigned new_capacity)
+    {
+      using traits = std::allocator_traits<Alloc>;
+      T* new_array = nullptr;
+      unsigned i = 0;
+
+      if constexpr (std::is_trivially_copyable_v<T>
+                    && has_reallocate<Alloc>::value)
+        if (array)
+          return alloc.reallocate(array, capacity, new_capacity);
+
+      new_array = traits::allocate(alloc, new_capacity);
+      try
+      {
+        for (; i < count; i++)
+          new (new_array + i) T(std::move_if_noexcept(array[i]));
+      }
+      catch (...)
+      {
+        std::destroy(new_array, new_array + i);
+        traits::deallocate(alloc, new_array, new_capacity);
+        throw;
+      }
+
+      std::destroy(array, array + count);
+      if (array)
+        traits::deallocate(alloc, array, capacity);
+      return new_array;
+    }
+  }
+}
+
+#endif /* !MEMORY_HPP_ */
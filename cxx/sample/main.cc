@@ -0,0 +1,257 @@
+/******************************************************************************
+**                                                                           **
+**    Sample code for the C++ containers                                     **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "../../vector/vector.hpp"
+#include "../../list/list.hpp"
+#include "../../queue/queue.hpp"
+#include "../../stack/stack.hpp"
+
+// The structures of the C macros, to check that the templates have their
+// layout. bool is a char in the C headers, which C++ does not allow.
+#ifndef DS_STATS
+# define bool c_bool
+# include "../../vector/vector.hxx"
+# include "../../stack/stack.hxx"
+# include "../../queue/queue.hxx"
+# undef bool
+
+VECTOR_HEADER(int, c_vector)
+STACK_HEADER(int, c_stack)
+QUEUE_HEADER(int, c_queue)
+
+static_assert(std::is_standard_layout<ds::vector<int>>::value
+              && sizeof (ds::vector<int>) == sizeof (c_vector),
+              "ds::vector and VECTOR_HEADER differ");
+static_assert(std::is_standard_layout<ds::stack<int>>::value
+              && sizeof (ds::stack<int>) == sizeof (c_stack),
+              "ds::stack and STACK_HEADER differ");
+static_assert(std::is_standard_layout<ds::ring_queue<int>>::value
+              && sizeof (ds::ring_queue<int>) == sizeof (c_queue),
+              "ds::ring_queue and QUEUE_HEADER differ");
+#endif
+
+/// @brief Number of checks that failed.
+static int failures = 0;
+
+/// @brief Print the result of a check on stdout, followed by a eol.
+///
+/// @param ok The result of the check
+/// @param what What was checked
+static void
+check(bool ok, const char* what)
+{
+  printf("  %s : %s\n", what,
+         ok ? "\033[32mok\033[37m" : "\033[31mKO\033[37m");
+  if (!ok)
+    failures++;
+}
+
+
+/// @brief Test ds::vector : growth, insertion, erasure, move-only
+//  elements and a lambda visitor.
+static void
+test_vector(void)
+{
+  ds::vector<int> v;
+  ds::vector<std::unique_ptr<std::string>> u(0);
+  long sum = 0;
+
+  printf("[ \033[32mvector\033[37m ..\n");
+  for (int i = 0; i < 10000; i++)
+    v.push_back(i);
+  check(v.size() == 10000 && v.capacity() >= 10000, "push_back 10000");
+  check(v.front() == 0 && v.back() == 9999 && v[42] == 42, "element access");
+
+  v.insert(0, -1);
+  v.emplace_back(v[0]);
+  check(v.front() == -1 && v.back() == -1 && v.size() == 10002, "insert");
+
+  v.erase(0);
+  v.pop_back();
+  v.erase(100, 9900);
+  v.visit([&](int elt) { sum += elt; });
+  check(v.size() == 100 && sum == 4950, "erase and visit");
+
+  v.shrink_to_fit();
+  check(v.capacity() == 100, "shrink_to_fit");
+
+  for (int i = 0; i < 100; i++)
+    u.emplace_back(new std::string(std::to_string(i)));
+  u.insert(50, std::make_unique<std::string>("x"));
+  check(*u[50] == "x" && *u[100] == "99", "move-only elements");
+
+  ds::vector<int> w = std::move(v);
+  check(v.empty() && w.size() == 100, "move construction");
+  printf("]\n\n");
+}
+
+
+/// @brief Test ds::list : both ends, insertion in the middle and copies.
+static void
+test_list(void)
+{
+  ds::list<std::string> l;
+  std::string all;
+
+  printf("[ \033[32mlist\033[37m ..\n");
+  for (int i = 0; i < 5; i++)
+    l.push_back(std::to_string(i));
+  l.emplace_front("front");
+  l.emplace(3, "middle");
+  check(l.size() == 7 && l.front() == "front" && l.back() == "4",
+        "push and emplace");
+
+  l.visit([&](const std::string& elt) { all += elt; });
+  check(all == "front01middle234", "visit in order");
+
+  ds::list<std::string> copy = l;
+  check(l.pop_front() == "front" && l.pop_back() == "4", "pop");
+  check(copy.size() == 7 && l.size() == 5, "copy is independent");
+
+  l.clear();
+  check(l.empty() && l.size() == 0, "clear");
+  printf("]\n\n");
+}
+
+
+/// @brief Test ds::ring_queue : FIFO order while the ring wraps and grows.
+static void
+test_ring_queue(void)
+{
+  ds::ring_queue<int> q(2);
+  int next = 0;
+  int expected = 0;
+  bool ordered = true;
+
+  printf("[ \033[32mring_queue\033[37m ..\n");
+  for (int round = 0; round < 1000; round++)
+  {
+    for (int i = 0; i < 3; i++)
+      q.push(next++);
+    for (int i = 0; i < 2; i++)
+      ordered = q.pop() == expected++ && ordered;
+  }
+  check(ordered, "FIFO order");
+  check(q.size() == 1000 && q.front() == 2000 && q.back() == 2999,
+        "size, front and back");
+
+  while (!q.empty())
+    ordered = q.pop() == expected++ && ordered;
+  check(ordered && expected == next, "drain");
+
+  // Capacities that are not powers of two are rounded up.
+  ds::ring_queue<int, ds::malloc_allocator<int>, ds::fixed_capacity<6>> f;
+  ds::ring_queue<std::string, std::allocator<std::string>,
+                 ds::geometric_growth<3>> g;
+
+  for (int i = 0; i < 6; i++)
+    f.push(i);
+  for (int i = 0; i < 20; i++)
+    g.push(std::to_string(i));
+  ordered = true;
+  for (int i = 0; i < 6; i++)
+    ordered = f.pop() == i && ordered;
+  for (int i = 0; i < 20; i++)
+    ordered = g.pop() == std::to_string(i) && ordered;
+  check(ordered, "other capacity policies");
+  printf("]\n\n");
+}
+
+
+/// @brief Test ds::stack : LIFO order and emplace from its own top.
+static void
+test_stack(void)
+{
+  ds::stack<std::string> s(1);
+  bool ordered = true;
+
+  printf("[ \033[32mstack\033[37m ..\n");
+  for (int i = 0; i < 100; i++)
+    s.push(std::to_string(i));
+  s.emplace(s.top());
+  check(s.size() == 101 && s.top() == "99", "push and emplace");
+
+  s.pop();
+  for (int i = 99; i >= 0; i--)
+    ordered = s.pop() == std::to_string(i) && ordered;
+  check(ordered && s.empty(), "LIFO order");
+  printf("]\n\n");
+}
+
+
+/// @brief Read the templates through the structures of the C macros : each
+//  member must be where the C code expects it. The structures hold their
+//  counters too with -DDS_STATS, so the layouts only match without it.
+static void
+test_layout(void)
+{
+#ifndef DS_STATS
+  ds::vector<int> v;
+  ds::stack<int> s;
+  ds::ring_queue<int> q(4);
+  c_vector cv;
+  c_stack cs;
+  c_queue cq;
+
+  printf("[ \033[32mlayout\033[37m ..\n");
+  for (int i = 0; i < 6; i++)
+  {
+    v.push_back(i);
+    s.push(i);
+    q.push(i);
+  }
+  q.pop();
+  std::memcpy(&cv, &v, sizeof (cv));
+  std::memcpy(&cs, &s, sizeof (cs));
+  std::memcpy(&cq, &q, sizeof (cq));
+
+  check(cv.array == v.data() && cv.capacity == v.capacity()
+        && cv.count == v.size() && !cv.snapshot, "vector");
+  check(cs.stack + cs.count - 1 == &s.top() && cs.size == s.capacity()
+        && cs.count == s.size() && !cs.snapshot, "stack");
+  check(cq.queue + cq.begin == &q.front() && cq.count == q.size()
+        && cq.array_size == q.capacity() && !cq.snapshot, "ring_queue");
+  printf("]\n\n");
+#endif
+}
+
+
+/// @brief Main function to test the C++ containers
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(void)
+{
+  printf("\033[33m > Starting C++ containers test\033[37m :\n\n");
+
+  test_vector();
+  test_list();
+  test_ring_queue();
+  test_stack();
+  test_layout();
+
+  printf("%i check(s) failed\n", failures);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the graph data structure                            **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "graph.h"
+
+/// @brief File in which the edge list is written, then mapped.
+#define EDGES "edges.bin"
+
+
+/// @brief splitmix64, to generate the edges.
+static uint64_t
+mix(uint64_t i)
+{
+  uint64_t z = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+/// @brief R-MAT edge generator (a = 0.57, b = c = 0.19), the skewed degree
+//  distribution of Graph500 graphs : each bit of the two ends is chosen by
+//  picking one quarter of the adjacency matrix.
+static void
+rmat(unsigned scale, uint64_t i, uint32_t* from, uint32_t* to)
+{
+  uint64_t r = 0;
+
+  *from = 0;
+  *to = 0;
+  for (unsigned b = 0; b < scale; b++)
+  {
+    r = mix(i * scale + b) % 100;
+    *from = *from << 1 | (r >= 76);
+    *to = *to << 1 | (r >= 57 && r < 76) | (r >= 95);
+  }
+}
+
+
+/// @brief Plain serial BFS with a queue, as a baseline.
+static uint32_t*
+serial_bfs(graph* g, uint32_t source)
+{
+  uint32_t* parents = malloc(g->vertices * sizeof (uint32_t));
+  uint32_t* queue = malloc(g->vertices * sizeof (uint32_t));
+  size_t head = 0;
+  size_t tail = 0;
+  size_t n = 0;
+
+  for (uint32_t v = 0; v < g->vertices; v++)
+    parents[v] = GRAPH_NONE(uint32_t);
+  parents[source] = source;
+  queue[tail++] = source;
+
+  while (head < tail)
+  {
+    uint32_t u = queue[head++];
+    const uint32_t* neighbours = graph_neighbours(g, u, &n);
+
+    for (size_t i = 0; i < n; i++)
+      if (parents[neighbours[i]] == GRAPH_NONE(uint32_t))
+      {
+        parents[neighbours[i]] = u;
+        queue[tail++] = neighbours[i];
+      }
+  }
+
+  free(queue);
+  return parents;
+}
+
+
+/// @brief Main function to benchmark the graph : build a R-MAT graph with
+//  the builder and from a mapped edge list, then time BFS from a few
+//  sources on 1 to max threads, against a serial BFS.
+//  Usage : ./bench [scale] [max threads]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned scale = argc > 1 ? strtoul(argv[1], NULL, 10) : 20;
+  unsigned max = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10)
+                 : cpus > 0 ? (unsigned)cpus : 1;
+  uint64_t n = 16ull << scale;
+  graph_builder* builder = graph_builder_ncreate(n);
+  graph* g = NULL;
+  graph* mapped = NULL;
+  FILE* file = NULL;
+  uint32_t from = 0;
+  uint32_t to = 0;
+  uint32_t sources[4];
+  uint32_t* parents = NULL;
+  double t = 0;
+
+  if (!builder)
+    return 1;
+  for (uint64_t i = 0; i < n; i++)
+  {
+    rmat(scale, i, &from, &to);
+    graph_builder_add(builder, from, to);
+  }
+
+  if (!(file = fopen(EDGES, "wb")))
+    return 1;
+  fwrite(builder->array, sizeof (*builder->array), builder->size, file);
+  fclose(file);
+
+  printf("\033[33m > R-MAT graph, scale %u, %lu edges\033[37m :\n\n", scale,
+         (unsigned long)n);
+
+  t = now();
+  g = graph_freeze(builder, FALSE);
+  printf("%-24s %8.3f s\n", "freeze", now() - t);
+
+  t = now();
+  mapped = graph_load(EDGES, FALSE);
+  printf("%-24s %8.3f s\n", "load (mmap)", now() - t);
+  if (!g || !mapped)
+    return 1;
+  graph_delete(mapped);
+  remove(EDGES);
+
+  for (unsigned i = 0, v = 0; i < 4; v++)
+    if (graph_degree(g, v % g->vertices))
+      sources[i++] = v % g->vertices;
+
+  t = now();
+  for (unsigned i = 0; i < 4; i++)
+    free(serial_bfs(g, sources[i]));
+  t = (now() - t) / 4;
+  printf("\n%-24s %8.3f s %8.1f MTEPS\n", "serial bfs", t,
+         g->edges / t * 1e-6);
+
+  for (unsigned threads = 1; threads <= max; threads *= 2)
+  {
+    t = now();
+    for (unsigned i = 0; i < 4; i++)
+      free(parents = graph_bfs(g, sources[i], threads));
+    t = (now() - t) / 4;
+    printf("bfs, %2u thread(s)        %8.3f s %8.1f MTEPS\n", threads, t,
+           g->edges / t * 1e-6);
+  }
+
+  graph_delete(g);
+  return 0;
+}
@@ -0,0 +1,890 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of CSR graphs using X-macros                          **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file graph.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  static graphs, stored in compressed sparse row (CSR) form : the
+**  neighbours of all the vertices are stored one after the other in a single
+**  array, and offsets[v] is the position of the first neighbour of v. A
+**  graph is built in two steps : edges are appended to a builder (a growing
+**  array of edges, as in vector.hxx), then the builder is frozen into a
+**  graph, with a counting sort in O(V + E). Graphs can also be built from a
+**  binary edge list file, which is mapped in memory and read in place.
+**
+**  Vertices are numbered from 0, VERTEX must be an unsigned integer type.
+**  The BFS uses POSIX threads and barriers, and NAME_load uses mmap : with
+**  -std=c11, define _POSIX_C_SOURCE to 200809L and link with -pthread.
+**  Assuming that you used NAME as the name of the structure, the names of
+**  the functions will be as is :
+**
+**    ~ NAME_builder_create
+**    ~ NAME_builder_ncreate
+**    ~ NAME_builder_delete
+**    ~ NAME_builder_size
+**    ~ NAME_builder_add
+**
+**    ~ NAME_freeze
+**    ~ NAME_load
+**    ~ NAME_delete
+**
+**    ~ NAME_visit
+**    ~ NAME_visit_neighbours
+**
+**    ~ NAME_vertices
+**    ~ NAME_edges
+**    ~ NAME_degree
+**    ~ NAME_neighbours
+**
+**    ~ NAME_bfs
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef GRAPH_HXX_
+# define GRAPH_HXX_
+
+# include <stdlib.h>
+# include <string.h>
+# include <stdint.h>
+# include <stdatomic.h>
+# include <pthread.h>
+# include <sched.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Parent of the vertices that a BFS did not reach.
+*/
+# define GRAPH_NONE(VERTEX) ((VERTEX)-1)
+
+/**
+** @brief Direction-optimizing BFS parameters (see NAME_bfs) : go bottom-up
+**  when the frontier has more than 1 / ALPHA of the unexplored edges, and
+**  back top-down when it has less than 1 / BETA of the vertices.
+*/
+# ifndef GRAPH_BFS_ALPHA
+#  define GRAPH_BFS_ALPHA 14
+# endif
+
+# ifndef GRAPH_BFS_BETA
+#  define GRAPH_BFS_BETA 24
+# endif
+
+/**
+** @brief Number of vertices a BFS thread takes at once from the frontier
+**  (top-down), or number of 64 vertices blocks it takes (bottom-up).
+*/
+# define GRAPH_BFS_CHUNK 64
+
+/**
+** @brief Size of the buffer in which a BFS thread stores the vertices it
+**  discovers, before copying them to the next frontier.
+*/
+# define GRAPH_BFS_BUFFER 256
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  graph data structure. As mentionned in the README, you should create a
+**  header file for your "specialized" structure, include graph.hxx and call
+**  this macro.
+**
+** @param VERTEX Is the type of the vertices (an unsigned integer type).
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro. For exemple :
+**
+**    GRAPH_HEADER(uint32_t, graph)
+**
+**  The builder type is named NAME_builder, and the visitor type
+**  NAME_visitor_func.
+*/
+# define GRAPH_HEADER(VERTEX, NAME)                                           \
+  typedef struct NAME NAME;                                                   \
+  typedef struct NAME##_builder NAME##_builder;                               \
+  typedef struct s_edge_##NAME s_edge_##NAME;                                 \
+  typedef struct s_bfs_##NAME s_bfs_##NAME;                                   \
+                                                                              \
+  typedef void (*NAME##_visitor_func)(VERTEX, VERTEX, void*);                 \
+                                                                              \
+  struct s_edge_##NAME                                                        \
+  {                                                                           \
+    VERTEX      from;                                                         \
+    VERTEX      to;                                                           \
+  };                                                                          \
+                                                                              \
+  struct NAME##_builder                                                       \
+  {                                                                           \
+    s_edge_##NAME*  array;                                                    \
+    size_t          capacity;                                                 \
+    size_t          size;                                                     \
+  };                                                                          \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    VERTEX      vertices;                                                     \
+    size_t      edges;                                                        \
+    size_t*     offsets;                                                      \
+    VERTEX*     neighbours;                                                   \
+    size_t*     in_offsets;                                                   \
+    VERTEX*     in_neighbours;                                                \
+    bool        directed;                                                     \
+  };                                                                          \
+                                                                              \
+  struct s_bfs_##NAME                                                         \
+  {                                                                           \
+    NAME*               graph;                                                \
+    VERTEX*             parents;                                              \
+    atomic_ullong*      visited;                                              \
+    atomic_ullong*      frontier;                                             \
+    VERTEX*             queue;                                                \
+    VERTEX*             next;                                                 \
+    size_t              size;                                                 \
+    atomic_size_t       next_size;                                            \
+    atomic_size_t       next_edges;                                           \
+    atomic_size_t       cursor;                                               \
+    size_t              unexplored;                                           \
+    bool                bottom_up;                                            \
+    bool                done;                                                 \
+    atomic_bool         go;                                                   \
+    pthread_barrier_t   barrier;                                              \
+  };                                                                          \
+                                                                              \
+  GRAPH_BUILDER_CREATE_HEADER(VERTEX, NAME);                                  \
+  GRAPH_BUILDER_NCREATE_HEADER(VERTEX, NAME);                                 \
+  GRAPH_BUILDER_DELETE_HEADER(VERTEX, NAME);                                  \
+  GRAPH_BUILDER_SIZE_HEADER(VERTEX, NAME);                                    \
+  GRAPH_BUILDER_ADD_HEADER(VERTEX, NAME);                                     \
+  GRAPH_FREEZE_HEADER(VERTEX, NAME);                                          \
+  GRAPH_LOAD_HEADER(VERTEX, NAME);                                            \
+  GRAPH_DELETE_HEADER(VERTEX, NAME);                                          \
+  GRAPH_VISIT_HEADER(VERTEX, NAME);                                           \
+  GRAPH_VISIT_NEIGHBOURS_HEADER(VERTEX, NAME);                                \
+  GRAPH_VERTICES_HEADER(VERTEX, NAME);                                        \
+  GRAPH_EDGES_HEADER(VERTEX, NAME);                                           \
+  GRAPH_DEGREE_HEADER(VERTEX, NAME);                                          \
+  GRAPH_NEIGHBOURS_HEADER(VERTEX, NAME);                                      \
+  GRAPH_BFS_HEADER(VERTEX, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on graphs. Call it with the *same
+**  arguments* as GRAPH_HEADER.
+*/
+# define GRAPH_SOURCE(VERTEX, NAME)                                           \
+  GRAPH_CSR(VERTEX, NAME)                                                     \
+  GRAPH_BUILD(VERTEX, NAME)                                                   \
+  GRAPH_BUILDER_CREATE(VERTEX, NAME)                                          \
+  GRAPH_BUILDER_NCREATE(VERTEX, NAME)                                         \
+  GRAPH_BUILDER_DELETE(VERTEX, NAME)                                          \
+  GRAPH_BUILDER_SIZE(VERTEX, NAME)                                            \
+  GRAPH_BUILDER_ADD(VERTEX, NAME)                                             \
+  GRAPH_FREEZE(VERTEX, NAME)                                                  \
+  GRAPH_LOAD(VERTEX, NAME)                                                    \
+  GRAPH_DELETE(VERTEX, NAME)                                                  \
+  GRAPH_VISIT(VERTEX, NAME)                                                   \
+  GRAPH_VISIT_NEIGHBOURS(VERTEX, NAME)                                        \
+  GRAPH_VERTICES(VERTEX, NAME)                                                \
+  GRAPH_EDGES(VERTEX, NAME)                                                   \
+  GRAPH_DEGREE(VERTEX, NAME)                                                  \
+  GRAPH_NEIGHBOURS(VERTEX, NAME)                                              \
+  GRAPH_BFS_STEP(VERTEX, NAME)                                                \
+  GRAPH_BFS(VERTEX, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define GRAPH_BUILDER_CREATE_HEADER(VERTEX, NAME)                            \
+  NAME##_builder* NAME##_builder_create()
+
+# define GRAPH_BUILDER_NCREATE_HEADER(VERTEX, NAME)                           \
+  NAME##_builder* NAME##_builder_ncreate(size_t size)
+
+# define GRAPH_BUILDER_DELETE_HEADER(VERTEX, NAME)                            \
+  void NAME##_builder_delete(NAME##_builder* builder)
+
+# define GRAPH_FREEZE_HEADER(VERTEX, NAME)                                    \
+  NAME* NAME##_freeze(NAME##_builder* builder, bool directed)
+
+# define GRAPH_LOAD_HEADER(VERTEX, NAME)                                      \
+  NAME* NAME##_load(const char* path, bool directed)
+
+# define GRAPH_DELETE_HEADER(VERTEX, NAME)                                    \
+  void NAME##_delete(NAME* graph)
+
+
+// Visiting
+
+# define GRAPH_VISIT_HEADER(VERTEX, NAME)                                     \
+  void NAME##_visit(NAME* graph, NAME##_visitor_func v, void* data)
+
+# define GRAPH_VISIT_NEIGHBOURS_HEADER(VERTEX, NAME)                          \
+  void NAME##_visit_neighbours(NAME* graph, VERTEX vertex,                    \
+                               NAME##_visitor_func v, void* data)
+
+
+// Capacity
+
+# define GRAPH_BUILDER_SIZE_HEADER(VERTEX, NAME)                              \
+  size_t NAME##_builder_size(NAME##_builder* builder)
+
+# define GRAPH_VERTICES_HEADER(VERTEX, NAME)                                  \
+  VERTEX NAME##_vertices(NAME* graph)
+
+# define GRAPH_EDGES_HEADER(VERTEX, NAME)                                     \
+  size_t NAME##_edges(NAME* graph)
+
+# define GRAPH_DEGREE_HEADER(VERTEX, NAME)                                    \
+  size_t NAME##_degree(NAME* graph, VERTEX vertex)
+
+
+// Element access
+
+# define GRAPH_NEIGHBOURS_HEADER(VERTEX, NAME)                                \
+  const VERTEX* NAME##_neighbours(NAME* graph, VERTEX vertex, size_t* n)
+
+
+// Modifiers
+
+# define GRAPH_BUILDER_ADD_HEADER(VERTEX, NAME)                               \
+  bool NAME##_builder_add(NAME##_builder* builder, VERTEX from, VERTEX to)
+
+
+// Traversal
+
+# define GRAPH_BFS_HEADER(VERTEX, NAME)                                       \
+  VERTEX* NAME##_bfs(NAME* graph, VERTEX source, unsigned threads)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Counting sort of n edges into a CSR : count the degrees, compute
+**  the offsets with a prefix sum, then put each edge at offsets[v]++ and
+**  shift the offsets back. Only the from -> to direction is stored if dir
+**  is 0, only to -> from if dir is 1, and both if dir is 2.
+**
+** @return TRUE if all went ok, FALSE if an allocation failed.
+*/
+# define GRAPH_CSR(VERTEX, NAME)                                              \
+  static bool NAME##_csr(const s_edge_##NAME* edges, size_t n,                \
+                         VERTEX vertices, int dir, size_t** offsets,          \
+                         VERTEX** neighbours)                                 \
+  {                                                                           \
+    size_t* offs = calloc((size_t)vertices + 1, sizeof (size_t));             \
+    VERTEX* neigh = NULL;                                                     \
+    VERTEX from = 0;                                                          \
+    VERTEX to = 0;                                                            \
+                                                                              \
+    if (!offs)                                                                \
+      return FALSE;                                                           \
+                                                                              \
+    for (size_t i = 0; i < n; i++)                                            \
+    {                                                                         \
+      from = dir == 1 ? edges[i].to : edges[i].from;                          \
+      to = dir == 1 ? edges[i].from : edges[i].to;                            \
+      offs[from + 1]++;                                                       \
+      if (dir == 2 && from != to)                                             \
+        offs[to + 1]++;                                                       \
+    }                                                                         \
+    for (VERTEX v = 0; v < vertices; v++)                                     \
+      offs[v + 1] += offs[v];                                                 \
+                                                                              \
+    if (!(neigh = malloc((offs[vertices] ? offs[vertices] : 1)                \
+                         * sizeof (VERTEX))))                                 \
+    {                                                                         \
+      free(offs);                                                             \
+      return FALSE;                                                           \
+    }                                                                         \
+                                                                              \
+    for (size_t i = 0; i < n; i++)                                            \
+    {                                                                         \
+      from = dir == 1 ? edges[i].to : edges[i].from;                          \
+      to = dir == 1 ? edges[i].from : edges[i].to;                            \
+      neigh[offs[from]++] = to;                                               \
+      if (dir == 2 && from != to)                                             \
+        neigh[offs[to]++] = from;                                             \
+    }                                                                         \
+    for (VERTEX v = vertices; v > 0; v--)                                     \
+      offs[v] = offs[v - 1];                                                  \
+    offs[0] = 0;                                                              \
+                                                                              \
+    *offsets = offs;                                                          \
+    *neighbours = neigh;                                                      \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Build a graph from n edges, which are only read. An undirected
+**  graph stores each edge in both directions, and its incoming edges are
+**  its outgoing ones ; a directed graph also stores the transposed CSR,
+**  that the bottom-up steps of NAME_bfs need. GRAPH_NONE(VERTEX) is not a
+**  vertex : an edge using it fails the build.
+*/
+# define GRAPH_BUILD(VERTEX, NAME)                                            \
+  static NAME* NAME##_build(const s_edge_##NAME* edges, size_t n,             \
+                            bool directed)                                    \
+  {                                                                           \
+    NAME* new_graph = NULL;                                                   \
+    VERTEX vertices = 0;                                                      \
+                                                                              \
+    for (size_t i = 0; i < n; i++)                                            \
+    {                                                                         \
+      if (edges[i].from == GRAPH_NONE(VERTEX)                                 \
+          || edges[i].to == GRAPH_NONE(VERTEX))                               \
+        return NULL;                                                          \
+      if (edges[i].from >= vertices)                                          \
+        vertices = edges[i].from + 1;                                         \
+      if (edges[i].to >= vertices)                                            \
+        vertices = edges[i].to + 1;                                           \
+    }                                                                         \
+                                                                              \
+    if (!(new_graph = calloc(1, sizeof (NAME))))                              \
+      return NULL;                                                            \
+    new_graph->vertices = vertices;                                           \
+    new_graph->directed = directed;                                           \
+    if (!NAME##_csr(edges, n, vertices, directed ? 0 : 2,                     \
+                    &new_graph->offsets, &new_graph->neighbours))             \
+    {                                                                         \
+      free(new_graph);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+    new_graph->edges = new_graph->offsets[vertices];                          \
+                                                                              \
+    if (!directed)                                                            \
+    {                                                                         \
+      new_graph->in_offsets = new_graph->offsets;                             \
+      new_graph->in_neighbours = new_graph->neighbours;                       \
+    }                                                                         \
+    else if (!NAME##_csr(edges, n, vertices, 1, &new_graph->in_offsets,       \
+                         &new_graph->in_neighbours))                          \
+    {                                                                         \
+      free(new_graph->offsets);                                               \
+      free(new_graph->neighbours);                                            \
+      free(new_graph);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    return new_graph;                                                         \
+  }
+
+
+# define GRAPH_BUILDER_CREATE(VERTEX, NAME)                                   \
+  NAME##_builder* NAME##_builder_create()                                     \
+  {                                                                           \
+    return NAME##_builder_ncreate(42);                                        \
+  }
+
+
+/**
+** @brief Create a builder with room for size edges.
+**
+** @return a pointer on the new allocated builder. If an error occured, a
+**  NULL pointer is returned.
+*/
+# define GRAPH_BUILDER_NCREATE(VERTEX, NAME)                                  \
+  NAME##_builder* NAME##_builder_ncreate(size_t size)                         \
+  {                                                                           \
+    NAME##_builder* new_builder = malloc(sizeof (NAME##_builder));            \
+                                                                              \
+    if (!new_builder)                                                         \
+      return NULL;                                                            \
+                                                                              \
+    if (!size)                                                                \
+      size = 1;                                                               \
+    if (!(new_builder->array = malloc(size * sizeof (s_edge_##NAME))))        \
+    {                                                                         \
+      free(new_builder);                                                      \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    new_builder->capacity = size;                                             \
+    new_builder->size = 0;                                                    \
+                                                                              \
+    return new_builder;                                                       \
+  }
+
+
+# define GRAPH_BUILDER_DELETE(VERTEX, NAME)                                   \
+  void NAME##_builder_delete(NAME##_builder* builder)                         \
+  {                                                                           \
+    free(builder->array);                                                     \
+    free(builder);                                                            \
+  }
+
+
+/**
+** @return the number of edges added to the builder
+*/
+# define GRAPH_BUILDER_SIZE(VERTEX, NAME)                                     \
+  size_t NAME##_builder_size(NAME##_builder* builder)                         \
+  {                                                                           \
+    return builder->size;                                                     \
+  }
+
+
+/**
+** @brief Add the edge from -> to. Vertices are created as needed : the
+**  graph will have as many vertices as the greatest one plus one.
+**
+** @return TRUE if all went ok, FALSE if the builder could not grow.
+*/
+# define GRAPH_BUILDER_ADD(VERTEX, NAME)                                      \
+  bool NAME##_builder_add(NAME##_builder* builder, VERTEX from, VERTEX to)    \
+  {                                                                           \
+    s_edge_##NAME* array = NULL;                                              \
+                                                                              \
+    if (builder->size == builder->capacity)                                   \
+    {                                                                         \
+      if (!(array = realloc(builder->array, 2 * builder->capacity             \
+                            * sizeof (s_edge_##NAME))))                       \
+        return FALSE;                                                         \
+      builder->array = array;                                                 \
+      builder->capacity *= 2;                                                 \
+    }                                                                         \
+                                                                              \
+    builder->array[builder->size].from = from;                                \
+    builder->array[builder->size].to = to;                                    \
+    builder->size++;                                                          \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Turn the edges of the builder into a graph. On success the builder
+**  is deleted, so that its memory is given back as soon as possible.
+**
+** @param builder the builder
+** @param directed FALSE to add each edge in both directions
+**
+** @return the new graph, or NULL if an allocation failed or an edge uses
+**  GRAPH_NONE(VERTEX) (the builder is then left untouched).
+*/
+# define GRAPH_FREEZE(VERTEX, NAME)                                           \
+  NAME* NAME##_freeze(NAME##_builder* builder, bool directed)                 \
+  {                                                                           \
+    NAME* graph = NAME##_build(builder->array, builder->size, directed);      \
+                                                                              \
+    if (graph)                                                                \
+      NAME##_builder_delete(builder);                                         \
+                                                                              \
+    return graph;                                                             \
+  }
+
+
+/**
+** @brief Build a graph from a binary edge list file : a plain array of
+**  (from, to) pairs of VERTEX, in native byte order, that is the layout of
+**  the builder array. The file is mapped read-only and the edges are sorted
+**  straight from the mapping, without being copied in memory first.
+**
+** @return the new graph, or NULL if the file could not be mapped, an
+**  allocation failed or an edge uses GRAPH_NONE(VERTEX).
+*/
+# define GRAPH_LOAD(VERTEX, NAME)                                             \
+  NAME* NAME##_load(const char* path, bool directed)                          \
+  {                                                                           \
+    NAME* graph = NULL;                                                       \
+    struct stat st;                                                           \
+    void* map = NULL;                                                         \
+    int fd = open(path, O_RDONLY);                                            \
+                                                                              \
+    if (fd < 0)                                                               \
+      return NULL;                                                            \
+                                                                              \
+    if (fstat(fd, &st))                                                       \
+    {                                                                         \
+      close(fd);                                                              \
+      return NULL;                                                            \
+    }                                                                         \
+    if (!st.st_size)                                                          \
+    {                                                                         \
+      close(fd);                                                              \
+      return NAME##_build(NULL, 0, directed);                                 \
+    }                                                                         \
+                                                                              \
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);              \
+    close(fd);                                                                \
+    if (map == MAP_FAILED)                                                    \
+      return NULL;                                                            \
+                                                                              \
+    posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);                    \
+    graph = NAME##_build(map, st.st_size / sizeof (s_edge_##NAME),            \
+                         directed);                                           \
+    munmap(map, st.st_size);                                                  \
+                                                                              \
+    return graph;                                                             \
+  }
+
+
+# define GRAPH_DELETE(VERTEX, NAME)                                           \
+  void NAME##_delete(NAME* graph)                                             \
+  {                                                                           \
+    if (graph->directed)                                                      \
+    {                                                                         \
+      free(graph->in_offsets);                                                \
+      free(graph->in_neighbours);                                             \
+    }                                                                         \
+    free(graph->offsets);                                                     \
+    free(graph->neighbours);                                                  \
+    free(graph);                                                              \
+  }
+
+
+/**
+** @brief Call the visitor on each edge of the graph (from, to, data), by
+**  increasing from. Undirected edges are visited once in each direction.
+*/
+# define GRAPH_VISIT(VERTEX, NAME)                                            \
+  void NAME##_visit(NAME* graph, NAME##_visitor_func v, void* data)           \
+  {                                                                           \
+    size_t i = 0;                                                             \
+                                                                              \
+    for (VERTEX from = 0; from < graph->vertices; from++)                     \
+      for (; i < graph->offsets[from + 1]; i++)                               \
+        v(from, graph->neighbours[i], data);                                  \
+  }
+
+
+/**
+** @brief Call the visitor on each edge going out of vertex.
+*/
+# define GRAPH_VISIT_NEIGHBOURS(VERTEX, NAME)                                 \
+  void NAME##_visit_neighbours(NAME* graph, VERTEX vertex,                    \
+                               NAME##_visitor_func v, void* data)             \
+  {                                                                           \
+    for (size_t i = graph->offsets[vertex]; i < graph->offsets[vertex + 1];   \
+         i++)                                                                 \
+      v(vertex, graph->neighbours[i], data);                                  \
+  }
+
+
+/**
+** @return the number of vertices of the graph
+*/
+# define GRAPH_VERTICES(VERTEX, NAME)                                         \
+  VERTEX NAME##_vertices(NAME* graph)                                         \
+  {                                                                           \
+    return graph->vertices;                                                   \
+  }
+
+
+/**
+** @return the number of edges stored in the graph (twice the number of
+**  undirected edges, self-loops excepted)
+*/
+# define GRAPH_EDGES(VERTEX, NAME)                                            \
+  size_t NAME##_edges(NAME* graph)                                            \
+  {                                                                           \
+    return graph->edges;                                                      \
+  }
+
+
+/**
+** @return the number of edges going out of vertex
+*/
+# define GRAPH_DEGREE(VERTEX, NAME)                                           \
+  size_t NAME##_degree(NAME* graph, VERTEX vertex)                            \
+  {                                                                           \
+    return graph->offsets[vertex + 1] - graph->offsets[vertex];               \
+  }
+
+
+/**
+** @brief Return the neighbours of vertex as an array, and their number in
+**  *n. The array belongs to the graph.
+*/
+# define GRAPH_NEIGHBOURS(VERTEX, NAME)                                       \
+  const VERTEX* NAME##_neighbours(NAME* graph, VERTEX vertex, size_t* n)      \
+  {                                                                           \
+    *n = graph->offsets[vertex + 1] - graph->offsets[vertex];                 \
+    return graph->neighbours + graph->offsets[vertex];                        \
+  }
+
+
+/**
+** @brief One BFS thread. Each level is processed by all the threads, which
+**  take chunks of work from a shared cursor, then meet at a barrier ; one
+**  of them prepares the next level and they meet again.
+**
+**  Top-down, the threads take the vertices of the frontier and claim their
+**  unvisited neighbours with an atomic or in the visited bitmap. Bottom-up,
+**  they take blocks of 64 vertices and look for a parent in the frontier
+**  bitmap among the incoming edges of each unvisited one : a block belongs
+**  to a single thread, so no claim is needed, and the scan of a vertex stops
+**  at the first parent found. Discovered vertices are appended to the next
+**  frontier through a small per-thread buffer.
+*/
+# define GRAPH_BFS_STEP(VERTEX, NAME)                                         \
+  static void NAME##_bfs_flush(s_bfs_##NAME* bfs, VERTEX* buffer,             \
+                               unsigned* n)                                   \
+  {                                                                           \
+    size_t pos = atomic_fetch_add(&bfs->next_size, *n);                       \
+                                                                              \
+    memcpy(bfs->next + pos, buffer, *n * sizeof (VERTEX));                    \
+    *n = 0;                                                                   \
+  }                                                                           \
+                                                                              \
+  static void NAME##_bfs_level(s_bfs_##NAME* bfs)                             \
+  {                                                                           \
+    NAME* graph = bfs->graph;                                                 \
+    size_t words = ((size_t)graph->vertices + 63) / 64;                       \
+    size_t first = 0;                                                         \
+    size_t last = 0;                                                          \
+    size_t edges = 0;                                                         \
+    unsigned long long bit = 0;                                               \
+    VERTEX buffer[GRAPH_BFS_BUFFER];                                          \
+    unsigned n = 0;                                                           \
+    VERTEX u = 0;                                                             \
+    VERTEX v = 0;                                                             \
+                                                                              \
+    while (!bfs->bottom_up                                                    \
+           && (first = atomic_fetch_add(&bfs->cursor, GRAPH_BFS_CHUNK))       \
+              < bfs->size)                                                    \
+    {                                                                         \
+      last = first + GRAPH_BFS_CHUNK < bfs->size                              \
+             ? first + GRAPH_BFS_CHUNK : bfs->size;                           \
+      for (size_t i = first; i < last; i++)                                   \
+      {                                                                       \
+        u = bfs->queue[i];                                                    \
+        for (size_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)    \
+        {                                                                     \
+          v = graph->neighbours[e];                                           \
+          bit = 1ull << (v % 64);                                             \
+          if ((atomic_load_explicit(&bfs->visited[v / 64],                    \
+                                    memory_order_relaxed) & bit)              \
+              || (atomic_fetch_or_explicit(&bfs->visited[v / 64], bit,        \
+                                           memory_order_relaxed) & bit))      \
+            continue;                                                         \
+          bfs->parents[v] = u;                                                \
+          edges += graph->offsets[v + 1] - graph->offsets[v];                 \
+          buffer[n++] = v;                                                    \
+          if (n == GRAPH_BFS_BUFFER)                                          \
+            NAME##_bfs_flush(bfs, buffer, &n);                                \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    while (bfs->bottom_up                                                     \
+           && (first = atomic_fetch_add(&bfs->cursor, GRAPH_BFS_CHUNK))       \
+              < words)                                                        \
+    {                                                                         \
+      last = first + GRAPH_BFS_CHUNK < words ? first + GRAPH_BFS_CHUNK        \
+             : words;                                                         \
+      for (v = first * 64; v < last * 64 && v < graph->vertices; v++)         \
+      {                                                                       \
+        bit = 1ull << (v % 64);                                               \
+        if (atomic_load_explicit(&bfs->visited[v / 64],                       \
+                                 memory_order_relaxed) & bit)                 \
+          continue;                                                           \
+        for (size_t e = graph->in_offsets[v]; e < graph->in_offsets[v + 1];   \
+             e++)                                                             \
+        {                                                                     \
+          u = graph->in_neighbours[e];                                        \
+          if (!(atomic_load_explicit(&bfs->frontier[u / 64],                  \
+                                     memory_order_relaxed)                    \
+                & 1ull << (u % 64)))                                          \
+            continue;                                                         \
+          atomic_fetch_or_explicit(&bfs->visited[v / 64], bit,                \
+                                   memory_order_relaxed);                     \
+          bfs->parents[v] = u;                                                \
+          edges += graph->offsets[v + 1] - graph->offsets[v];                 \
+          buffer[n++] = v;                                                    \
+          if (n == GRAPH_BFS_BUFFER)                                          \
+            NAME##_bfs_flush(bfs, buffer, &n);                                \
+          break;                                                              \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    NAME##_bfs_flush(bfs, buffer, &n);                                        \
+    atomic_fetch_add(&bfs->next_edges, edges);                                \
+  }                                                                           \
+                                                                              \
+  static void NAME##_bfs_next(s_bfs_##NAME* bfs)                              \
+  {                                                                           \
+    NAME* graph = bfs->graph;                                                 \
+    size_t words = ((size_t)graph->vertices + 63) / 64;                       \
+    size_t size = bfs->size;                                                  \
+    size_t edges = atomic_load(&bfs->next_edges);                             \
+    VERTEX* swap = bfs->queue;                                                \
+                                                                              \
+    bfs->queue = bfs->next;                                                   \
+    bfs->next = swap;                                                         \
+    bfs->size = atomic_load(&bfs->next_size);                                 \
+    atomic_store(&bfs->next_size, 0);                                         \
+    atomic_store(&bfs->next_edges, 0);                                        \
+    atomic_store(&bfs->cursor, 0);                                            \
+    bfs->done = !bfs->size;                                                   \
+    bfs->unexplored -= edges < bfs->unexplored ? edges : bfs->unexplored;     \
+                                                                              \
+    if (!bfs->bottom_up)                                                      \
+      bfs->bottom_up = edges > bfs->unexplored / GRAPH_BFS_ALPHA              \
+                       && bfs->size > size;                                   \
+    else                                                                      \
+      bfs->bottom_up = !(bfs->size < graph->vertices / GRAPH_BFS_BETA         \
+                         && bfs->size < size);                                \
+                                                                              \
+    if (bfs->bottom_up)                                                       \
+    {                                                                         \
+      for (size_t i = 0; i < words; i++)                                      \
+        atomic_store_explicit(&bfs->frontier[i], 0, memory_order_relaxed);    \
+      for (size_t i = 0; i < bfs->size; i++)                                  \
+        atomic_fetch_or_explicit(&bfs->frontier[bfs->queue[i] / 64],          \
+                                 1ull << (bfs->queue[i] % 64),                \
+                                 memory_order_relaxed);                       \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static void* NAME##_bfs_thread(void* data)                                  \
+  {                                                                           \
+    s_bfs_##NAME* bfs = data;                                                 \
+                                                                              \
+    while (!atomic_load(&bfs->go))                                            \
+      sched_yield();                                                          \
+                                                                              \
+    while (!bfs->done)                                                        \
+    {                                                                         \
+      NAME##_bfs_level(bfs);                                                  \
+      if (pthread_barrier_wait(&bfs->barrier)                                 \
+          == PTHREAD_BARRIER_SERIAL_THREAD)                                   \
+        NAME##_bfs_next(bfs);                                                 \
+      pthread_barrier_wait(&bfs->barrier);                                    \
+    }                                                                         \
+                                                                              \
+    return NULL;                                                              \
+  }
+
+
+/**
+** @brief Breadth-first search from source, on threads threads (the calling
+**  one included). The search is direction-optimizing : levels with a small
+**  frontier are explored top-down, from the frontier to its neighbours, and
+**  levels with a large frontier bottom-up, from the unvisited vertices to
+**  the frontier, which then checks only a few edges per vertex instead of
+**  all the edges of the frontier. See GRAPH_BFS_ALPHA and GRAPH_BFS_BETA.
+**
+** @return the array of the parents of each vertex in the BFS tree (source
+**  is its own parent, unreached vertices have GRAPH_NONE(VERTEX)), to be
+**  freed by the caller. NULL is returned if an allocation failed.
+*/
+# define GRAPH_BFS(VERTEX, NAME)                                              \
+  VERTEX* NAME##_bfs(NAME* graph, VERTEX source, unsigned threads)            \
+  {                                                                           \
+    size_t words = ((size_t)graph->vertices + 63) / 64;                       \
+    s_bfs_##NAME bfs;                                                         \
+    pthread_t workers[threads ? threads : 1];                                 \
+    unsigned started = 0;                                                     \
+                                                                              \
+    if (source >= graph->vertices)                                            \
+      return NULL;                                                            \
+                                                                              \
+    bfs.graph = graph;                                                        \
+    bfs.parents = malloc(graph->vertices * sizeof (VERTEX));                  \
+    bfs.visited = calloc(words, sizeof (atomic_ullong));                      \
+    bfs.frontier = calloc(words, sizeof (atomic_ullong));                     \
+    bfs.queue = malloc(graph->vertices * sizeof (VERTEX));                    \
+    bfs.next = malloc(graph->vertices * sizeof (VERTEX));                     \
+    if (!bfs.parents || !bfs.visited || !bfs.frontier || !bfs.queue           \
+        || !bfs.next)                                                         \
+    {                                                                         \
+      free(bfs.parents);                                                      \
+      free(bfs.visited);                                                      \
+      free(bfs.frontier);                                                     \
+      free(bfs.queue);                                                        \
+      free(bfs.next);                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    for (VERTEX v = 0; v < graph->vertices; v++)                              \
+      bfs.parents[v] = GRAPH_NONE(VERTEX);                                    \
+    bfs.parents[source] = source;                                             \
+    atomic_store(&bfs.visited[source / 64], 1ull << (source % 64));           \
+    bfs.queue[0] = source;                                                    \
+    bfs.size = 1;                                                             \
+    atomic_init(&bfs.next_size, 0);                                           \
+    atomic_init(&bfs.next_edges, 0);                                          \
+    atomic_init(&bfs.cursor, 0);                                              \
+    bfs.unexplored = graph->edges;                                            \
+    bfs.bottom_up = FALSE;                                                    \
+    bfs.done = FALSE;                                                         \
+    atomic_init(&bfs.go, FALSE);                                              \
+                                                                              \
+    /* The workers wait until the barrier is sized for the threads that */    \
+    /* could actually be started : the others share the missing work.   */    \
+    for (; started + 1 < threads; started++)                                  \
+      if (pthread_create(&workers[started], NULL, NAME##_bfs_thread, &bfs))   \
+        break;                                                                \
+    pthread_barrier_init(&bfs.barrier, NULL, started + 1);                    \
+    atomic_store(&bfs.go, TRUE);                                              \
+                                                                              \
+    NAME##_bfs_thread(&bfs);                                                  \
+    for (unsigned i = 0; i < started; i++)                                    \
+      pthread_join(workers[i], NULL);                                         \
+                                                                              \
+    pthread_barrier_destroy(&bfs.barrier);                                    \
+    free(bfs.visited);                                                        \
+    free(bfs.frontier);                                                       \
+    free(bfs.queue);                                                          \
+    free(bfs.next);                                                           \
+                                                                              \
+    return bfs.parents;                                                       \
+  }
+
+
+#endif /* !GRAPH_HXX_ */
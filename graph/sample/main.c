@@ -0,0 +1,88 @@
+/******************************************************************************
+**                                                                           **
+**    Test code for the graph data structure                                 **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include "graph.h"
+
+/// @brief Visitor for an edge of the graph. Simply print the neighbour,
+//  followed by a space.
+///
+/// @param from The vertex whose neighbours are visited
+/// @param to The neighbour
+/// @param data Could possibly store data in that pointer
+void
+visitor(unsigned from, unsigned to, void* data)
+{
+  printf("%u ", to);
+}
+
+
+/// @brief Main function to test the graph structure : build a small grid,
+//  then search it from a corner.
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(void)
+{
+  graph_builder* builder = NULL;
+  graph* g = NULL;
+  unsigned* parents = NULL;
+
+  printf("\033[33m > Starting graph test\033[37m :\n\n");
+
+  // Creating builder
+  printf("[ \033[32mCreating\033[37m builder ..\n");
+  builder = graph_builder_create();
+  if (!builder)
+    return 1;
+  printf("Builder correctly created ] \n\n");
+
+  // 4 x 4 grid : vertex 4 * y + x is linked to its right and bottom
+  // neighbours
+  printf("[ \033[32mAdding\033[37m the edges of a 4 x 4 grid ..\n\n");
+  for (unsigned v = 0; v < 16; v++)
+  {
+    if (v % 4 < 3)
+      graph_builder_add(builder, v, v + 1);
+    if (v < 12)
+      graph_builder_add(builder, v, v + 4);
+  }
+  printf("Builder size : %zu\n\n", graph_builder_size(builder));
+
+  printf("[ \033[32mFreezing\033[37m the graph ..\n\n");
+  g = graph_freeze(builder, FALSE);
+  if (!g)
+    return 1;
+  printf("Vertices : %u, edges : %zu\n", graph_vertices(g), graph_edges(g));
+  printf("Degree of \033[32m5\033[37m : %zu\n", graph_degree(g, 5));
+  printf("Neighbours of \033[32m5\033[37m : ");
+  graph_visit_neighbours(g, 5, visitor, NULL);
+
+  printf("\n\n[ \033[32mSearching\033[37m from 0 with 2 threads ..\n\n");
+  parents = graph_bfs(g, 0, 2);
+  printf("Path from 15 to 0 : 15");
+  for (unsigned v = 15; v != 0; v = parents[v])
+    printf(" %u", parents[v]);
+  free(parents);
+
+  printf("\n\n[ \033[32mDeleting\033[37m the graph..\n\n");
+  graph_delete(g);
+
+  return 0;
+}
@@ -0,0 +1,189 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the hash map data structure                         **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "map.h"
+
+/// @brief Node of the chained baseline : one allocation per entry, as in
+//  most chained hash tables.
+struct chain_node
+{
+  uint64_t            key;
+  uint64_t            value;
+  struct chain_node*  next;
+};
+
+/// @brief Chained baseline, with a fixed number of buckets.
+struct chain
+{
+  struct chain_node** buckets;
+  unsigned            mask;
+};
+
+
+static void
+chain_insert(struct chain* c, uint64_t key, uint64_t value)
+{
+  struct chain_node** b = &c->buckets[hashmap_mix(key) & c->mask];
+  struct chain_node* n = *b;
+
+  for (; n; n = n->next)
+    if (n->key == key)
+    {
+      n->value = value;
+      return;
+    }
+
+  n = malloc(sizeof (*n));
+  n->key = key;
+  n->value = value;
+  n->next = *b;
+  *b = n;
+}
+
+
+static uint64_t*
+chain_get(struct chain* c, uint64_t key)
+{
+  for (struct chain_node* n = c->buckets[hashmap_mix(key) & c->mask]; n;
+       n = n->next)
+    if (n->key == key)
+      return &n->value;
+
+  return NULL;
+}
+
+
+static void
+chain_erase(struct chain* c, uint64_t key)
+{
+  struct chain_node** b = &c->buckets[hashmap_mix(key) & c->mask];
+
+  for (struct chain_node* n = *b; n; b = &n->next, n = n->next)
+    if (n->key == key)
+    {
+      *b = n->next;
+      free(n);
+      return;
+    }
+}
+
+
+/// @brief splitmix64, to generate distinct pseudo-random keys.
+static uint64_t
+key(uint64_t i)
+{
+  uint64_t z = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+/// @brief Fill both maps at load factor lf (of capacity slots / buckets)
+//  and print the ns/op of insert, successful and failed lookups and erase.
+static void
+bench(unsigned capacity, double lf)
+{
+  unsigned n = capacity * lf;
+  map* m = map_ncreate(n);
+  struct chain c = { calloc(capacity, sizeof (struct chain_node*)),
+                     capacity - 1 };
+  double t[2][4];
+  uint64_t sum = 0;
+
+  t[0][0] = now();
+  for (unsigned i = 0; i < n; i++)
+    map_insert(m, key(i), i);
+  t[0][0] = now() - t[0][0];
+  t[0][1] = now();
+  for (unsigned i = 0; i < n; i++)
+    sum += *map_get(m, key((i * 7919ull) % n));
+  t[0][1] = now() - t[0][1];
+  t[0][2] = now();
+  for (unsigned i = 0; i < n; i++)
+    sum += map_get(m, key(n + i)) != NULL;
+  t[0][2] = now() - t[0][2];
+  t[0][3] = now();
+  for (unsigned i = 0; i < n; i++)
+    map_erase(m, key(i), NULL);
+  t[0][3] = now() - t[0][3];
+
+  t[1][0] = now();
+  for (unsigned i = 0; i < n; i++)
+    chain_insert(&c, key(i), i);
+  t[1][0] = now() - t[1][0];
+  t[1][1] = now();
+  for (unsigned i = 0; i < n; i++)
+    sum += *chain_get(&c, key((i * 7919ull) % n));
+  t[1][1] = now() - t[1][1];
+  t[1][2] = now();
+  for (unsigned i = 0; i < n; i++)
+    sum += chain_get(&c, key(n + i)) != NULL;
+  t[1][2] = now() - t[1][2];
+  t[1][3] = now();
+  for (unsigned i = 0; i < n; i++)
+    chain_erase(&c, key(i));
+  t[1][3] = now() - t[1][3];
+
+  for (unsigned i = 0; i < 2; i++)
+    printf("%-8s %.1f  %8.2f %8.2f %8.2f %8.2f\n", i ? "chained" : "hashmap",
+           lf, t[i][0] / n, t[i][1] / n, t[i][2] / n, t[i][3] / n);
+  fprintf(stderr, "%lu\r", (unsigned long)sum);
+
+  map_delete(m, NULL);
+  free(c.buckets);
+}
+
+
+/// @brief Main function to benchmark the hash map against a chained
+//  hash table at load factors 0.5 to 0.9.
+//  Usage : ./bench [capacity]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned capacity = 1u << 20;
+
+  if (argc > 1)
+    while (capacity < strtoul(argv[1], NULL, 10))
+      capacity <<= 1;
+
+  printf("\033[33m > Hash maps, %u slots, ns/op\033[37m :\n\n", capacity);
+  printf("%-8s %s  %8s %8s %8s %8s\n", "map", "lf", "insert", "hit", "miss",
+         "erase");
+
+  for (double lf = 0.5; lf < 0.95; lf += 0.1)
+    bench(capacity, lf);
+
+  return 0;
+}
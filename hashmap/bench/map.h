@@ -0,0 +1,32 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the hash map data structure                         **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef MAP_H_
+# define MAP_H_
+
+/// @brief Let the map reach the load factors under test without growing.
+# define HASHMAP_MAX_LOAD 95
+
+# include "../hashmap.hxx"
+
+/// @brief This macro call will be replace at compile-time by
+//  prototypes and struct declarations for the hash map data-structure
+HASHMAP_HEADER(uint64_t, uint64_t, hashmap_hash_int, hashmap_equal_int, map)
+
+#endif /* !MAP_H_ */
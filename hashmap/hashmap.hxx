@@ -0,0 +1,746 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of open-addressing hash maps using X-macros           **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file hashmap.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of hash
+**  maps, based on open addressing. Besides the array of slots (key and
+**  value), the map keeps one control byte per slot : 0x80 when the slot is
+**  empty, or the 7 low bits of the hash of its key. A lookup compares the
+**  control bytes of HASHMAP_GROUP consecutive slots at once (with SSE2 when
+**  available), and only compares the keys whose 7 bits match.
+**
+**  Slots are probed linearly, so that an erase can move the following
+**  entries back instead of leaving a tombstone : a lookup always stops at
+**  the first empty slot, whatever the history of the map.
+**
+**  After specialization, assuming that you used NAME as the name of the
+**  structure, the names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_ncreate
+**    ~ NAME_delete
+**    ~ NAME_clear
+**
+**    ~ NAME_visit
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**    ~ NAME_capacity
+**    ~ NAME_reserve
+**
+**    ~ NAME_get
+**    ~ NAME_contains
+**
+**    ~ NAME_insert
+**    ~ NAME_insert_or_get
+**    ~ NAME_erase
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef HASHMAP_HXX_
+# define HASHMAP_HXX_
+
+# include <stdlib.h>
+# include <string.h>
+# include <stdint.h>
+# ifdef __SSE2__
+#  include <emmintrin.h>
+# endif
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Maximum load factor of the maps, in percent. When inserting would
+**  go past it, the capacity is doubled. Define it before including
+**  hashmap.hxx to change it.
+*/
+# ifndef HASHMAP_MAX_LOAD
+#  define HASHMAP_MAX_LOAD 87
+# endif
+
+/**
+** @brief Number of control bytes compared at once.
+*/
+# define HASHMAP_GROUP 16
+
+/**
+** @brief Control byte of an empty slot.
+*/
+# define HASHMAP_CTRL_EMPTY 0x80
+
+
+/**
+** @brief Return a bit mask of the slots of the group starting at ctrl whose
+**  control byte is h2.
+*/
+static inline unsigned hashmap_group_match(const unsigned char* ctrl,
+                                           unsigned char h2)
+{
+# ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+# else
+  unsigned mask = 0;
+
+  for (unsigned i = 0; i < HASHMAP_GROUP; i++)
+    mask |= (unsigned)(ctrl[i] == h2) << i;
+
+  return mask;
+# endif
+}
+
+/**
+** @brief Return a bit mask of the empty slots of the group starting at ctrl
+**  (the only control bytes with their high bit set).
+*/
+static inline unsigned hashmap_group_empty(const unsigned char* ctrl)
+{
+# ifdef __SSE2__
+  return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+# else
+  unsigned mask = 0;
+
+  for (unsigned i = 0; i < HASHMAP_GROUP; i++)
+    mask |= (unsigned)(ctrl[i] >> 7) << i;
+
+  return mask;
+# endif
+}
+
+/**
+** @brief Mix the bits of a user hash, so that the position (high bits) and
+**  the control byte (7 low bits) of a key are both usable even for weak
+**  hash functions such as the identity.
+*/
+static inline uint64_t hashmap_mix(uint64_t h)
+{
+  h *= 0x9E3779B97F4A7C15ull;
+  return h ^ (h >> 32);
+}
+
+/**
+** @brief Ready-to-use hash and equality functions for integer and string
+**  keys.
+*/
+static inline uint64_t hashmap_hash_int(uint64_t key)
+{
+  return key;
+}
+
+static inline bool hashmap_equal_int(uint64_t a, uint64_t b)
+{
+  return a == b;
+}
+
+static inline uint64_t hashmap_hash_str(const char* key)
+{
+  uint64_t h = 0xCBF29CE484222325ull;
+
+  while (*key)
+    h = (h ^ (unsigned char)*key++) * 0x100000001B3ull;
+
+  return h;
+}
+
+static inline bool hashmap_equal_str(const char* a, const char* b)
+{
+  return !strcmp(a, b);
+}
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  hash map data structure. As mentionned in the README, you should create
+**  a header file for your "specialized" structure, include hashmap.hxx and
+**  call this macro.
+**
+** @param KEY Is the type of the keys.
+** @param VALUE Is the type of the values.
+** @param HASH Is a function (or a macro) taking a KEY and returning an
+**  integer hash. (e.g : hashmap_hash_int)
+** @param EQUAL Is a function (or a macro) taking two KEYs and returning
+**  whether they are equal. (e.g : hashmap_equal_int)
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro. For exemple :
+**
+**    HASHMAP_HEADER(int, double, hashmap_hash_int, hashmap_equal_int, map)
+**
+**  Because a map stores two types, its visitor and destructor types are
+**  named NAME_visitor_func and NAME_destructor_func.
+*/
+# define HASHMAP_HEADER(KEY, VALUE, HASH, EQUAL, NAME)                        \
+  typedef struct                                                              \
+  {                                                                           \
+    KEY   key;                                                                \
+    VALUE value;                                                              \
+  } s_slot_##NAME;                                                            \
+                                                                              \
+  typedef struct                                                              \
+  {                                                                           \
+    unsigned char*  ctrl;                                                     \
+    s_slot_##NAME*  slots;                                                    \
+    unsigned        mask;                                                     \
+    unsigned        count;                                                    \
+  } NAME;                                                                     \
+                                                                              \
+  typedef void (*NAME##_visitor_func)(KEY, VALUE, void*);                     \
+  typedef void (*NAME##_destructor_func)(KEY, VALUE);                         \
+                                                                              \
+  HASHMAP_CREATE_HEADER(KEY, VALUE, NAME);                                    \
+  HASHMAP_NCREATE_HEADER(KEY, VALUE, NAME);                                   \
+  HASHMAP_DELETE_HEADER(KEY, VALUE, NAME);                                    \
+  HASHMAP_CLEAR_HEADER(KEY, VALUE, NAME);                                     \
+  HASHMAP_VISIT_HEADER(KEY, VALUE, NAME);                                     \
+  HASHMAP_EMPTY_HEADER(KEY, VALUE, NAME);                                     \
+  HASHMAP_SIZE_HEADER(KEY, VALUE, NAME);                                      \
+  HASHMAP_CAPACITY_HEADER(KEY, VALUE, NAME);                                  \
+  HASHMAP_RESERVE_HEADER(KEY, VALUE, NAME);                                   \
+  HASHMAP_GET_HEADER(KEY, VALUE, NAME);                                       \
+  HASHMAP_CONTAINS_HEADER(KEY, VALUE, NAME);                                  \
+  HASHMAP_INSERT_HEADER(KEY, VALUE, NAME);                                    \
+  HASHMAP_INSERT_OR_GET_HEADER(KEY, VALUE, NAME);                             \
+  HASHMAP_ERASE_HEADER(KEY, VALUE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on hash maps. As mentionned in the
+**  README you should create a source file for your "specialized" structure,
+**  include your header file (that contains the call to the macro
+**  HASHMAP_HEADER) and call the macro with the *same arguments* as in the
+**  header.
+*/
+# define HASHMAP_SOURCE(KEY, VALUE, HASH, EQUAL, NAME)                        \
+  HASHMAP_SET_CTRL(KEY, VALUE, NAME)                                          \
+  HASHMAP_ALLOC(KEY, VALUE, NAME)                                             \
+  HASHMAP_FIND(KEY, VALUE, HASH, EQUAL, NAME)                                 \
+  HASHMAP_REHASH(KEY, VALUE, HASH, NAME)                                      \
+  HASHMAP_CREATE(KEY, VALUE, NAME)                                            \
+  HASHMAP_NCREATE(KEY, VALUE, NAME)                                           \
+  HASHMAP_DELETE(KEY, VALUE, NAME)                                            \
+  HASHMAP_CLEAR(KEY, VALUE, NAME)                                             \
+  HASHMAP_VISIT(KEY, VALUE, NAME)                                             \
+  HASHMAP_EMPTY(KEY, VALUE, NAME)                                             \
+  HASHMAP_SIZE(KEY, VALUE, NAME)                                              \
+  HASHMAP_CAPACITY(KEY, VALUE, NAME)                                          \
+  HASHMAP_RESERVE(KEY, VALUE, NAME)                                           \
+  HASHMAP_GET(KEY, VALUE, HASH, NAME)                                         \
+  HASHMAP_CONTAINS(KEY, VALUE, NAME)                                          \
+  HASHMAP_INSERT_OR_GET(KEY, VALUE, HASH, NAME)                               \
+  HASHMAP_INSERT(KEY, VALUE, NAME)                                            \
+  HASHMAP_ERASE(KEY, VALUE, HASH, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define HASHMAP_CREATE_HEADER(KEY, VALUE, NAME)                              \
+  NAME* NAME##_create()
+
+# define HASHMAP_NCREATE_HEADER(KEY, VALUE, NAME)                             \
+  NAME* NAME##_ncreate(unsigned size)
+
+# define HASHMAP_DELETE_HEADER(KEY, VALUE, NAME)                              \
+  void NAME##_delete(NAME* map, NAME##_destructor_func dest)
+
+# define HASHMAP_CLEAR_HEADER(KEY, VALUE, NAME)                               \
+  void NAME##_clear(NAME* map, NAME##_destructor_func dest)
+
+
+// Visiting
+
+# define HASHMAP_VISIT_HEADER(KEY, VALUE, NAME)                               \
+  void NAME##_visit(NAME* map, NAME##_visitor_func v, void* data)
+
+
+// Capacity
+
+# define HASHMAP_EMPTY_HEADER(KEY, VALUE, NAME)                               \
+  bool NAME##_empty(NAME* map)
+
+# define HASHMAP_SIZE_HEADER(KEY, VALUE, NAME)                                \
+  unsigned NAME##_size(NAME* map)
+
+# define HASHMAP_CAPACITY_HEADER(KEY, VALUE, NAME)                            \
+  unsigned NAME##_capacity(NAME* map)
+
+# define HASHMAP_RESERVE_HEADER(KEY, VALUE, NAME)                             \
+  bool NAME##_reserve(NAME* map, unsigned n)
+
+
+// Lookup
+
+# define HASHMAP_GET_HEADER(KEY, VALUE, NAME)                                 \
+  VALUE* NAME##_get(NAME* map, KEY key)
+
+# define HASHMAP_CONTAINS_HEADER(KEY, VALUE, NAME)                            \
+  bool NAME##_contains(NAME* map, KEY key)
+
+
+// Modifiers
+
+# define HASHMAP_INSERT_HEADER(KEY, VALUE, NAME)                              \
+  bool NAME##_insert(NAME* map, KEY key, VALUE value)
+
+# define HASHMAP_INSERT_OR_GET_HEADER(KEY, VALUE, NAME)                       \
+  VALUE* NAME##_insert_or_get(NAME* map, KEY key, bool* inserted)
+
+# define HASHMAP_ERASE_HEADER(KEY, VALUE, NAME)                               \
+  bool NAME##_erase(NAME* map, KEY key, NAME##_destructor_func dest)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Set the control byte of slot i. The first HASHMAP_GROUP control
+**  bytes are mirrored after the last one, so that a group can always be
+**  loaded at once, even when it wraps around the end of the table.
+*/
+# define HASHMAP_SET_CTRL(KEY, VALUE, NAME)                                   \
+  static inline void NAME##_set_ctrl(NAME* map, unsigned i, unsigned char c)  \
+  {                                                                           \
+    map->ctrl[i] = c;                                                         \
+    if (i < HASHMAP_GROUP)                                                    \
+      map->ctrl[map->mask + 1 + i] = c;                                       \
+  }
+
+
+/**
+** @brief Allocate empty control bytes and slots for capacity slots
+**  (capacity is a power of two, at least HASHMAP_GROUP).
+**
+** @return 0 if all went ok, 1 if an allocation failed.
+*/
+# define HASHMAP_ALLOC(KEY, VALUE, NAME)                                      \
+  static int NAME##_alloc(NAME* map, unsigned capacity)                       \
+  {                                                                           \
+    if (!(map->ctrl = malloc(capacity + HASHMAP_GROUP)))                      \
+      return 1;                                                               \
+    if (!(map->slots = malloc(capacity * sizeof (s_slot_##NAME))))            \
+    {                                                                         \
+      free(map->ctrl);                                                        \
+      return 1;                                                               \
+    }                                                                         \
+                                                                              \
+    memset(map->ctrl, HASHMAP_CTRL_EMPTY, capacity + HASHMAP_GROUP);          \
+    map->mask = capacity - 1;                                                 \
+    map->count = 0;                                                           \
+                                                                              \
+    return 0;                                                                 \
+  }
+
+
+/**
+** @brief Probe the map for key, whose mixed hash is h. Groups of control
+**  bytes are scanned from the home position of the key until one of them
+**  holds an empty slot : as there are no tombstones, the key cannot be
+**  further away.
+**
+** @return the slot holding key if it is found. Otherwise, the empty slot
+**  where key would be inserted, with the 0x80000000 bit set.
+*/
+# define HASHMAP_FIND(KEY, VALUE, HASH, EQUAL, NAME)                          \
+  static unsigned NAME##_find(NAME* map, KEY key, uint64_t h)                 \
+  {                                                                           \
+    unsigned pos = (h >> 7) & map->mask;                                      \
+    unsigned match = 0;                                                       \
+    unsigned empty = 0;                                                       \
+    unsigned slot = 0;                                                        \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+      match = hashmap_group_match(map->ctrl + pos, h & 0x7F);                 \
+      empty = hashmap_group_empty(map->ctrl + pos);                           \
+      if (empty)                                                              \
+        match &= empty - 1;                                                   \
+                                                                              \
+      for (; match; match &= match - 1)                                       \
+      {                                                                       \
+        slot = (pos + __builtin_ctz(match)) & map->mask;                      \
+        if (EQUAL(map->slots[slot].key, key))                                 \
+          return slot;                                                        \
+      }                                                                       \
+                                                                              \
+      if (empty)                                                              \
+        return ((pos + __builtin_ctz(empty)) & map->mask) | 0x80000000u;      \
+                                                                              \
+      pos = (pos + HASHMAP_GROUP) & map->mask;                                \
+    }                                                                         \
+  }
+
+
+/**
+** @brief Move every entry in a new table of the given capacity. Keys are
+**  known to be distinct, so they are simply put in the first empty slot
+**  from their home position.
+**
+** @return 0 if all went ok, 1 if an allocation failed (the map is left
+**  untouched).
+*/
+# define HASHMAP_REHASH(KEY, VALUE, HASH, NAME)                               \
+  static int NAME##_rehash(NAME* map, unsigned capacity)                      \
+  {                                                                           \
+    unsigned char* old_ctrl = map->ctrl;                                      \
+    s_slot_##NAME* old_slots = map->slots;                                    \
+    unsigned old_mask = map->mask;                                            \
+    unsigned old_count = map->count;                                          \
+    uint64_t h = 0;                                                           \
+    unsigned pos = 0;                                                         \
+    unsigned empty = 0;                                                       \
+                                                                              \
+    if (NAME##_alloc(map, capacity))                                          \
+    {                                                                         \
+      map->ctrl = old_ctrl;                                                   \
+      map->slots = old_slots;                                                 \
+      map->mask = old_mask;                                                   \
+      map->count = old_count;                                                 \
+      return 1;                                                               \
+    }                                                                         \
+                                                                              \
+    for (unsigned i = 0; i <= old_mask; i++)                                  \
+      if (!(old_ctrl[i] & HASHMAP_CTRL_EMPTY))                                \
+      {                                                                       \
+        h = hashmap_mix(HASH(old_slots[i].key));                              \
+        pos = (h >> 7) & map->mask;                                           \
+        while (!(empty = hashmap_group_empty(map->ctrl + pos)))               \
+          pos = (pos + HASHMAP_GROUP) & map->mask;                            \
+        pos = (pos + __builtin_ctz(empty)) & map->mask;                       \
+                                                                              \
+        NAME##_set_ctrl(map, pos, h & 0x7F);                                  \
+        map->slots[pos] = old_slots[i];                                       \
+      }                                                                       \
+                                                                              \
+    map->count = old_count;                                                   \
+    free(old_ctrl);                                                           \
+    free(old_slots);                                                          \
+                                                                              \
+    return 0;                                                                 \
+  }
+
+
+/**
+** @brief Simply call the ncreate function with a default value,
+**  see bellow for more details.
+*/
+# define HASHMAP_CREATE(KEY, VALUE, NAME)                                     \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    return NAME##_ncreate(42);                                                \
+  }
+
+
+/**
+** @brief Create a new, empty map able to hold size entries without being
+**  rehashed.
+**
+** @param size is the number of entries to make room for
+**
+** @return a pointer on the new allocated map. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define HASHMAP_NCREATE(KEY, VALUE, NAME)                                    \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_map = malloc(sizeof (NAME));                                    \
+                                                                              \
+    if (!new_map)                                                             \
+      return NULL;                                                            \
+                                                                              \
+    new_map->ctrl = NULL;                                                     \
+    new_map->slots = NULL;                                                    \
+    new_map->mask = 0;                                                        \
+    new_map->count = 0;                                                       \
+                                                                              \
+    if (!NAME##_reserve(new_map, size))                                       \
+    {                                                                         \
+      free(new_map);                                                          \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    return new_map;                                                           \
+  }
+
+
+/**
+** @brief Clear the map, then free it.
+**
+** @param map The map to delete
+** @param dest The function pointer to call on each entry so as to delete
+**  it if needed (this pointer could be NULL if no freeing is needed).
+*/
+# define HASHMAP_DELETE(KEY, VALUE, NAME)                                     \
+  void NAME##_delete(NAME* map, NAME##_destructor_func dest)                  \
+  {                                                                           \
+    NAME##_clear(map, dest);                                                  \
+    free(map->ctrl);                                                          \
+    free(map->slots);                                                         \
+    free(map);                                                                \
+  }
+
+
+/**
+** @brief Remove every entry, calling the destructor on each of them if one
+**  is given. The capacity is kept.
+*/
+# define HASHMAP_CLEAR(KEY, VALUE, NAME)                                      \
+  void NAME##_clear(NAME* map, NAME##_destructor_func dest)                   \
+  {                                                                           \
+    if (dest)                                                                 \
+      for (unsigned i = 0; i <= map->mask; i++)                               \
+        if (!(map->ctrl[i] & HASHMAP_CTRL_EMPTY))                             \
+          dest(map->slots[i].key, map->slots[i].value);                       \
+                                                                              \
+    memset(map->ctrl, HASHMAP_CTRL_EMPTY, map->mask + 1 + HASHMAP_GROUP);     \
+    map->count = 0;                                                           \
+  }
+
+
+/**
+** @brief Call the visitor on each entry of the map, in no particular order.
+*/
+# define HASHMAP_VISIT(KEY, VALUE, NAME)                                      \
+  void NAME##_visit(NAME* map, NAME##_visitor_func v, void* data)             \
+  {                                                                           \
+    for (unsigned i = 0; i <= map->mask; i++)                                 \
+      if (!(map->ctrl[i] & HASHMAP_CTRL_EMPTY))                               \
+        v(map->slots[i].key, map->slots[i].value, data);                      \
+  }
+
+
+/**
+** @return TRUE (1) if the map is empty (or NULL) and 0 otherwise
+*/
+# define HASHMAP_EMPTY(KEY, VALUE, NAME)                                      \
+  bool NAME##_empty(NAME* map)                                                \
+  {                                                                           \
+    return !(map && map->count);                                              \
+  }
+
+
+/**
+** @return the number of entries in the map
+*/
+# define HASHMAP_SIZE(KEY, VALUE, NAME)                                       \
+  unsigned NAME##_size(NAME* map)                                             \
+  {                                                                           \
+    return map->count;                                                        \
+  }
+
+
+/**
+** @return the number of slots of the map
+*/
+# define HASHMAP_CAPACITY(KEY, VALUE, NAME)                                   \
+  unsigned NAME##_capacity(NAME* map)                                         \
+  {                                                                           \
+    return map->mask + 1;                                                     \
+  }
+
+
+/**
+** @brief Make room for n entries at once, so that inserting them will not
+**  rehash the map.
+**
+** @return TRUE if all went ok, FALSE if an allocation failed.
+*/
+# define HASHMAP_RESERVE(KEY, VALUE, NAME)                                    \
+  bool NAME##_reserve(NAME* map, unsigned n)                                  \
+  {                                                                           \
+    unsigned capacity = HASHMAP_GROUP;                                        \
+                                                                              \
+    while ((uint64_t)capacity * HASHMAP_MAX_LOAD < (uint64_t)n * 100)         \
+      capacity <<= 1;                                                         \
+                                                                              \
+    if (map->ctrl && capacity <= map->mask + 1)                               \
+      return TRUE;                                                            \
+    if (!map->ctrl)                                                           \
+      return !NAME##_alloc(map, capacity);                                    \
+                                                                              \
+    return !NAME##_rehash(map, capacity);                                     \
+  }
+
+
+/**
+** @brief Return a pointer on the value associated to key, or NULL if key is
+**  not in the map. The pointer is valid until the next insertion or erase.
+*/
+# define HASHMAP_GET(KEY, VALUE, HASH, NAME)                                  \
+  VALUE* NAME##_get(NAME* map, KEY key)                                       \
+  {                                                                           \
+    unsigned slot = NAME##_find(map, key, hashmap_mix(HASH(key)));            \
+                                                                              \
+    return slot & 0x80000000u ? NULL : &map->slots[slot].value;               \
+  }
+
+
+/**
+** @return TRUE if key is in the map, FALSE otherwise.
+*/
+# define HASHMAP_CONTAINS(KEY, VALUE, NAME)                                   \
+  bool NAME##_contains(NAME* map, KEY key)                                    \
+  {                                                                           \
+    return NAME##_get(map, key) != NULL;                                      \
+  }
+
+
+/**
+** @brief Return a pointer on the value associated to key, inserting key if
+**  it is not in the map yet (the value is then left uninitialized, and
+**  *inserted is set to TRUE). The key is hashed only once, even if the map
+**  has to grow.
+**
+** @param map the map
+** @param key the key to look for
+** @param inserted if not NULL, set to TRUE if key was inserted and FALSE
+**  if it was already in the map.
+**
+** @return a pointer on the value, valid until the next insertion or erase,
+**  or NULL if an allocation failed.
+*/
+# define HASHMAP_INSERT_OR_GET(KEY, VALUE, HASH, NAME)                        \
+  VALUE* NAME##_insert_or_get(NAME* map, KEY key, bool* inserted)             \
+  {                                                                           \
+    uint64_t h = hashmap_mix(HASH(key));                                      \
+    unsigned slot = NAME##_find(map, key, h);                                 \
+                                                                              \
+    if (inserted)                                                             \
+      *inserted = FALSE;                                                      \
+    if (!(slot & 0x80000000u))                                                \
+      return &map->slots[slot].value;                                         \
+                                                                              \
+    if ((uint64_t)(map->count + 1) * 100                                      \
+        > (uint64_t)(map->mask + 1) * HASHMAP_MAX_LOAD)                       \
+    {                                                                         \
+      if (NAME##_rehash(map, 2 * (map->mask + 1)))                            \
+        return NULL;                                                          \
+      slot = NAME##_find(map, key, h);                                        \
+    }                                                                         \
+                                                                              \
+    slot &= map->mask;                                                        \
+    NAME##_set_ctrl(map, slot, h & 0x7F);                                     \
+    map->slots[slot].key = key;                                               \
+    map->count++;                                                             \
+    if (inserted)                                                             \
+      *inserted = TRUE;                                                       \
+                                                                              \
+    return &map->slots[slot].value;                                           \
+  }
+
+
+/**
+** @brief Associate value to key, replacing the previous value if key was
+**  already in the map.
+**
+** @return TRUE if key was inserted, FALSE if it was already in the map (or
+**  if an allocation failed).
+*/
+# define HASHMAP_INSERT(KEY, VALUE, NAME)                                     \
+  bool NAME##_insert(NAME* map, KEY key, VALUE value)                         \
+  {                                                                           \
+    bool inserted = FALSE;                                                    \
+    VALUE* slot = NAME##_insert_or_get(map, key, &inserted);                  \
+                                                                              \
+    if (slot)                                                                 \
+      *slot = value;                                                          \
+                                                                              \
+    return inserted;                                                          \
+  }
+
+
+/**
+** @brief Remove key from the map. Instead of leaving a tombstone, the
+**  following entries (up to the next empty slot) that would no longer be
+**  reachable from their home position are moved back into the hole.
+**
+** @param map the map
+** @param key the key to remove
+** @param dest The function pointer to call on the entry so as to delete it
+**  if needed (this pointer could be NULL if no freeing is needed).
+**
+** @return TRUE if key was in the map, FALSE otherwise.
+*/
+# define HASHMAP_ERASE(KEY, VALUE, HASH, NAME)                                \
+  bool NAME##_erase(NAME* map, KEY key, NAME##_destructor_func dest)          \
+  {                                                                           \
+    unsigned hole = NAME##_find(map, key, hashmap_mix(HASH(key)));            \
+    unsigned next = hole;                                                     \
+    unsigned home = 0;                                                        \
+                                                                              \
+    if (hole & 0x80000000u)                                                   \
+      return FALSE;                                                           \
+    if (dest)                                                                 \
+      dest(map->slots[hole].key, map->slots[hole].value);                     \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+      next = (next + 1) & map->mask;                                          \
+      if (map->ctrl[next] & HASHMAP_CTRL_EMPTY)                               \
+        break;                                                                \
+                                                                              \
+      home = (hashmap_mix(HASH(map->slots[next].key)) >> 7) & map->mask;      \
+      if (((next - home) & map->mask) < ((next - hole) & map->mask))          \
+        continue;                                                             \
+                                                                              \
+      NAME##_set_ctrl(map, hole, map->ctrl[next]);                            \
+      map->slots[hole] = map->slots[next];                                    \
+      hole = next;                                                            \
+    }                                                                         \
+                                                                              \
+    NAME##_set_ctrl(map, hole, HASHMAP_CTRL_EMPTY);                           \
+    map->count--;                                                             \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+#endif /* !HASHMAP_HXX_ */
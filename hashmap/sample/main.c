@@ -0,0 +1,86 @@
+/******************************************************************************
+**                                                                           **
+**    Sample code for the hash map data structure                            **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include "hashmap.h"
+
+/// @brief Visitor for an entry of the map. Simply print the key and
+//  the value on stdout, followed by a eol.
+///
+/// @param key The word
+/// @param count The number of times the word was seen
+/// @param data Could possibly store data in that pointer
+void
+visitor(const char* key, int count, void* data)
+{
+  printf("%s : %i\n", key, count);
+}
+
+
+/// @brief Main function to test the hash map structure : count the
+//  occurences of each word of a sentence.
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(void)
+{
+  const char* words[] = { "the", "quick", "brown", "fox", "jumps", "over",
+                          "the", "lazy", "dog", "and", "the", "fox", "runs" };
+  map* m = NULL;
+  bool inserted = FALSE;
+  int* count = NULL;
+
+  printf("\033[33m > Starting hash map test\033[37m :\n\n");
+
+  // Creating map
+  printf("[ \033[32mCreating\033[37m map ..\n");
+  m = map_create();
+  if (!m)
+    return 1;
+  printf("Map correctly created ] \n\n");
+
+  printf("Is the map empty ? > %s\n", (map_empty(m) ? "yes" : "no"));
+  printf("Map size : %i\n\n", map_size(m));
+
+  // Counting words : each word is hashed only once
+  printf("[ \033[32mCounting\033[37m the words of a sentence ..\n\n");
+  for (unsigned i = 0; i < sizeof (words) / sizeof (*words); i++)
+  {
+    count = map_insert_or_get(m, words[i], &inserted);
+    *count = inserted ? 1 : *count + 1;
+  }
+
+  printf("Is the map empty ? > %s\n", (map_empty(m) ? "yes" : "no"));
+  printf("Map size : %i\n\n", map_size(m));
+
+  printf("\033[32mthe\033[37m was seen %i times\n", *map_get(m, "the"));
+  printf("Does the map contain \033[32mcat\033[37m ? > %s\n\n",
+         (map_contains(m, "cat") ? "yes" : "no"));
+
+  printf("[ \033[32mErasing\033[37m fox ..\n\n");
+  map_erase(m, "fox", NULL);
+
+  printf("\033[32mVisiting\033[37m the map ..\n");
+  map_visit(m, visitor, NULL);
+
+  printf("\n[ \033[32mDeleting\033[37m the map..\n\n");
+  map_delete(m, NULL);
+
+  return 0;
+}
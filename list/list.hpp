@@ -0,0 +1,344 @@
+/******************************************************************************
+**                                                                           **
+**    C++ front-end of the doubly linked list                                **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file list.hpp
+**
+** @author Remi BERSON
+**
+** @brief This file contains ds::list, the C++ counterpart of the lists of
+**  list.hxx (see cxx/memory.hpp for what the C++ containers have in
+**  common). As in LIST_HEADER, the list holds a pointer on a sentry node,
+**  a pointer on the last node and the number of elements, and each node
+**  holds the element, then the previous and the next nodes. The element of
+**  the sentry is never constructed.
+**
+**  The C functions generated by the macros are not affected by this file,
+**  which does not include list.hxx.
+*/
+
+
+#ifndef LIST_HPP_
+# define LIST_HPP_
+
+# include "../cxx/memory.hpp"
+
+namespace ds
+{
+  namespace detail
+  {
+    /**
+    ** @brief A node of ds::list, laid out as s_node_NAME. The union lets
+    **  the sentry leave its element unconstructed.
+    */
+    template <typename T>
+    struct list_node
+    {
+      union
+      {
+        T               elt;
+      };
+      list_node*        previous;
+      list_node*        next;
+
+      list_node() noexcept
+      {
+      }
+
+      ~list_node()
+      {
+      }
+    };
+  }
+
+
+  template <typename T, typename Alloc = malloc_allocator<T>>
+  class list
+    : private std::allocator_traits<Alloc>::template
+        rebind_alloc<detail::list_node<T>>
+  {
+    using node = detail::list_node<T>;
+    using node_alloc = typename std::allocator_traits<Alloc>::template
+      rebind_alloc<node>;
+    using traits = std::allocator_traits<node_alloc>;
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = unsigned;
+
+    // Construction / Destruction
+
+    explicit list(const Alloc& alloc = Alloc())
+      : node_alloc(alloc), first_(allocate()), last_(first_), size_(0)
+    {
+      first_->previous = nullptr;
+      first_->next = nullptr;
+    }
+
+    list(const list& other)
+      : list(Alloc(traits::select_on_container_copy_construction(
+                     static_cast<const node_alloc&>(other))))
+    {
+      other.visit([this](const T& elt) { emplace_back(elt); });
+    }
+
+    /**
+    ** @brief Take the nodes of other, which gets a new sentry : unlike the
+    **  other containers, moving a list allocates.
+    */
+    list(list&& other)
+      : list(Alloc(static_cast<const node_alloc&>(other)))
+    {
+      swap(other);
+    }
+
+    list& operator=(list other) noexcept
+    {
+      swap(other);
+      return *this;
+    }
+
+    ~list()
+    {
+      clear();
+      deallocate(first_);
+    }
+
+    // Visiting
+
+    /**
+    ** @brief Call visit(elt) on each element, from the first one to the
+    **  last one. The visitor is a template parameter (a lambda, a function
+    **  object...) : its call is inlined in the loop.
+    */
+    template <typename Visitor>
+    void visit(Visitor&& visit)
+    {
+      for (node* tmp = first_->next; tmp; tmp = tmp->next)
+        visit(tmp->elt);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visit) const
+    {
+      for (const node* tmp = first_->next; tmp; tmp = tmp->next)
+        visit(tmp->elt);
+    }
+
+    // Capacity
+
+    unsigned size() const noexcept
+    {
+      return size_;
+    }
+
+    bool empty() const noexcept
+    {
+      return !size_;
+    }
+
+    // Element access
+
+    T& front() noexcept
+    {
+      return first_->next->elt;
+    }
+
+    T& back() noexcept
+    {
+      return last_->elt;
+    }
+
+    // Modifiers
+
+    void push_front(const T& elt)
+    {
+      emplace_front(elt);
+    }
+
+    void push_front(T&& elt)
+    {
+      emplace_front(std::move(elt));
+    }
+
+    void push_back(const T& elt)
+    {
+      emplace_back(elt);
+    }
+
+    void push_back(T&& elt)
+    {
+      emplace_back(std::move(elt));
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args)
+    {
+      return link(first_, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+      return link(last_, std::forward<Args>(args)...);
+    }
+
+    void insert(unsigned pos, const T& elt)
+    {
+      emplace(pos, elt);
+    }
+
+    void insert(unsigned pos, T&& elt)
+    {
+      emplace(pos, std::move(elt));
+    }
+
+    /**
+    ** @brief Construct an element from args at position pos (at the end if
+    **  pos >= size), walking the list from its first node.
+    */
+    template <typename... Args>
+    T& emplace(unsigned pos, Args&&... args)
+    {
+      node* previous = first_;
+
+      if (pos >= size_)
+        previous = last_;
+      else
+        while (pos--)
+          previous = previous->next;
+
+      return link(previous, std::forward<Args>(args)...);
+    }
+
+    /**
+    ** @brief Remove and return the first element, moved out of its node.
+    */
+    T pop_front()
+    {
+      return unlink(first_->next);
+    }
+
+    T pop_back()
+    {
+      return unlink(last_);
+    }
+
+    void clear() noexcept
+    {
+      node* tmp = first_->next;
+      node* next = nullptr;
+
+      last_ = first_;
+      size_ = 0;
+      first_->next = nullptr;
+
+      while (tmp)
+      {
+        next = tmp->next;
+        tmp->elt.~T();
+        deallocate(tmp);
+        tmp = next;
+      }
+    }
+
+    void swap(list& other) noexcept
+    {
+      std::swap(static_cast<node_alloc&>(*this),
+                static_cast<node_alloc&>(other));
+      std::swap(first_, other.first_);
+      std::swap(last_, other.last_);
+      std::swap(size_, other.size_);
+    }
+
+  private:
+    node* allocate()
+    {
+      return new (traits::allocate(*this, 1)) node;
+    }
+
+    void deallocate(node* tmp) noexcept
+    {
+      tmp->~node();
+      traits::deallocate(*this, tmp, 1);
+    }
+
+    /**
+    ** @brief Construct an element from args in a new node, linked after
+    **  previous.
+    */
+    template <typename... Args>
+    T& link(node* previous, Args&&... args)
+    {
+      node* new_node = allocate();
+
+      try
+      {
+        new (&new_node->elt) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        deallocate(new_node);
+        throw;
+      }
+
+      new_node->previous = previous;
+      new_node->next = previous->next;
+      if (previous->next)
+        previous->next->previous = new_node;
+      else
+        last_ = new_node;
+      previous->next = new_node;
+      size_++;
+
+      return new_node->elt;
+    }
+
+    /**
+    ** @brief Unlink tmp from the list and free it.
+    **
+    ** @return its element.
+    */
+    T unlink(node* tmp)
+    {
+      T elt(std::move(tmp->elt));
+
+      tmp->previous->next = tmp->next;
+      if (tmp->next)
+        tmp->next->previous = tmp->previous;
+      else
+        last_ = tmp->previous;
+      size_--;
+
+      tmp->elt.~T();
+      deallocate(tmp);
+      return elt;
+    }
+
+    node*       first_;
+    node*       last_;
+    unsigned    size_;
+  };
+}
+
+#endif /* !LIST_HPP_ */
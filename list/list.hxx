@@ -50,6 +50,14 @@
 **    ~ NAME_pop_front
 **    ~ NAME_insert
 **
+**  The LIST_HEADER_POOLED / LIST_SOURCE_POOLED variant provides the same
+**  functions, but takes its nodes from slab-allocated chunks (an arena)
+**  instead of calling malloc / free for each node. It adds :
+**
+**    ~ NAME_create_shared
+**    ~ NAME_arena_create
+**    ~ NAME_arena_delete
+**
 **  See bellow for more details about this functions.
 */
 
@@ -58,7 +66,16 @@
 # define LIST_HXX_
 
 # include <stdlib.h>
+# include "../stats/stats.hxx"
 
+/**
+**  @brief Default number of nodes allocated at once by the arena of a pooled
+**  list created with NAME_create. Define it before including list.hxx to
+**  change it.
+*/
+# ifndef LIST_POOL_CHUNK
+#  define LIST_POOL_CHUNK 256
+# endif
 
 /**
 **  @brief Defines the value TRUE to use with the boolean type.
@@ -101,6 +118,7 @@ typedef char bool;
     s_node_##NAME*  first;                                                    \
     s_node_##NAME*  last;                                                     \
     unsigned        size;                                                     \
+    DS_STATS_MEMBER                                                           \
   };                                                                          \
                                                                               \
   struct s_node_##NAME                                                        \
@@ -125,7 +143,8 @@ typedef char bool;
   LIST_BACK_HEADER(TYPE, NAME);                                               \
   LIST_EMPTY_HEADER(TYPE, NAME);                                              \
   LIST_DELETE_HEADER(TYPE, NAME);                                             \
-  LIST_CLEAR_HEADER(TYPE, NAME);
+  LIST_CLEAR_HEADER(TYPE, NAME);                                              \
+  DS_STATS_HEADER(NAME)
 
 
 /**
@@ -148,7 +167,8 @@ typedef char bool;
   LIST_BACK(TYPE, NAME)                                                       \
   LIST_EMPTY(TYPE, NAME)                                                      \
   LIST_DELETE(TYPE, NAME)                                                     \
-  LIST_CLEAR(TYPE, NAME)
+  LIST_CLEAR(TYPE, NAME)                                                      \
+  DS_STATS_SOURCE(TYPE, NAME, size, size)
 
 
 
@@ -262,6 +282,7 @@ typedef char bool;
     new_list->first = sentry;                                                 \
     new_list->last = sentry;                                                  \
     new_list->size = 0;                                                       \
+    DS_STATS_INIT(new_list);                                                  \
                                                                               \
     return new_list;                                                          \
   }
@@ -291,8 +312,9 @@ typedef char bool;
 
 /**
 ** @brief Walk through the list and, if a destructor has been given, call
-**  if on each element of the list. We also reset the size to 0 (empty list)
-**  and make the last en first elements of the list to be the sentry.
+**  if on each element of the list, then free the node. We also reset the
+**  size to 0 (empty list) and make the last en first elements of the list to
+**  be the sentry.
 **
 ** @param TYPE type of the elements that will be stored in the list
 ** @param NAME name of the list structure
@@ -304,7 +326,9 @@ typedef char bool;
 # define LIST_CLEAR(TYPE, NAME)                                               \
   void NAME##_clear(NAME* list, destructor_func dest)                         \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME* tmp = list->first->next;                                   \
+    s_node_##NAME* next = NULL;                                               \
                                                                               \
     list->last = list->first;                                                 \
     list->size = 0;                                                           \
@@ -314,8 +338,11 @@ typedef char bool;
     {                                                                         \
       if (dest)                                                               \
         dest(tmp->elt);                                                       \
-      tmp = tmp->next;                                                        \
+      next = tmp->next;                                                       \
+      free(tmp);                                                              \
+      tmp = next;                                                             \
     }                                                                         \
+    DS_STATS_STOP(list, CLEAR, stats_start);                                  \
   }
 
 
@@ -350,12 +377,14 @@ typedef char bool;
 # define LIST_VISIT(TYPE, NAME)                                               \
   void NAME##_visit(NAME* list, visitor_func v, void* data)                   \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME* tmp = list->first->next;                                   \
     while (tmp)                                                               \
     {                                                                         \
       v(tmp->elt, data);                                                      \
       tmp = tmp->next;                                                        \
     }                                                                         \
+    DS_STATS_STOP(list, VISIT, stats_start);                                  \
   }
 
 
@@ -388,6 +417,7 @@ typedef char bool;
 # define LIST_PUSH_FRONT(TYPE, NAME)                                          \
   void NAME##_push_front(NAME* list, TYPE elt)                                \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME* new_node = NULL;                                           \
                                                                               \
     if (!(new_node = malloc(sizeof (s_node_##NAME))))                         \
@@ -402,6 +432,8 @@ typedef char bool;
       list->last = new_node;                                                  \
     else                                                                      \
       new_node->next->previous = new_node;                                    \
+    DS_STATS_STOP(list, INSERT, stats_start);                                 \
+    DS_STATS_SIZE(list, list->size);                                          \
   }
 
 
@@ -416,6 +448,7 @@ typedef char bool;
 # define LIST_PUSH_BACK(TYPE, NAME)                                           \
   void NAME##_push_back(NAME* list, TYPE elt)                                 \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME* new_node = NULL;                                           \
                                                                               \
     if (!(new_node = malloc(sizeof (s_node_##NAME))))                         \
@@ -429,6 +462,8 @@ typedef char bool;
     list->last = new_node;                                                    \
                                                                               \
     list->size++;                                                             \
+    DS_STATS_STOP(list, INSERT, stats_start);                                 \
+    DS_STATS_SIZE(list, list->size);                                          \
   }
 
 
@@ -445,6 +480,7 @@ typedef char bool;
 # define LIST_POP_FRONT(TYPE, NAME)                                           \
   TYPE NAME##_pop_front(NAME* list)                                           \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME*  tmp = list->first->next;                                  \
     TYPE            elt = tmp->elt;                                           \
                                                                               \
@@ -455,6 +491,7 @@ typedef char bool;
                                                                               \
     list->first->next = tmp->next;                                            \
     free(tmp);                                                                \
+    DS_STATS_STOP(list, ERASE, stats_start);                                  \
                                                                               \
     return elt;                                                               \
   }
@@ -472,6 +509,7 @@ typedef char bool;
 # define LIST_POP_BACK(TYPE, NAME)                                            \
   TYPE NAME##_pop_back(NAME* list)                                            \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME*  tmp = list->last;                                         \
     TYPE            elt = tmp->elt;                                           \
                                                                               \
@@ -479,6 +517,7 @@ typedef char bool;
     tmp->previous->next = NULL;                                               \
     list->last = tmp->previous;                                               \
     free(tmp);                                                                \
+    DS_STATS_STOP(list, ERASE, stats_start);                                  \
                                                                               \
     return elt;                                                               \
   }
@@ -499,10 +538,12 @@ typedef char bool;
 # define LIST_INSERT(TYPE, NAME)                                              \
   void NAME##_insert(NAME* list, unsigned pos, TYPE elt)                      \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
     s_node_##NAME* new_node = NULL;                                           \
     s_node_##NAME* previous = list->first;                                    \
     s_node_##NAME* tmp = previous->next;                                      \
                                                                               \
+    DS_STATS_WALK(list, pos < list->size ? pos : 0);                          \
     if (pos >= list->size)                                                    \
       NAME##_push_back(list, elt);                                            \
     else if (!pos)                                                            \
@@ -524,6 +565,8 @@ typedef char bool;
       new_node->previous = previous;                                          \
                                                                               \
       list->size++;                                                           \
+      DS_STATS_STOP(list, INSERT, stats_start);                               \
+      DS_STATS_SIZE(list, list->size);                                        \
     }                                                                         \
   }
 
@@ -541,6 +584,7 @@ typedef char bool;
 # define LIST_FRONT(TYPE, NAME)                                               \
   TYPE NAME##_front(NAME* list)                                               \
   {                                                                           \
+    DS_STATS_COUNT(list, ACCESS);                                             \
     return list->first->next->elt;                                            \
   }
 
@@ -557,8 +601,520 @@ typedef char bool;
 # define LIST_BACK(TYPE, NAME)                                                \
   TYPE NAME##_back(NAME* list)                                                \
   {                                                                           \
+    DS_STATS_COUNT(list, ACCESS);                                             \
     return list->last->elt;                                                   \
   }
 
 
+/*
+ *
+ * POOLED LIST
+ *
+ */
+
+
+/**
+** @brief Same as LIST_HEADER, but declares a list whose nodes are taken from
+**  an arena : nodes are allocated by chunks of `chunk_size` nodes, and the
+**  nodes released by pop / clear are kept in a free-list owned by the list,
+**  so that they can be reused by the next push without calling malloc.
+**
+**  A list created with NAME_create owns a private arena, which is released
+**  by NAME_delete. A list created with NAME_create_shared uses an arena
+**  created by NAME_arena_create, that many lists can share. Its nodes are
+**  given back to the arena when the list is deleted, and the memory is only
+**  released by NAME_arena_delete.
+**
+** @param TYPE Is the type of the element that you want to store in this
+**  structure (see LIST_HEADER).
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro. The arena will be known as NAME_arena.
+*/
+# define LIST_HEADER_POOLED(TYPE, NAME)                                       \
+  typedef struct NAME NAME;                                                   \
+  typedef struct s_node_##NAME s_node_##NAME;                                 \
+  typedef struct s_chunk_##NAME s_chunk_##NAME;                               \
+  typedef struct NAME##_arena NAME##_arena;                                   \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    s_node_##NAME*  first;                                                    \
+    s_node_##NAME*  last;                                                     \
+    unsigned        size;                                                     \
+    s_node_##NAME*  free_first;                                               \
+    s_node_##NAME*  free_last;                                                \
+    NAME##_arena*   arena;                                                    \
+    bool            shared;                                                   \
+    DS_STATS_MEMBER                                                           \
+  };                                                                          \
+                                                                              \
+  struct s_node_##NAME                                                        \
+  {                                                                           \
+    TYPE            elt;                                                      \
+    s_node_##NAME*  previous;                                                 \
+    s_node_##NAME*  next;                                                     \
+  };                                                                          \
+                                                                              \
+  struct s_chunk_##NAME                                                       \
+  {                                                                           \
+    s_chunk_##NAME* next;                                                     \
+    s_node_##NAME   nodes[];                                                  \
+  };                                                                          \
+                                                                              \
+  struct NAME##_arena                                                         \
+  {                                                                           \
+    s_chunk_##NAME* chunks;                                                   \
+    s_node_##NAME*  free;                                                     \
+    unsigned        chunk_size;                                               \
+    unsigned        unused;                                                   \
+  };                                                                          \
+                                                                              \
+  typedef void (*visitor_func)(TYPE, void*);                                  \
+  typedef void (*destructor_func)(TYPE);                                      \
+                                                                              \
+  LIST_POOLED_ARENA_CREATE_HEADER(TYPE, NAME);                                \
+  LIST_POOLED_ARENA_DELETE_HEADER(TYPE, NAME);                                \
+  LIST_POOLED_CREATE_SHARED_HEADER(TYPE, NAME);                               \
+  LIST_CREATE_HEADER(TYPE, NAME);                                             \
+  LIST_SIZE_HEADER(TYPE, NAME);                                               \
+  LIST_VISIT_HEADER(TYPE, NAME);                                              \
+  LIST_PUSH_FRONT_HEADER(TYPE, NAME);                                         \
+  LIST_PUSH_BACK_HEADER(TYPE, NAME);                                          \
+  LIST_POP_BACK_HEADER(TYPE, NAME);                                           \
+  LIST_POP_FRONT_HEADER(TYPE, NAME);                                          \
+  LIST_INSERT_HEADER(TYPE, NAME);                                             \
+  LIST_FRONT_HEADER(TYPE, NAME);                                              \
+  LIST_BACK_HEADER(TYPE, NAME);                                               \
+  LIST_EMPTY_HEADER(TYPE, NAME);                                              \
+  LIST_DELETE_HEADER(TYPE, NAME);                                             \
+  LIST_CLEAR_HEADER(TYPE, NAME);                                              \
+  DS_STATS_HEADER(NAME)
+
+
+/**
+** @brief Same as LIST_SOURCE, for lists declared with LIST_HEADER_POOLED.
+**  Functions that do not allocate nor release nodes are shared with the
+**  classic list.
+*/
+# define LIST_SOURCE_POOLED(TYPE, NAME)                                       \
+  LIST_POOLED_ARENA_CREATE(TYPE, NAME)                                        \
+  LIST_POOLED_ARENA_DELETE(TYPE, NAME)                                        \
+  LIST_POOLED_NODE_ALLOC(TYPE, NAME)                                          \
+  LIST_POOLED_NODE_FREE(TYPE, NAME)                                           \
+  LIST_POOLED_CREATE_SHARED(TYPE, NAME)                                       \
+  LIST_POOLED_CREATE(TYPE, NAME)                                              \
+  LIST_SIZE(TYPE, NAME)                                                       \
+  LIST_VISIT(TYPE, NAME)                                                      \
+  LIST_POOLED_PUSH_FRONT(TYPE, NAME)                                          \
+  LIST_POOLED_PUSH_BACK(TYPE, NAME)                                           \
+  LIST_POOLED_POP_BACK(TYPE, NAME)                                            \
+  LIST_POOLED_POP_FRONT(TYPE, NAME)                                           \
+  LIST_POOLED_INSERT(TYPE, NAME)                                              \
+  LIST_FRONT(TYPE, NAME)                                                      \
+  LIST_BACK(TYPE, NAME)                                                       \
+  LIST_EMPTY(TYPE, NAME)                                                      \
+  LIST_POOLED_DELETE(TYPE, NAME)                                              \
+  LIST_POOLED_CLEAR(TYPE, NAME)                                               \
+  DS_STATS_SOURCE(TYPE, NAME, size, size)
+
+
+// Arena
+
+
+# define LIST_POOLED_ARENA_CREATE_HEADER(TYPE, NAME)                          \
+  NAME##_arena* NAME##_arena_create(unsigned chunk_size)
+
+# define LIST_POOLED_ARENA_DELETE_HEADER(TYPE, NAME)                          \
+  void NAME##_arena_delete(NAME##_arena* arena)
+
+# define LIST_POOLED_CREATE_SHARED_HEADER(TYPE, NAME)                         \
+  NAME* NAME##_create_shared(NAME##_arena* arena)
+
+
+/**
+** @brief Create a new, empty arena. No chunk is allocated until the first
+**  node is requested.
+**
+** @param TYPE type of the elements that will be stored in the list
+** @param NAME name of the list structure
+** @param chunk_size number of nodes allocated at once when the arena is
+**  empty (0 means LIST_POOL_CHUNK).
+**
+** @return a pointer on the new allocated arena. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define LIST_POOLED_ARENA_CREATE(TYPE, NAME)                                 \
+  NAME##_arena* NAME##_arena_create(unsigned chunk_size)                      \
+  {                                                                           \
+    NAME##_arena* arena = malloc(sizeof (NAME##_arena));                      \
+                                                                              \
+    if (!arena)                                                               \
+      return NULL;                                                            \
+                                                                              \
+    arena->chunks = NULL;                                                     \
+    arena->free = NULL;                                                       \
+    arena->chunk_size = chunk_size ? chunk_size : LIST_POOL_CHUNK;            \
+    arena->unused = 0;                                                        \
+                                                                              \
+    return arena;                                                             \
+  }
+
+
+/**
+** @brief Release every chunk of the arena, and the arena it-self. Every
+**  list using the arena must have been deleted before.
+**
+** @param TYPE type of the elements that will be stored in the list
+** @param NAME name of the list structure
+** @param arena the arena to delete
+*/
+# define LIST_POOLED_ARENA_DELETE(TYPE, NAME)                                 \
+  void NAME##_arena_delete(NAME##_arena* arena)                               \
+  {                                                                           \
+    s_chunk_##NAME* tmp = arena->chunks;                                      \
+    s_chunk_##NAME* next = NULL;                                              \
+                                                                              \
+    while (tmp)                                                               \
+    {                                                                         \
+      next = tmp->next;                                                       \
+      free(tmp);                                                              \
+      tmp = next;                                                             \
+    }                                                                         \
+                                                                              \
+    free(arena);                                                              \
+  }
+
+
+/**
+** @brief Return a node to use in the list. It is taken, in this order, from
+**  the free-list of the list, from the free-list of the arena, and from the
+**  current chunk of the arena. A new chunk is allocated only if the three
+**  are empty.
+**
+** @return the node, or NULL if the allocation of a new chunk failed.
+*/
+# define LIST_POOLED_NODE_ALLOC(TYPE, NAME)                                   \
+  static s_node_##NAME* NAME##_node_alloc(NAME* list)                         \
+  {                                                                           \
+    NAME##_arena*   arena = list->arena;                                      \
+    s_node_##NAME*  node = list->free_first;                                  \
+    s_chunk_##NAME* chunk = NULL;                                             \
+                                                                              \
+    if (node)                                                                 \
+    {                                                                         \
+      list->free_first = node->next;                                          \
+      return node;                                                            \
+    }                                                                         \
+                                                                              \
+    if ((node = arena->free))                                                 \
+    {                                                                         \
+      arena->free = node->next;                                               \
+      return node;                                                            \
+    }                                                                         \
+                                                                              \
+    if (!arena->unused)                                                       \
+    {                                                                         \
+      chunk = malloc(sizeof (s_chunk_##NAME)                                  \
+                     + arena->chunk_size * sizeof (s_node_##NAME));           \
+      if (!chunk)                                                             \
+        return NULL;                                                          \
+                                                                              \
+      chunk->next = arena->chunks;                                            \
+      arena->chunks = chunk;                                                  \
+      arena->unused = arena->chunk_size;                                      \
+    }                                                                         \
+                                                                              \
+    return &arena->chunks->nodes[arena->chunk_size - arena->unused--];        \
+  }
+
+
+/**
+** @brief Give back the nodes from first to last (linked by their next
+**  field) to the free-list of the list. This is done in O(1).
+*/
+# define LIST_POOLED_NODE_FREE(TYPE, NAME)                                    \
+  static void NAME##_node_free(NAME* list, s_node_##NAME* first,              \
+                               s_node_##NAME* last)                           \
+  {                                                                           \
+    last->next = list->free_first;                                            \
+    if (!list->free_first)                                                    \
+      list->free_last = last;                                                 \
+    list->free_first = first;                                                 \
+  }
+
+
+/**
+** @brief Create a new list whose nodes will be taken from the given arena.
+**  The sentry is taken from the arena too.
+**
+** @param TYPE type of the elements that will be stored in the list
+** @param NAME name of the list structure
+** @param arena the arena shared by the lists
+**
+** @return a pointer on the new allocated list. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define LIST_POOLED_CREATE_SHARED(TYPE, NAME)                                \
+  NAME* NAME##_create_shared(NAME##_arena* arena)                             \
+  {                                                                           \
+    NAME* new_list = NULL;                                                    \
+    s_node_##NAME* sentry = NULL;                                             \
+                                                                              \
+    if (!(new_list = malloc(sizeof (NAME))))                                  \
+      return NULL;                                                            \
+                                                                              \
+    new_list->free_first = NULL;                                              \
+    new_list->free_last = NULL;                                               \
+    new_list->arena = arena;                                                  \
+    new_list->shared = TRUE;                                                  \
+                                                                              \
+    if (!(sentry = NAME##_node_alloc(new_list)))                              \
+    {                                                                         \
+      free(new_list);                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    sentry->previous = NULL;                                                  \
+    sentry->next = NULL;                                                      \
+                                                                              \
+    new_list->first = sentry;                                                 \
+    new_list->last = sentry;                                                  \
+    new_list->size = 0;                                                       \
+    DS_STATS_INIT(new_list);                                                  \
+                                                                              \
+    return new_list;                                                          \
+  }
+
+
+/**
+** @brief Create a new list with its own arena of LIST_POOL_CHUNK nodes per
+**  chunk. The arena will be released along with the list.
+**
+** @param TYPE type of the elements that will be stored in the list
+** @param NAME name of the list structure
+**
+** @return a pointer on the new allocated list. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define LIST_POOLED_CREATE(TYPE, NAME)                                       \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    NAME##_arena* arena = NULL;                                               \
+    NAME* new_list = NULL;                                                    \
+                                                                              \
+    if (!(arena = NAME##_arena_create(LIST_POOL_CHUNK)))                      \
+      return NULL;                                                            \
+                                                                              \
+    if (!(new_list = NAME##_create_shared(arena)))                            \
+    {                                                                         \
+      NAME##_arena_delete(arena);                                             \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    new_list->shared = FALSE;                                                 \
+                                                                              \
+    return new_list;                                                          \
+  }
+
+
+/**
+** @brief Clear the list, then give every node of the list (sentry included)
+**  back to the arena. If the arena is owned by the list, it is released,
+**  otherwise the nodes are kept in the arena for the other lists.
+**
+** @param TYPE type of the elements that will be stored in the list
+** @param NAME name of the list structure
+** @param list the list to delete
+** @param dest a function pointer that will be called on each element of the
+**  list so as to delete them if needed (this pointer could be NULL).
+*/
+# define LIST_POOLED_DELETE(TYPE, NAME)                                       \
+  void NAME##_delete(NAME* list, destructor_func dest)                        \
+  {                                                                           \
+    NAME##_clear(list, dest);                                                 \
+    NAME##_node_free(list, list->first, list->first);                         \
+                                                                              \
+    if (list->shared)                                                         \
+    {                                                                         \
+      list->free_last->next = list->arena->free;                              \
+      list->arena->free = list->free_first;                                   \
+    }                                                                         \
+    else                                                                      \
+      NAME##_arena_delete(list->arena);                                       \
+                                                                              \
+    free(list);                                                               \
+  }
+
+
+/**
+** @brief Call the destructor (if any) on each element, then give all the
+**  nodes back to the free-list of the list. When no destructor is given,
+**  the nodes are not visited at all : the whole chain is moved to the
+**  free-list in O(1).
+**
+** @param TYPE type of the elements that will be stored in the list
+** @param NAME name of the list structure
+** @param list the list to clear
+** @param dest a function pointer that will be called on each element of the
+**  list so as to delete them if needed (this pointer could be NULL).
+*/
+# define LIST_POOLED_CLEAR(TYPE, NAME)                                        \
+  void NAME##_clear(NAME* list, destructor_func dest)                         \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    s_node_##NAME* tmp = list->first->next;                                   \
+                                                                              \
+    if (!list->size)                                                          \
+    {                                                                         \
+      DS_STATS_STOP(list, CLEAR, stats_start);                                \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    if (dest)                                                                 \
+      for (; tmp; tmp = tmp->next)                                            \
+        dest(tmp->elt);                                                       \
+                                                                              \
+    NAME##_node_free(list, list->first->next, list->last);                    \
+                                                                              \
+    list->last = list->first;                                                 \
+    list->size = 0;                                                           \
+    list->first->next = NULL;                                                 \
+    DS_STATS_STOP(list, CLEAR, stats_start);                                  \
+  }
+
+
+/**
+** @brief Same as LIST_PUSH_FRONT, the node is taken from the arena.
+*/
+# define LIST_POOLED_PUSH_FRONT(TYPE, NAME)                                   \
+  void NAME##_push_front(NAME* list, TYPE elt)                                \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    s_node_##NAME* new_node = NULL;                                           \
+                                                                              \
+    if (!(new_node = NAME##_node_alloc(list)))                                \
+      return;                                                                 \
+                                                                              \
+    new_node->elt = elt;                                                      \
+    new_node->previous = list->first;                                         \
+    new_node->next = list->first->next;                                       \
+    list->first->next = new_node;                                             \
+                                                                              \
+    if (!(list->size++))                                                      \
+      list->last = new_node;                                                  \
+    else                                                                      \
+      new_node->next->previous = new_node;                                    \
+    DS_STATS_STOP(list, INSERT, stats_start);                                 \
+    DS_STATS_SIZE(list, list->size);                                          \
+  }
+
+
+/**
+** @brief Same as LIST_PUSH_BACK, the node is taken from the arena.
+*/
+# define LIST_POOLED_PUSH_BACK(TYPE, NAME)                                    \
+  void NAME##_push_back(NAME* list, TYPE elt)                                 \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    s_node_##NAME* new_node = NULL;                                           \
+                                                                              \
+    if (!(new_node = NAME##_node_alloc(list)))                                \
+      return;                                                                 \
+                                                                              \
+    new_node->elt = elt;                                                      \
+                                                                              \
+    new_node->previous = list->last;                                          \
+    new_node->next = NULL;                                                    \
+    new_node->previous->next = new_node;                                      \
+    list->last = new_node;                                                    \
+                                                                              \
+    list->size++;                                                             \
+    DS_STATS_STOP(list, INSERT, stats_start);                                 \
+    DS_STATS_SIZE(list, list->size);                                          \
+  }
+
+
+/**
+** @brief Same as LIST_POP_FRONT, the node is kept in the free-list.
+*/
+# define LIST_POOLED_POP_FRONT(TYPE, NAME)                                    \
+  TYPE NAME##_pop_front(NAME* list)                                           \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    s_node_##NAME*  tmp = list->first->next;                                  \
+    TYPE            elt = tmp->elt;                                           \
+                                                                              \
+    if (!(--list->size))                                                      \
+      list->last = list->first;                                               \
+    else                                                                      \
+      tmp->next->previous = list->first;                                      \
+                                                                              \
+    list->first->next = tmp->next;                                            \
+    NAME##_node_free(list, tmp, tmp);                                         \
+    DS_STATS_STOP(list, ERASE, stats_start);                                  \
+                                                                              \
+    return elt;                                                               \
+  }
+
+
+/**
+** @brief Same as LIST_POP_BACK, the node is kept in the free-list.
+*/
+# define LIST_POOLED_POP_BACK(TYPE, NAME)                                     \
+  TYPE NAME##_pop_back(NAME* list)                                            \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    s_node_##NAME*  tmp = list->last;                                         \
+    TYPE            elt = tmp->elt;                                           \
+                                                                              \
+    list->size--;                                                             \
+    tmp->previous->next = NULL;                                               \
+    list->last = tmp->previous;                                               \
+    NAME##_node_free(list, tmp, tmp);                                         \
+    DS_STATS_STOP(list, ERASE, stats_start);                                  \
+                                                                              \
+    return elt;                                                               \
+  }
+
+
+/**
+** @brief Same as LIST_INSERT, the node is taken from the arena.
+*/
+# define LIST_POOLED_INSERT(TYPE, NAME)                                       \
+  void NAME##_insert(NAME* list, unsigned pos, TYPE elt)                      \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    s_node_##NAME* new_node = NULL;                                           \
+    s_node_##NAME* previous = list->first;                                    \
+    s_node_##NAME* tmp = previous->next;                                      \
+                                                                              \
+    DS_STATS_WALK(list, pos < list->size ? pos : 0);                          \
+    if (pos >= list->size)                                                    \
+      NAME##_push_back(list, elt);                                            \
+    else if (!pos)                                                            \
+      NAME##_push_front(list, elt);                                           \
+    else                                                                      \
+    {                                                                         \
+      if (!(new_node = NAME##_node_alloc(list)))                              \
+        return;                                                               \
+      new_node->elt = elt;                                                    \
+                                                                              \
+      while (pos--)                                                           \
+      {                                                                       \
+        previous = tmp;                                                       \
+        tmp = tmp->next;                                                      \
+      }                                                                       \
+                                                                              \
+      tmp->previous = new_node;                                               \
+      new_node->next = tmp;                                                   \
+      previous->next = new_node;                                              \
+      new_node->previous = previous;                                          \
+                                                                              \
+      list->size++;                                                           \
+      DS_STATS_STOP(list, INSERT, stats_start);                               \
+      DS_STATS_SIZE(list, list->size);                                        \
+    }                                                                         \
+  }
+
+
 #endif /* !LIST_HXX_ */
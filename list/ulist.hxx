@@ -0,0 +1,620 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of unrolled double linked-lists using X-macros        **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/** @file ulist.hxx
+**
+**  @author Remi BERSON
+**
+**  @brief This file contains macros that define a C implementation of
+**  unrolled double-linked lists : each node stores a small array of
+**  elements (ULIST_BYTES bytes, a cache line by default) instead of a
+**  single one. Walking the list touches one node per ULIST_BYTES bytes of
+**  elements, and the two pointers of a node are shared by all its
+**  elements. Nodes are split when an insertion hits a full node, and
+**  merged with their successor when an erase leaves them less than half
+**  full.
+**
+**  The API is the one of list.hxx, plus NAME_erase. Assuming that you used
+**  NAME as the name of the structure and TYPE as the type of the elements,
+**  the names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_delete
+**    ~ NAME_clear
+**
+**    ~ NAME_visit
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**
+**    ~ NAME_front
+**    ~ NAME_back
+**
+**    ~ NAME_push_front
+**    ~ NAME_push_back
+**    ~ NAME_pop_back
+**    ~ NAME_pop_front
+**    ~ NAME_insert
+**    ~ NAME_erase
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef ULIST_HXX_
+# define ULIST_HXX_
+
+# include <stdlib.h>
+# include <string.h>
+
+/**
+**  @brief Size in bytes of the array of elements of a node. Define it
+**  before including ulist.hxx to change it.
+*/
+# ifndef ULIST_BYTES
+#  define ULIST_BYTES 64
+# endif
+
+/**
+**  @brief Number of elements of type TYPE stored in a node (never less
+**  than 4, so that splitting a node is meaningful for big elements).
+*/
+# define ULIST_CAPACITY(TYPE)                                                 \
+  (ULIST_BYTES / sizeof (TYPE) < 4 ? 4 : ULIST_BYTES / sizeof (TYPE))
+
+/**
+**  @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+/**
+**  @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+**  @brief Defines a "boolean" type with a char.
+*/
+typedef char bool;
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  unrolled list data structure. As mentionned in the README, you should
+**  create a header file for your "specialized" structure, include
+**  ulist.hxx and call this macro.
+**
+** @param TYPE Is the type of the element that you want to store in this
+**  structure. (e.g : ULIST_HEADER(int, ...))
+**
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro.
+*/
+# define ULIST_HEADER(TYPE, NAME)                                             \
+                                                                              \
+  typedef struct NAME NAME;                                                   \
+  typedef struct s_node_##NAME s_node_##NAME;                                 \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    s_node_##NAME*  first;                                                    \
+    s_node_##NAME*  last;                                                     \
+    unsigned        size;                                                     \
+  };                                                                          \
+                                                                              \
+  struct s_node_##NAME                                                        \
+  {                                                                           \
+    s_node_##NAME*  previous;                                                 \
+    s_node_##NAME*  next;                                                     \
+    unsigned        count;                                                    \
+    TYPE            elts[ULIST_CAPACITY(TYPE)];                               \
+  };                                                                          \
+                                                                              \
+  typedef void (*visitor_func)(TYPE, void*);                                  \
+  typedef void (*destructor_func)(TYPE);                                      \
+                                                                              \
+  ULIST_CREATE_HEADER(TYPE, NAME);                                            \
+  ULIST_SIZE_HEADER(TYPE, NAME);                                              \
+  ULIST_VISIT_HEADER(TYPE, NAME);                                             \
+  ULIST_PUSH_FRONT_HEADER(TYPE, NAME);                                        \
+  ULIST_PUSH_BACK_HEADER(TYPE, NAME);                                         \
+  ULIST_POP_BACK_HEADER(TYPE, NAME);                                          \
+  ULIST_POP_FRONT_HEADER(TYPE, NAME);                                         \
+  ULIST_INSERT_HEADER(TYPE, NAME);                                            \
+  ULIST_ERASE_HEADER(TYPE, NAME);                                             \
+  ULIST_FRONT_HEADER(TYPE, NAME);                                             \
+  ULIST_BACK_HEADER(TYPE, NAME);                                              \
+  ULIST_EMPTY_HEADER(TYPE, NAME);                                             \
+  ULIST_DELETE_HEADER(TYPE, NAME);                                            \
+  ULIST_CLEAR_HEADER(TYPE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on unrolled lists. Call it with the
+**  *same arguments* as ULIST_HEADER.
+*/
+# define ULIST_SOURCE(TYPE, NAME)                                             \
+  ULIST_NODE_LINK(TYPE, NAME)                                                 \
+  ULIST_NODE_UNLINK(TYPE, NAME)                                               \
+  ULIST_NODE_FIND(TYPE, NAME)                                                 \
+  ULIST_CREATE(TYPE, NAME)                                                    \
+  ULIST_SIZE(TYPE, NAME)                                                      \
+  ULIST_VISIT(TYPE, NAME)                                                     \
+  ULIST_PUSH_FRONT(TYPE, NAME)                                                \
+  ULIST_PUSH_BACK(TYPE, NAME)                                                 \
+  ULIST_POP_BACK(TYPE, NAME)                                                  \
+  ULIST_POP_FRONT(TYPE, NAME)                                                 \
+  ULIST_INSERT(TYPE, NAME)                                                    \
+  ULIST_ERASE(TYPE, NAME)                                                     \
+  ULIST_FRONT(TYPE, NAME)                                                     \
+  ULIST_BACK(TYPE, NAME)                                                      \
+  ULIST_EMPTY(TYPE, NAME)                                                     \
+  ULIST_DELETE(TYPE, NAME)                                                    \
+  ULIST_CLEAR(TYPE, NAME)
+
+
+
+
+/*
+ * HEADER DEFINITION
+ *
+ */
+
+
+// Construction / Destruction
+
+
+# define ULIST_CREATE_HEADER(TYPE, NAME)                                      \
+  NAME* NAME##_create()
+
+# define ULIST_DELETE_HEADER(TYPE, NAME)                                      \
+  void NAME##_delete(NAME* list, destructor_func d)
+
+# define ULIST_CLEAR_HEADER(TYPE, NAME)                                       \
+  void NAME##_clear(NAME* list, destructor_func d)
+
+
+// Visiting
+
+
+# define ULIST_VISIT_HEADER(TYPE, NAME)                                       \
+  void NAME##_visit(NAME* list, visitor_func v, void* data)
+
+
+// Capacity
+
+
+# define ULIST_SIZE_HEADER(TYPE, NAME)                                        \
+  unsigned NAME##_size(NAME* list)
+
+# define ULIST_EMPTY_HEADER(TYPE, NAME)                                       \
+  bool NAME##_empty(NAME* list)
+
+
+// Element access
+
+
+# define ULIST_FRONT_HEADER(TYPE, NAME)                                       \
+  TYPE NAME##_front(NAME* list)
+
+# define ULIST_BACK_HEADER(TYPE, NAME)                                        \
+  TYPE NAME##_back(NAME* list)
+
+
+// Modifiers
+
+
+# define ULIST_PUSH_FRONT_HEADER(TYPE, NAME)                                  \
+  void NAME##_push_front(NAME* list, TYPE elt)
+
+# define ULIST_PUSH_BACK_HEADER(TYPE, NAME)                                   \
+  void NAME##_push_back(NAME* list, TYPE elt)
+
+# define ULIST_POP_BACK_HEADER(TYPE, NAME)                                    \
+  TYPE NAME##_pop_back(NAME* list)
+
+# define ULIST_POP_FRONT_HEADER(TYPE, NAME)                                   \
+  TYPE NAME##_pop_front(NAME* list)
+
+# define ULIST_INSERT_HEADER(TYPE, NAME)                                      \
+  void NAME##_insert(NAME* list, unsigned pos, TYPE elt)
+
+# define ULIST_ERASE_HEADER(TYPE, NAME)                                       \
+  void NAME##_erase(NAME* list, unsigned pos, destructor_func d)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Allocate a new, empty node and link it right after previous (or
+**  at the beginning of the list if previous is NULL).
+**
+** @return the new node, or NULL if the allocation failed.
+*/
+# define ULIST_NODE_LINK(TYPE, NAME)                                          \
+  static s_node_##NAME* NAME##_node_link(NAME* list,                          \
+                                         s_node_##NAME* previous)             \
+  {                                                                           \
+    s_node_##NAME* node = malloc(sizeof (s_node_##NAME));                     \
+                                                                              \
+    if (!node)                                                                \
+      return NULL;                                                            \
+                                                                              \
+    node->count = 0;                                                          \
+    node->previous = previous;                                                \
+    node->next = previous ? previous->next : list->first;                     \
+                                                                              \
+    if (node->next)                                                           \
+      node->next->previous = node;                                            \
+    else                                                                      \
+      list->last = node;                                                      \
+                                                                              \
+    if (previous)                                                             \
+      previous->next = node;                                                  \
+    else                                                                      \
+      list->first = node;                                                     \
+                                                                              \
+    return node;                                                              \
+  }
+
+
+/**
+** @brief Unlink the given node from the list and free it.
+*/
+# define ULIST_NODE_UNLINK(TYPE, NAME)                                        \
+  static void NAME##_node_unlink(NAME* list, s_node_##NAME* node)             \
+  {                                                                           \
+    if (node->previous)                                                       \
+      node->previous->next = node->next;                                      \
+    else                                                                      \
+      list->first = node->next;                                               \
+                                                                              \
+    if (node->next)                                                           \
+      node->next->previous = node->previous;                                  \
+    else                                                                      \
+      list->last = node->previous;                                            \
+                                                                              \
+    free(node);                                                               \
+  }
+
+
+/**
+** @brief Find the node holding the element at position pos (pos < size),
+**  hopping over whole nodes. On return, pos is the position of the element
+**  inside the node.
+*/
+# define ULIST_NODE_FIND(TYPE, NAME)                                          \
+  static s_node_##NAME* NAME##_node_find(NAME* list, unsigned* pos)           \
+  {                                                                           \
+    s_node_##NAME* node = list->first;                                        \
+                                                                              \
+    while (*pos >= node->count)                                               \
+    {                                                                         \
+      *pos -= node->count;                                                    \
+      node = node->next;                                                      \
+    }                                                                         \
+                                                                              \
+    return node;                                                              \
+  }
+
+
+/**
+** @brief Create a new, empty list. No node is allocated until the first
+**  element is added.
+**
+** @return a pointer on the new allocated list. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define ULIST_CREATE(TYPE, NAME)                                             \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    NAME* new_list = malloc(sizeof (NAME));                                   \
+                                                                              \
+    if (!new_list)                                                            \
+      return NULL;                                                            \
+                                                                              \
+    new_list->first = NULL;                                                   \
+    new_list->last = NULL;                                                    \
+    new_list->size = 0;                                                       \
+                                                                              \
+    return new_list;                                                          \
+  }
+
+
+/**
+** @brief Clear the list, then free the list structure.
+**
+** @param list the list to delete
+** @param dest a function pointer that will be called on each element of the
+**  list so as to delete them if needed (this pointer could be NULL).
+*/
+# define ULIST_DELETE(TYPE, NAME)                                             \
+  void NAME##_delete(NAME* list, destructor_func dest)                        \
+  {                                                                           \
+    NAME##_clear(list, dest);                                                 \
+    free(list);                                                               \
+  }
+
+
+/**
+** @brief Walk through the nodes, call the destructor (if any) on each
+**  element, and free the nodes.
+**
+** @param list the list to clear
+** @param dest a function pointer that will be called on each element of the
+**  list so as to delete them if needed (this pointer could be NULL).
+*/
+# define ULIST_CLEAR(TYPE, NAME)                                              \
+  void NAME##_clear(NAME* list, destructor_func dest)                         \
+  {                                                                           \
+    s_node_##NAME* tmp = list->first;                                         \
+    s_node_##NAME* next = NULL;                                               \
+                                                                              \
+    while (tmp)                                                               \
+    {                                                                         \
+      if (dest)                                                               \
+        for (unsigned i = 0; i < tmp->count; i++)                             \
+          dest(tmp->elts[i]);                                                 \
+      next = tmp->next;                                                       \
+      free(tmp);                                                              \
+      tmp = next;                                                             \
+    }                                                                         \
+                                                                              \
+    list->first = NULL;                                                       \
+    list->last = NULL;                                                        \
+    list->size = 0;                                                           \
+  }
+
+
+/**
+** @brief return the number of elements in the list.
+*/
+# define ULIST_SIZE(TYPE, NAME)                                               \
+  unsigned NAME##_size(NAME* list)                                            \
+  {                                                                           \
+    return list->size;                                                        \
+  }
+
+
+/**
+** @brief Visit the list and call the visitor function on each element. The
+**  elements of a node are walked by a flat loop.
+**
+** @param list the list to visit
+** @param v function pointer to be called on each element of the list
+** @param data is a pointer that will be passed to the visitor at each call.
+*/
+# define ULIST_VISIT(TYPE, NAME)                                              \
+  void NAME##_visit(NAME* list, visitor_func v, void* data)                   \
+  {                                                                           \
+    for (s_node_##NAME* tmp = list->first; tmp; tmp = tmp->next)              \
+      for (unsigned i = 0; i < tmp->count; i++)                               \
+        v(tmp->elts[i], data);                                                \
+  }
+
+
+/**
+** @brief Check if the given list is empty or not.
+**
+** @return TRUE (1), if the list is empty (or NULL), FALSE (0) otherwise
+*/
+# define ULIST_EMPTY(TYPE, NAME)                                              \
+  bool NAME##_empty(NAME* list)                                               \
+  {                                                                           \
+    return !(list && list->size);                                             \
+  }
+
+
+/**
+** @brief Add an element at the beginning of the list. The elements of the
+**  first node are shifted, unless it is full : a new node is then added.
+*/
+# define ULIST_PUSH_FRONT(TYPE, NAME)                                         \
+  void NAME##_push_front(NAME* list, TYPE elt)                                \
+  {                                                                           \
+    s_node_##NAME* node = list->first;                                        \
+                                                                              \
+    if (!node || node->count == ULIST_CAPACITY(TYPE))                         \
+      if (!(node = NAME##_node_link(list, NULL)))                             \
+        return;                                                               \
+                                                                              \
+    memmove(node->elts + 1, node->elts, node->count * sizeof (TYPE));         \
+    node->elts[0] = elt;                                                      \
+    node->count++;                                                            \
+    list->size++;                                                             \
+  }
+
+
+/**
+** @brief Add an element at the end of the list, in a new node if the last
+**  one is full.
+*/
+# define ULIST_PUSH_BACK(TYPE, NAME)                                          \
+  void NAME##_push_back(NAME* list, TYPE elt)                                 \
+  {                                                                           \
+    s_node_##NAME* node = list->last;                                         \
+                                                                              \
+    if (!node || node->count == ULIST_CAPACITY(TYPE))                         \
+      if (!(node = NAME##_node_link(list, node)))                             \
+        return;                                                               \
+                                                                              \
+    node->elts[node->count++] = elt;                                          \
+    list->size++;                                                             \
+  }
+
+
+/**
+** @brief Remove and return the first element of the list. The first node is
+**  freed when it becomes empty.
+*/
+# define ULIST_POP_FRONT(TYPE, NAME)                                          \
+  TYPE NAME##_pop_front(NAME* list)                                           \
+  {                                                                           \
+    s_node_##NAME*  node = list->first;                                       \
+    TYPE            elt = node->elts[0];                                      \
+                                                                              \
+    list->size--;                                                             \
+    if (!--node->count)                                                       \
+      NAME##_node_unlink(list, node);                                         \
+    else                                                                      \
+      memmove(node->elts, node->elts + 1, node->count * sizeof (TYPE));       \
+                                                                              \
+    return elt;                                                               \
+  }
+
+
+/**
+** @brief Remove and return the last element of the list. The last node is
+**  freed when it becomes empty.
+*/
+# define ULIST_POP_BACK(TYPE, NAME)                                           \
+  TYPE NAME##_pop_back(NAME* list)                                            \
+  {                                                                           \
+    s_node_##NAME*  node = list->last;                                        \
+    TYPE            elt = node->elts[--node->count];                          \
+                                                                              \
+    list->size--;                                                             \
+    if (!node->count)                                                         \
+      NAME##_node_unlink(list, node);                                         \
+                                                                              \
+    return elt;                                                               \
+  }
+
+
+/**
+** @brief Insert an element at a given position in the list. There are 2
+** particular cases :
+**   1) pos == 0, in that case we do a push_front
+**   2) pos >= size(list), in that case we do a push_back
+** Otherwise, if the node holding position pos is full, its upper half is
+** moved to a new node linked right after it, before inserting.
+**
+** @param list the list
+** @param pos position to insert the new element
+** @param elt new element to insert
+*/
+# define ULIST_INSERT(TYPE, NAME)                                             \
+  void NAME##_insert(NAME* list, unsigned pos, TYPE elt)                      \
+  {                                                                           \
+    s_node_##NAME* node = NULL;                                               \
+    s_node_##NAME* half = NULL;                                               \
+                                                                              \
+    if (pos >= list->size)                                                    \
+      NAME##_push_back(list, elt);                                            \
+    else if (!pos)                                                            \
+      NAME##_push_front(list, elt);                                           \
+    else                                                                      \
+    {                                                                         \
+      node = NAME##_node_find(list, &pos);                                    \
+                                                                              \
+      if (node->count == ULIST_CAPACITY(TYPE))                                \
+      {                                                                       \
+        if (!(half = NAME##_node_link(list, node)))                           \
+          return;                                                             \
+                                                                              \
+        half->count = node->count / 2;                                        \
+        node->count -= half->count;                                           \
+        memcpy(half->elts, node->elts + node->count,                          \
+               half->count * sizeof (TYPE));                                  \
+                                                                              \
+        if (pos > node->count)                                                \
+        {                                                                     \
+          pos -= node->count;                                                 \
+          node = half;                                                        \
+        }                                                                     \
+      }                                                                       \
+                                                                              \
+      memmove(node->elts + pos + 1, node->elts + pos,                         \
+              (node->count - pos) * sizeof (TYPE));                           \
+      node->elts[pos] = elt;                                                  \
+      node->count++;                                                          \
+      list->size++;                                                           \
+    }                                                                         \
+  }
+
+
+/**
+** @brief Remove the element at a given position in the list (nothing is
+**  done if pos >= size). If the node becomes less than half full and the
+**  elements of its successor fit in it, both nodes are merged.
+**
+** @param list the list
+** @param pos position of the element to remove
+** @param dest a function pointer that will be called on the element so as
+**  to delete it if needed (this pointer could be NULL).
+*/
+# define ULIST_ERASE(TYPE, NAME)                                              \
+  void NAME##_erase(NAME* list, unsigned pos, destructor_func dest)           \
+  {                                                                           \
+    s_node_##NAME* node = NULL;                                               \
+    s_node_##NAME* next = NULL;                                               \
+                                                                              \
+    if (pos >= list->size)                                                    \
+      return;                                                                 \
+                                                                              \
+    node = NAME##_node_find(list, &pos);                                      \
+    if (dest)                                                                 \
+      dest(node->elts[pos]);                                                  \
+                                                                              \
+    memmove(node->elts + pos, node->elts + pos + 1,                           \
+            (--node->count - pos) * sizeof (TYPE));                           \
+    list->size--;                                                             \
+                                                                              \
+    if (!node->count)                                                         \
+      NAME##_node_unlink(list, node);                                         \
+    else if (node->count < ULIST_CAPACITY(TYPE) / 2 && (next = node->next)    \
+             && node->count + next->count <= ULIST_CAPACITY(TYPE))            \
+    {                                                                         \
+      memcpy(node->elts + node->count, next->elts,                            \
+             next->count * sizeof (TYPE));                                    \
+      node->count += next->count;                                             \
+      NAME##_node_unlink(list, next);                                         \
+    }                                                                         \
+  }
+
+
+/**
+** @brief return but don't remove the first element of the list.
+*/
+# define ULIST_FRONT(TYPE, NAME)                                              \
+  TYPE NAME##_front(NAME* list)                                               \
+  {                                                                           \
+    return list->first->elts[0];                                              \
+  }
+
+
+/**
+** @brief return but don't remove the last element of the list.
+*/
+# define ULIST_BACK(TYPE, NAME)                                               \
+  TYPE NAME##_back(NAME* list)                                                \
+  {                                                                           \
+    return list->last->elts[list->last->count - 1];                           \
+  }
+
+
+#endif /* !ULIST_HXX_ */
@@ -0,0 +1,222 @@
+/******************************************************************************
+**                                                                           **
+**    Fork-join thread pool shared by the containers                         **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file pool.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains a small fork-join thread pool, used by the
+**  parallel functions of the vectors. The threads of a pool are created
+**  once, and sleep between jobs : ds_pool_run hands the same job to all of
+**  them, runs its own share on the calling thread and returns when every
+**  share is done. A job is a function called once on each thread, with the
+**  index of the thread (the caller is 0) and their number, from which it
+**  computes its share of the work.
+**
+**  A NULL pool is a valid one, of one thread : the job is then called on
+**  the calling thread only. A pool runs one job at a time, ds_pool_run must
+**  not be called concurrently on the same pool.
+**
+**  The pool uses POSIX threads : with -std=c11, define _POSIX_C_SOURCE to
+**  200809L and link with -pthread.
+*/
+
+
+#ifndef POOL_HXX_
+# define POOL_HXX_
+
+# include <pthread.h>
+# include <stdlib.h>
+# include <unistd.h>
+
+/**
+** @brief A job, called on thread index of threads.
+*/
+typedef void (*ds_job_func)(void* arg, unsigned index, unsigned threads);
+
+struct ds_pool;
+
+/**
+** @brief A thread of the pool, and its index.
+*/
+struct ds_pool_thread
+{
+  struct ds_pool*       pool;
+  pthread_t             thread;
+  unsigned              index;
+};
+
+/**
+** @brief The pool. The workers wait on start until generation changes,
+**  and the last one to finish its share of the job signals done.
+*/
+struct ds_pool
+{
+  pthread_mutex_t       lock;
+  pthread_cond_t        start;
+  pthread_cond_t        done;
+  ds_job_func           job;
+  void*                 arg;
+  unsigned long         generation;
+  unsigned              pending;
+  unsigned              threads;
+  int                   stop;
+  struct ds_pool_thread workers[];
+};
+
+
+static inline void* ds_pool_worker(void* arg)
+{
+  struct ds_pool_thread* self = arg;
+  struct ds_pool* pool = self->pool;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  for (;;)
+  {
+    while (pool->generation == seen && !pool->stop)
+      pthread_cond_wait(&pool->start, &pool->lock);
+    if (pool->stop)
+      break;
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    pool->job(pool->arg, self->index, pool->threads);
+
+    pthread_mutex_lock(&pool->lock);
+    if (!--pool->pending)
+      pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+
+/**
+** @brief Create a pool of threads threads, counting the calling one (the
+**  number of online processors if threads is 0). If some threads could not
+**  be created, the pool runs with the ones that could.
+**
+** @return a pointer on the new pool, or NULL if the allocation failed.
+*/
+static inline struct ds_pool* ds_pool_create(unsigned threads)
+{
+  struct ds_pool* pool = NULL;
+  unsigned started = 1;
+
+  if (!threads)
+  {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? online : 1;
+  }
+
+  if (!(pool = malloc(sizeof (struct ds_pool)
+                      + threads * sizeof (struct ds_pool_thread))))
+    return NULL;
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->job = NULL;
+  pool->arg = NULL;
+  pool->generation = 0;
+  pool->pending = 0;
+  pool->stop = 0;
+
+  for (; started < threads; started++)
+  {
+    pool->workers[started].pool = pool;
+    pool->workers[started].index = started;
+    if (pthread_create(&pool->workers[started].thread, NULL, ds_pool_worker,
+                       &pool->workers[started]))
+      break;
+  }
+  pool->threads = started;
+
+  return pool;
+}
+
+
+/**
+** @brief Number of threads of the pool, counting the calling one.
+*/
+static inline unsigned ds_pool_threads(struct ds_pool* pool)
+{
+  return pool ? pool->threads : 1;
+}
+
+
+/**
+** @brief Call job(arg, i, threads) on each thread i of the pool, and wait
+**  for all of them. Thread 0 is the calling thread.
+*/
+static inline void ds_pool_run(struct ds_pool* pool, ds_job_func job,
+                               void* arg)
+{
+  if (!pool || pool->threads == 1)
+  {
+    job(arg, 0, 1);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->job = job;
+  pool->arg = arg;
+  pool->pending = pool->threads - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  job(arg, 0, pool->threads);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->pending)
+    pthread_cond_wait(&pool->done, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+
+/**
+** @brief Stop the threads of the pool and free it.
+*/
+static inline void ds_pool_delete(struct ds_pool* pool)
+{
+  if (!pool)
+    return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (unsigned i = 1; i < pool->threads; i++)
+    pthread_join(pool->workers[i].thread, NULL);
+
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+}
+
+#endif /* !POOL_HXX_ */
@@ -0,0 +1,215 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the priority queue data structure                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "pq.h"
+
+/// @brief Out-degree of the vertices of the graphs.
+#define DEGREE 8
+
+
+/// @brief splitmix64, to pick pseudo-random deadlines, edges and weights.
+static uint64_t
+mix(uint64_t i)
+{
+  uint64_t z = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+/// @brief Timer workload (the "hold" model) : n timers are pending, the
+//  earliest one expires and is armed again with a random delay, ops times.
+//
+/// @return the time taken by the ops expirations, in ns.
+#define HOLD(NAME)                                                            \
+  static double                                                               \
+  NAME##_hold(unsigned n, unsigned ops, uint64_t* sum)                        \
+  {                                                                           \
+    NAME* q = NAME##_ncreate(n);                                              \
+    uint64_t deadline = 0;                                                    \
+    double t = 0;                                                             \
+                                                                              \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push(q, mix(i) % (16ull * n));                                   \
+                                                                              \
+    t = now();                                                                \
+    for (unsigned i = 0; i < ops; i++)                                        \
+    {                                                                         \
+      deadline = NAME##_pop(q);                                               \
+      *sum += deadline;                                                       \
+      NAME##_push(q, deadline + 1 + mix(n + i) % (16ull * n));                \
+    }                                                                         \
+    t = now() - t;                                                            \
+                                                                              \
+    NAME##_delete(q, NULL);                                                   \
+    return t;                                                                 \
+  }
+
+HOLD(dary_timers)
+HOLD(binary_timers)
+
+
+/// @brief Dijkstra's shortest paths from vertex 0 of a graph of n vertices
+//  with DEGREE edges each, using decrease-key when a shorter path to a
+//  vertex still in the queue is found.
+//
+/// @return the time taken, in ns.
+#define DIJKSTRA(NAME)                                                        \
+  static double                                                               \
+  NAME##_dijkstra(unsigned n, const unsigned* targets,                        \
+                  const uint32_t* weights, uint64_t* dist)                    \
+  {                                                                           \
+    NAME* q = NAME##_ncreate(n);                                              \
+    unsigned u = 0;                                                           \
+    unsigned v = 0;                                                           \
+    uint64_t d = 0;                                                           \
+    double t = now();                                                         \
+                                                                              \
+    for (unsigned i = 0; i < n; i++)                                          \
+      dist[i] = UINT64_MAX;                                                   \
+    dist[0] = 0;                                                              \
+    NAME##_push(q, 0, 0);                                                     \
+                                                                              \
+    while (!NAME##_empty(q))                                                  \
+    {                                                                         \
+      d = NAME##_pop(q, &u);                                                  \
+      for (size_t e = (size_t)u * DEGREE; e < (size_t)(u + 1) * DEGREE; e++)  \
+      {                                                                       \
+        v = targets[e];                                                       \
+        if (d + weights[e] >= dist[v])                                        \
+          continue;                                                           \
+        dist[v] = d + weights[e];                                             \
+        if (NAME##_contains(q, v))                                            \
+          NAME##_decrease(q, v, dist[v]);                                     \
+        else                                                                  \
+          NAME##_push(q, v, dist[v]);                                         \
+      }                                                                       \
+    }                                                                         \
+    t = now() - t;                                                            \
+                                                                              \
+    NAME##_delete(q, NULL);                                                   \
+    return t;                                                                 \
+  }
+
+DIJKSTRA(dary_paths)
+DIJKSTRA(binary_paths)
+
+
+/// @brief For n timers and a graph of n vertices, print the ns/op of
+//  building the queue (heapify and n pushes), of expirations and of the
+//  edges relaxed by Dijkstra, for the d-ary heap and the binary heap.
+static void
+bench(unsigned n)
+{
+  uint64_t* deadlines = malloc(n * sizeof (uint64_t));
+  unsigned* targets = malloc((size_t)n * DEGREE * sizeof (unsigned));
+  uint32_t* weights = malloc((size_t)n * DEGREE * sizeof (uint32_t));
+  uint64_t* dist = malloc(n * sizeof (uint64_t));
+  uint64_t* check = malloc(n * sizeof (uint64_t));
+  dary_timers* q = dary_timers_ncreate(n);
+  unsigned ops = n < 1000000 ? 1000000 : n;
+  double heapify = 0;
+  double push = 0;
+  double d_hold = 0;
+  double b_hold = 0;
+  double d_path = 0;
+  double b_path = 0;
+  uint64_t sum = 0;
+
+  for (unsigned i = 0; i < n; i++)
+    deadlines[i] = mix(i) % (16ull * n);
+  for (size_t e = 0; e < (size_t)n * DEGREE; e++)
+  {
+    targets[e] = mix(e) % n;
+    weights[e] = 1 + mix(~e) % 1000;
+  }
+
+  heapify = now();
+  dary_timers_heapify(q, deadlines, n);
+  heapify = now() - heapify;
+  dary_timers_clear(q, NULL);
+
+  push = now();
+  for (unsigned i = 0; i < n; i++)
+    dary_timers_push(q, deadlines[i]);
+  push = now() - push;
+  sum += dary_timers_top(q);
+
+  d_hold = dary_timers_hold(n, ops, &sum);
+  b_hold = binary_timers_hold(n, ops, &sum);
+  d_path = dary_paths_dijkstra(n, targets, weights, dist);
+  b_path = binary_paths_dijkstra(n, targets, weights, check);
+
+  for (unsigned i = 0; i < n; i++)
+    if (dist[i] != check[i])
+      fprintf(stderr, "distance of %u differs\n", i);
+
+  printf("%10u %8.1f %8.1f   %8.1f %8.1f   %8.1f %8.1f\n", n, heapify / n,
+         push / n, d_hold / ops, b_hold / ops, d_path / (n * DEGREE),
+         b_path / (n * DEGREE));
+  fprintf(stderr, "%lu\r", (unsigned long)sum);
+
+  dary_timers_delete(q, NULL);
+  free(deadlines);
+  free(targets);
+  free(weights);
+  free(dist);
+  free(check);
+}
+
+
+/// @brief Main function to benchmark the d-ary heap against a binary heap,
+//  from 1000 elements to max elements.
+//  Usage : ./bench [max]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned max = 1000000;
+
+  if (argc > 1)
+    max = strtoul(argv[1], NULL, 10);
+
+  printf("\033[33m > %u-ary (timers) and %u-ary (paths) heaps vs binary "
+         "heaps, ns/op (per edge for Dijkstra)\033[37m :\n\n",
+         (unsigned)PQUEUE_ARITY(uint64_t),
+         (unsigned)PQUEUE_ARITY(s_entry_dary_paths));
+  printf("%10s %8s %8s   %8s %8s   %8s %8s\n", "elements", "heapify", "push",
+         "timers", "binary", "paths", "binary");
+
+  for (unsigned n = 1000; n <= max; n *= 10)
+    bench(n);
+
+  return 0;
+}
@@ -0,0 +1,37 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the priority queue data structure                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef PQ_H_
+# define PQ_H_
+
+# include <stdint.h>
+# include "../pqueue.hxx"
+
+/// @brief Compare unsigned 64 bits elements (pqueue_cmp_int is signed).
+# define CMP_U64(a, b) (((a) > (b)) - ((a) < (b)))
+
+/// @brief The same queues are generated twice : with the default arity in
+//  dary.c, and as binary heaps in binary.c. Timers are deadlines, paths
+//  are the distances of the vertices of a graph (the handles).
+PQUEUE_HEADER(uint64_t, CMP_U64, dary_timers)
+PQUEUE_HEADER(uint64_t, CMP_U64, binary_timers)
+PQUEUE_INDEXED_HEADER(uint64_t, CMP_U64, dary_paths)
+PQUEUE_INDEXED_HEADER(uint64_t, CMP_U64, binary_paths)
+
+#endif /* !PQ_H_ */
@@ -0,0 +1,865 @@
+/******************************************************************************
+**                                                                           **
+**    Implementation of d-ary heaps (priority queues)                        **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file pqueue.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  priority queues, based on d-ary heaps stored in a contiguous array (the
+**  one of the vectors, see vector_realloc). Each element has PQUEUE_ARITY
+**  children instead of two : the heap is about half as deep as a binary
+**  one, and since the array is shifted so that the children of an element
+**  start on a cache line, choosing the child to follow while sifting down
+**  costs a single miss.
+**
+**  The element at the top is the one that comes first according to CMP :
+**  with pqueue_cmp_int it is the smallest one.
+**
+**  After specialization, assuming that you used NAME as the name of the
+**  structure, the names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_ncreate
+**    ~ NAME_delete
+**    ~ NAME_clear
+**    ~ NAME_heapify
+**
+**    ~ NAME_visit
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**
+**    ~ NAME_top
+**
+**    ~ NAME_push
+**    ~ NAME_pop
+**
+**  Queues declared with PQUEUE_INDEXED_HEADER identify their elements by a
+**  handle, an index chosen by the user (a vertex of a graph, a timer...),
+**  and also provide :
+**
+**    ~ NAME_contains
+**    ~ NAME_top_handle
+**    ~ NAME_decrease
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef PQUEUE_HXX_
+# define PQUEUE_HXX_
+
+# include <limits.h>
+# include <stdint.h>
+# include <stdlib.h>
+# include <string.h>
+# include "../vector/vector.hxx"
+
+/**
+** @brief Number of children of each element of the heap : 8 for elements
+**  of up to 8 bytes, 4 above, so that the children of an element fill (at
+**  most) a cache line. Define it before including pqueue.hxx where
+**  PQUEUE_SOURCE is expanded to change it (2 gives a binary heap).
+*/
+# ifndef PQUEUE_ARITY
+#  define PQUEUE_ARITY(TYPE) (sizeof (TYPE) > 8 ? 4 : 8)
+# endif
+
+/**
+** @brief Alignment of the groups of children.
+*/
+# define PQUEUE_CACHE_LINE 64
+
+/**
+** @brief Number of bytes allocated for an array of capacity elements : the
+**  PQUEUE_ARITY - 1 elements of padding in front of the root, and room to
+**  align the whole on a cache line.
+*/
+# define PQUEUE_BYTES(TYPE, CAPACITY)                                         \
+  (((size_t)(CAPACITY) + PQUEUE_ARITY(TYPE) - 1) * sizeof (TYPE)              \
+   + PQUEUE_CACHE_LINE)
+
+/**
+** @brief Ready-to-use comparison function for integer elements. CMP
+**  functions return a negative number, 0 or a positive number when a comes
+**  before, with or after b.
+*/
+static inline int pqueue_cmp_int(long long a, long long b)
+{
+  return (a > b) - (a < b);
+}
+
+/**
+** @brief Accessors of the elements stored in the heap, and hooks called
+**  each time one is stored at a position, for both kinds of queues.
+*/
+# define PQUEUE_ELT(SLOT) (SLOT)
+# define PQUEUE_INDEXED_ELT(SLOT) ((SLOT).elt)
+# define PQUEUE_PLACE(PQUEUE, POS, SLOT)
+# define PQUEUE_INDEXED_PLACE(PQUEUE, POS, SLOT)                              \
+  ((PQUEUE)->positions[(SLOT).handle] = (POS))
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  priority queue data structure. As mentionned in the README, you should
+**  create a header file for your "specialized" structure, include
+**  pqueue.hxx and call this macro.
+**
+** @param TYPE Is the type of the elements.
+** @param CMP Is a function (or a macro) comparing two TYPEs (see
+**  pqueue_cmp_int).
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro. For exemple :
+**
+**    PQUEUE_HEADER(int, pqueue_cmp_int, pqueue)
+**
+**  As for B+trees, the visitor and destructor types are named
+**  NAME_visitor_func and NAME_destructor_func.
+*/
+# define PQUEUE_HEADER(TYPE, CMP, NAME)                                       \
+  typedef struct NAME NAME;                                                   \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    TYPE*           heap;                                                     \
+    void*           array;                                                    \
+    size_t          bytes;                                                    \
+    unsigned        capacity;                                                 \
+    unsigned        count;                                                    \
+  };                                                                          \
+                                                                              \
+  typedef void (*NAME##_visitor_func)(TYPE, void*);                           \
+  typedef void (*NAME##_destructor_func)(TYPE);                               \
+                                                                              \
+  PQUEUE_CREATE_HEADER(TYPE, NAME);                                           \
+  PQUEUE_NCREATE_HEADER(TYPE, NAME);                                          \
+  PQUEUE_DELETE_HEADER(TYPE, NAME);                                           \
+  PQUEUE_CLEAR_HEADER(TYPE, NAME);                                            \
+  PQUEUE_HEAPIFY_HEADER(TYPE, NAME);                                          \
+  PQUEUE_VISIT_HEADER(TYPE, NAME);                                            \
+  PQUEUE_EMPTY_HEADER(TYPE, NAME);                                            \
+  PQUEUE_SIZE_HEADER(TYPE, NAME);                                             \
+  PQUEUE_TOP_HEADER(TYPE, NAME);                                              \
+  PQUEUE_PUSH_HEADER(TYPE, NAME);                                             \
+  PQUEUE_POP_HEADER(TYPE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on priority queues. Call it with the
+**  *same arguments* as PQUEUE_HEADER.
+*/
+# define PQUEUE_SOURCE(TYPE, CMP, NAME)                                       \
+  PQUEUE_REALLOC(TYPE, NAME)                                                  \
+  PQUEUE_GROW(TYPE, NAME)                                                     \
+  PQUEUE_SIFT_UP(TYPE, PQUEUE_ELT, CMP, PQUEUE_PLACE, NAME)                   \
+  PQUEUE_SIFT_DOWN(TYPE, PQUEUE_ELT, CMP, PQUEUE_PLACE, NAME)                 \
+  PQUEUE_CREATE(TYPE, NAME)                                                   \
+  PQUEUE_NCREATE(TYPE, NAME)                                                  \
+  PQUEUE_DELETE(TYPE, NAME)                                                   \
+  PQUEUE_CLEAR(TYPE, NAME)                                                    \
+  PQUEUE_HEAPIFY(TYPE, NAME)                                                  \
+  PQUEUE_VISIT(TYPE, NAME)                                                    \
+  PQUEUE_EMPTY(TYPE, NAME)                                                    \
+  PQUEUE_SIZE(TYPE, NAME)                                                     \
+  PQUEUE_TOP(TYPE, PQUEUE_ELT, NAME)                                          \
+  PQUEUE_PUSH(TYPE, NAME)                                                     \
+  PQUEUE_POP(TYPE, NAME)
+
+
+/**
+** @brief Same as PQUEUE_HEADER, for a queue whose elements are identified
+**  by handles : unsigned integers chosen by the user, at most one element
+**  per handle. The heap stores the handle next to each element, and the
+**  position of each handle in the heap is kept up to date, so that the
+**  element of a handle can be moved up with NAME_decrease.
+**
+**  Handles index an array (grown as needed), they should be small and
+**  dense : the vertices of a graph, the slots of a table of timers...
+**
+**  The visitor and destructor types take the handle, then the element.
+*/
+# define PQUEUE_INDEXED_HEADER(TYPE, CMP, NAME)                               \
+  typedef struct NAME NAME;                                                   \
+  typedef struct s_entry_##NAME s_entry_##NAME;                               \
+                                                                              \
+  struct s_entry_##NAME                                                       \
+  {                                                                           \
+    TYPE            elt;                                                      \
+    unsigned        handle;                                                   \
+  };                                                                          \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    s_entry_##NAME* heap;                                                     \
+    void*           array;                                                    \
+    size_t          bytes;                                                    \
+    unsigned        capacity;                                                 \
+    unsigned        count;                                                    \
+    unsigned*       positions;                                                \
+    unsigned        handles;                                                  \
+  };                                                                          \
+                                                                              \
+  typedef void (*NAME##_visitor_func)(unsigned, TYPE, void*);                 \
+  typedef void (*NAME##_destructor_func)(unsigned, TYPE);                     \
+                                                                              \
+  PQUEUE_CREATE_HEADER(TYPE, NAME);                                           \
+  PQUEUE_NCREATE_HEADER(TYPE, NAME);                                          \
+  PQUEUE_DELETE_HEADER(TYPE, NAME);                                           \
+  PQUEUE_CLEAR_HEADER(TYPE, NAME);                                            \
+  PQUEUE_VISIT_HEADER(TYPE, NAME);                                            \
+  PQUEUE_EMPTY_HEADER(TYPE, NAME);                                            \
+  PQUEUE_SIZE_HEADER(TYPE, NAME);                                             \
+  PQUEUE_INDEXED_CONTAINS_HEADER(TYPE, NAME);                                 \
+  PQUEUE_TOP_HEADER(TYPE, NAME);                                              \
+  PQUEUE_INDEXED_TOP_HANDLE_HEADER(TYPE, NAME);                               \
+  PQUEUE_INDEXED_PUSH_HEADER(TYPE, NAME);                                     \
+  PQUEUE_INDEXED_POP_HEADER(TYPE, NAME);                                      \
+  PQUEUE_INDEXED_DECREASE_HEADER(TYPE, NAME);
+
+
+/**
+** @brief Same as PQUEUE_SOURCE, for queues declared with
+**  PQUEUE_INDEXED_HEADER.
+*/
+# define PQUEUE_INDEXED_SOURCE(TYPE, CMP, NAME)                               \
+  PQUEUE_REALLOC(s_entry_##NAME, NAME)                                        \
+  PQUEUE_GROW(s_entry_##NAME, NAME)                                           \
+  PQUEUE_SIFT_UP(s_entry_##NAME, PQUEUE_INDEXED_ELT, CMP,                     \
+                 PQUEUE_INDEXED_PLACE, NAME)                                  \
+  PQUEUE_SIFT_DOWN(s_entry_##NAME, PQUEUE_INDEXED_ELT, CMP,                   \
+                   PQUEUE_INDEXED_PLACE, NAME)                                \
+  PQUEUE_INDEXED_POSITIONS(TYPE, NAME)                                        \
+  PQUEUE_CREATE(TYPE, NAME)                                                   \
+  PQUEUE_INDEXED_NCREATE(TYPE, NAME)                                          \
+  PQUEUE_INDEXED_DELETE(TYPE, NAME)                                           \
+  PQUEUE_INDEXED_CLEAR(TYPE, NAME)                                            \
+  PQUEUE_INDEXED_VISIT(TYPE, NAME)                                            \
+  PQUEUE_EMPTY(TYPE, NAME)                                                    \
+  PQUEUE_SIZE(TYPE, NAME)                                                     \
+  PQUEUE_INDEXED_CONTAINS(TYPE, NAME)                                         \
+  PQUEUE_TOP(TYPE, PQUEUE_INDEXED_ELT, NAME)                                  \
+  PQUEUE_INDEXED_TOP_HANDLE(TYPE, NAME)                                       \
+  PQUEUE_INDEXED_PUSH(TYPE, CMP, NAME)                                        \
+  PQUEUE_INDEXED_POP(TYPE, NAME)                                              \
+  PQUEUE_INDEXED_DECREASE(TYPE, CMP, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define PQUEUE_CREATE_HEADER(TYPE, NAME)                                     \
+  NAME* NAME##_create()
+
+# define PQUEUE_NCREATE_HEADER(TYPE, NAME)                                    \
+  NAME* NAME##_ncreate(unsigned size)
+
+# define PQUEUE_DELETE_HEADER(TYPE, NAME)                                     \
+  void NAME##_delete(NAME* pqueue, NAME##_destructor_func dest)
+
+# define PQUEUE_CLEAR_HEADER(TYPE, NAME)                                      \
+  void NAME##_clear(NAME* pqueue, NAME##_destructor_func dest)
+
+# define PQUEUE_HEAPIFY_HEADER(TYPE, NAME)                                    \
+  bool NAME##_heapify(NAME* pqueue, const TYPE* elts, unsigned n)
+
+
+// Visiting
+
+# define PQUEUE_VISIT_HEADER(TYPE, NAME)                                      \
+  void NAME##_visit(NAME* pqueue, NAME##_visitor_func v, void* data)
+
+
+// Capacity
+
+# define PQUEUE_EMPTY_HEADER(TYPE, NAME)                                      \
+  bool NAME##_empty(NAME* pqueue)
+
+# define PQUEUE_SIZE_HEADER(TYPE, NAME)                                       \
+  unsigned NAME##_size(NAME* pqueue)
+
+# define PQUEUE_INDEXED_CONTAINS_HEADER(TYPE, NAME)                           \
+  bool NAME##_contains(NAME* pqueue, unsigned handle)
+
+
+// Element access
+
+# define PQUEUE_TOP_HEADER(TYPE, NAME)                                        \
+  TYPE NAME##_top(NAME* pqueue)
+
+# define PQUEUE_INDEXED_TOP_HANDLE_HEADER(TYPE, NAME)                         \
+  unsigned NAME##_top_handle(NAME* pqueue)
+
+
+// Modifiers
+
+# define PQUEUE_PUSH_HEADER(TYPE, NAME)                                       \
+  bool NAME##_push(NAME* pqueue, TYPE elt)
+
+# define PQUEUE_POP_HEADER(TYPE, NAME)                                        \
+  TYPE NAME##_pop(NAME* pqueue)
+
+# define PQUEUE_INDEXED_PUSH_HEADER(TYPE, NAME)                               \
+  bool NAME##_push(NAME* pqueue, unsigned handle, TYPE elt)
+
+# define PQUEUE_INDEXED_POP_HEADER(TYPE, NAME)                                \
+  TYPE NAME##_pop(NAME* pqueue, unsigned* handle)
+
+# define PQUEUE_INDEXED_DECREASE_HEADER(TYPE, NAME)                           \
+  void NAME##_decrease(NAME* pqueue, unsigned handle, TYPE elt)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+
+// Construction / Destruction
+
+
+/**
+** @brief Set the capacity of the heap to (at least) capacity elements, SLOT
+**  being the type stored in the heap. This is the only place where the
+**  array is reallocated : realloc may return an array aligned differently
+**  from the previous one, the elements are then moved so that the children
+**  of each element start on a cache line again. The capacity is at most
+**  UINT_MAX, so the length of the array as allocated is kept in bytes.
+**
+** @return 0 if all went ok, 1 if the allocation failed (the queue is left
+**  untouched).
+*/
+# define PQUEUE_REALLOC(SLOT, NAME)                                           \
+  static int NAME##_realloc(NAME* pqueue, unsigned capacity)                  \
+  {                                                                           \
+    size_t bytes = PQUEUE_BYTES(SLOT, capacity);                              \
+    size_t shift = 0;                                                         \
+    char* array = NULL;                                                       \
+    SLOT* heap = NULL;                                                        \
+                                                                              \
+    if (pqueue->array)                                                        \
+      shift = (char*)pqueue->heap - (char*)pqueue->array;                     \
+    array = vector_realloc(pqueue->array, pqueue->bytes, &bytes);             \
+    if (!array)                                                               \
+      return 1;                                                               \
+                                                                              \
+    heap = (SLOT*)(array + (-(uintptr_t)array & (PQUEUE_CACHE_LINE - 1)))     \
+           + PQUEUE_ARITY(SLOT) - 1;                                          \
+    if (pqueue->count && (size_t)((char*)heap - array) != shift)              \
+      memmove(heap, array + shift, (size_t)pqueue->count * sizeof (SLOT));    \
+                                                                              \
+    pqueue->array = array;                                                    \
+    pqueue->heap = heap;                                                      \
+    pqueue->bytes = bytes;                                                    \
+    bytes = (bytes - PQUEUE_CACHE_LINE) / sizeof (SLOT)                       \
+            - (PQUEUE_ARITY(SLOT) - 1);                                       \
+    pqueue->capacity = bytes > UINT_MAX ? UINT_MAX : bytes;                   \
+    return 0;                                                                 \
+  }
+
+
+/**
+** @brief Make room for at least n elements, growing the capacity by at
+**  least 1.5x as vectors do.
+**
+** @return 0 if all went ok, 1 if the allocation failed (the queue is left
+**  untouched).
+*/
+# define PQUEUE_GROW(SLOT, NAME)                                              \
+  static int NAME##_grow(NAME* pqueue, unsigned n)                            \
+  {                                                                           \
+    unsigned capacity = pqueue->capacity + pqueue->capacity / 2;              \
+                                                                              \
+    if (n <= pqueue->capacity)                                                \
+      return 0;                                                               \
+    if (capacity < pqueue->capacity)                                          \
+      capacity = UINT_MAX;                                                    \
+    if (capacity < n)                                                         \
+      capacity = n;                                                           \
+                                                                              \
+    return NAME##_realloc(pqueue, capacity);                                  \
+  }
+
+
+/**
+** @brief Store slot at position pos, or higher : its ancestors that come
+**  after it are moved one level down, into the hole left by the previous
+**  one, rather than swapped.
+*/
+# define PQUEUE_SIFT_UP(SLOT, ELT, CMP, PLACE, NAME)                          \
+  static void NAME##_sift_up(NAME* pqueue, unsigned pos, SLOT slot)           \
+  {                                                                           \
+    SLOT* heap = pqueue->heap;                                                \
+    unsigned parent = 0;                                                      \
+                                                                              \
+    while (pos)                                                               \
+    {                                                                         \
+      parent = (pos - 1) / PQUEUE_ARITY(SLOT);                                \
+      if (CMP(ELT(heap[parent]), ELT(slot)) <= 0)                             \
+        break;                                                                \
+      heap[pos] = heap[parent];                                               \
+      PLACE(pqueue, pos, heap[pos]);                                          \
+      pos = parent;                                                           \
+    }                                                                         \
+                                                                              \
+    heap[pos] = slot;                                                         \
+    PLACE(pqueue, pos, slot);                                                 \
+  }
+
+
+/**
+** @brief Store slot at position pos, or lower : while one of the children
+**  of the hole comes before slot, the first of them moves up. The children
+**  of an element are contiguous and aligned, comparing them reads a single
+**  cache line when PQUEUE_ARITY * sizeof (SLOT) is at most 64 bytes.
+*/
+# define PQUEUE_SIFT_DOWN(SLOT, ELT, CMP, PLACE, NAME)                        \
+  static void NAME##_sift_down(NAME* pqueue, unsigned pos, SLOT slot)         \
+  {                                                                           \
+    SLOT* heap = pqueue->heap;                                                \
+    size_t count = pqueue->count;                                             \
+    size_t child = 0;                                                         \
+    size_t last = 0;                                                          \
+    size_t best = 0;                                                          \
+                                                                              \
+    while ((child = (size_t)pos * PQUEUE_ARITY(SLOT) + 1) < count)            \
+    {                                                                         \
+      last = child + PQUEUE_ARITY(SLOT);                                      \
+      if (last > count)                                                       \
+        last = count;                                                         \
+      for (best = child++; child < last; child++)                             \
+        if (CMP(ELT(heap[child]), ELT(heap[best])) < 0)                       \
+          best = child;                                                       \
+                                                                              \
+      if (CMP(ELT(heap[best]), ELT(slot)) >= 0)                               \
+        break;                                                                \
+      heap[pos] = heap[best];                                                 \
+      PLACE(pqueue, pos, heap[pos]);                                          \
+      pos = best;                                                             \
+    }                                                                         \
+                                                                              \
+    heap[pos] = slot;                                                         \
+    PLACE(pqueue, pos, slot);                                                 \
+  }
+
+
+/**
+** @brief Simply call the ncreate function with a default value,
+**  and return the result.
+**
+** @param TYPE type of the elements
+** @param NAME name of the priority queue structure
+*/
+# define PQUEUE_CREATE(TYPE, NAME)                                            \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    return NAME##_ncreate(42);                                                \
+  }
+
+
+/**
+** @brief Create an empty priority queue with room for size elements.
+**
+** @return a pointer on the new queue, or NULL if the allocation failed.
+*/
+# define PQUEUE_NCREATE(TYPE, NAME)                                           \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_pqueue = NULL;                                                  \
+                                                                              \
+    if (!(new_pqueue = malloc(sizeof (NAME))))                                \
+      return NULL;                                                            \
+                                                                              \
+    new_pqueue->heap = NULL;                                                  \
+    new_pqueue->array = NULL;                                                 \
+    new_pqueue->bytes = 0;                                                    \
+    new_pqueue->capacity = 0;                                                 \
+    new_pqueue->count = 0;                                                    \
+    if (NAME##_realloc(new_pqueue, size))                                     \
+    {                                                                         \
+      free(new_pqueue);                                                       \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    return new_pqueue;                                                        \
+  }
+
+
+/**
+** @brief Free the memory used by the queue, calling dest on each element
+**  first if it is not NULL.
+*/
+# define PQUEUE_DELETE(TYPE, NAME)                                            \
+  void NAME##_delete(NAME* pqueue, NAME##_destructor_func dest)               \
+  {                                                                           \
+    NAME##_clear(pqueue, dest);                                               \
+    vector_free(pqueue->array, pqueue->bytes);                                \
+    free(pqueue);                                                             \
+  }
+
+
+/**
+** @brief Remove every element of the queue, calling dest on each one
+**  first if it is not NULL. The capacity is kept.
+*/
+# define PQUEUE_CLEAR(TYPE, NAME)                                             \
+  void NAME##_clear(NAME* pqueue, NAME##_destructor_func dest)                \
+  {                                                                           \
+    if (dest)                                                                 \
+      for (unsigned i = 0; i < pqueue->count; i++)                            \
+        dest(pqueue->heap[i]);                                                \
+    pqueue->count = 0;                                                        \
+  }
+
+
+/**
+** @brief Add the n elements of elts to the queue at once : they are
+**  appended to the array, then the heap is rebuilt from its last parent up
+**  to the root, which costs O(size + n) comparisons instead of the
+**  O(n log(size)) of n pushes. When only a few elements are added to a big
+**  queue, they are sifted up one by one instead.
+**
+** @return TRUE (1) if all went ok, FALSE (0) if the allocation failed (the
+**  queue is left untouched).
+*/
+# define PQUEUE_HEAPIFY(TYPE, NAME)                                           \
+  bool NAME##_heapify(NAME* pqueue, const TYPE* elts, unsigned n)             \
+  {                                                                           \
+    unsigned count = pqueue->count;                                           \
+                                                                              \
+    if (n > UINT_MAX - count || NAME##_grow(pqueue, count + n))               \
+      return FALSE;                                                           \
+                                                                              \
+    if (count / PQUEUE_ARITY(TYPE) > n)                                       \
+    {                                                                         \
+      for (unsigned i = 0; i < n; i++)                                        \
+      {                                                                       \
+        pqueue->count++;                                                      \
+        NAME##_sift_up(pqueue, count + i, elts[i]);                           \
+      }                                                                       \
+      return TRUE;                                                            \
+    }                                                                         \
+                                                                              \
+    memcpy(pqueue->heap + count, elts, (size_t)n * sizeof (TYPE));            \
+    pqueue->count += n;                                                       \
+    if (pqueue->count > 1)                                                    \
+      for (unsigned i = (pqueue->count - 2) / PQUEUE_ARITY(TYPE) + 1; i--; )  \
+        NAME##_sift_down(pqueue, i, pqueue->heap[i]);                         \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+// Visiting
+
+
+/**
+** @brief Call the visitor on each element of the queue, in the order of
+**  the array (not by priority).
+*/
+# define PQUEUE_VISIT(TYPE, NAME)                                             \
+  void NAME##_visit(NAME* pqueue, NAME##_visitor_func v, void* data)          \
+  {                                                                           \
+    for (unsigned i = 0; i < pqueue->count; i++)                              \
+      v(pqueue->heap[i], data);                                               \
+  }
+
+
+// Capacity
+
+
+# define PQUEUE_EMPTY(TYPE, NAME)                                             \
+  bool NAME##_empty(NAME* pqueue)                                             \
+  {                                                                           \
+    return !pqueue->count;                                                    \
+  }
+
+
+# define PQUEUE_SIZE(TYPE, NAME)                                              \
+  unsigned NAME##_size(NAME* pqueue)                                          \
+  {                                                                           \
+    return pqueue->count;                                                     \
+  }
+
+
+// Element access
+
+
+/**
+** @brief Return (but don't remove) the element that comes first. The
+**  queue must not be empty.
+*/
+# define PQUEUE_TOP(TYPE, ELT, NAME)                                          \
+  TYPE NAME##_top(NAME* pqueue)                                               \
+  {                                                                           \
+    return ELT(pqueue->heap[0]);                                              \
+  }
+
+
+// Modifiers
+
+
+/**
+** @brief Add elt to the queue, in O(log(size)).
+**
+** @return TRUE (1) if all went ok, FALSE (0) if the allocation failed.
+*/
+# define PQUEUE_PUSH(TYPE, NAME)                                              \
+  bool NAME##_push(NAME* pqueue, TYPE elt)                                    \
+  {                                                                           \
+    if (pqueue->count == UINT_MAX || NAME##_grow(pqueue, pqueue->count + 1))  \
+      return FALSE;                                                           \
+                                                                              \
+    NAME##_sift_up(pqueue, pqueue->count++, elt);                             \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Remove the element that comes first and return it. The last
+**  element of the array takes its place and is sifted down. The queue must
+**  not be empty.
+*/
+# define PQUEUE_POP(TYPE, NAME)                                               \
+  TYPE NAME##_pop(NAME* pqueue)                                               \
+  {                                                                           \
+    TYPE top = pqueue->heap[0];                                               \
+                                                                              \
+    if (--pqueue->count)                                                      \
+      NAME##_sift_down(pqueue, 0, pqueue->heap[pqueue->count]);               \
+                                                                              \
+    return top;                                                               \
+  }
+
+
+
+/*
+ *
+ * INDEXED QUEUES
+ *
+ */
+
+
+/**
+** @brief Make room for the handles up to n - 1 in the array of positions,
+**  growing it by at least 1.5x. Handles that are not in the queue have
+**  the position UINT_MAX.
+**
+** @return 0 if all went ok, 1 if the allocation failed.
+*/
+# define PQUEUE_INDEXED_POSITIONS(TYPE, NAME)                                 \
+  static int NAME##_positions(NAME* pqueue, unsigned n)                       \
+  {                                                                           \
+    unsigned handles = pqueue->handles + pqueue->handles / 2;                 \
+    unsigned* positions = NULL;                                               \
+                                                                              \
+    if (n <= pqueue->handles)                                                 \
+      return 0;                                                               \
+    if (handles < pqueue->handles)                                            \
+      handles = UINT_MAX;                                                     \
+    if (handles < n)                                                          \
+      handles = n;                                                            \
+                                                                              \
+    if (!(positions = realloc(pqueue->positions,                              \
+                              (size_t)handles * sizeof (unsigned))))          \
+      return 1;                                                               \
+                                                                              \
+    memset(positions + pqueue->handles, 0xFF,                                 \
+           (size_t)(handles - pqueue->handles) * sizeof (unsigned));          \
+    pqueue->positions = positions;                                            \
+    pqueue->handles = handles;                                                \
+    return 0;                                                                 \
+  }
+
+
+/**
+** @brief Create an empty queue with room for size elements, and for the
+**  handles lower than size.
+**
+** @return a pointer on the new queue, or NULL if the allocation failed.
+*/
+# define PQUEUE_INDEXED_NCREATE(TYPE, NAME)                                   \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_pqueue = NULL;                                                  \
+                                                                              \
+    if (!(new_pqueue = malloc(sizeof (NAME))))                                \
+      return NULL;                                                            \
+                                                                              \
+    new_pqueue->heap = NULL;                                                  \
+    new_pqueue->array = NULL;                                                 \
+    new_pqueue->bytes = 0;                                                    \
+    new_pqueue->capacity = 0;                                                 \
+    new_pqueue->count = 0;                                                    \
+    new_pqueue->positions = NULL;                                             \
+    new_pqueue->handles = 0;                                                  \
+    if (NAME##_positions(new_pqueue, size ? size : 1))                        \
+    {                                                                         \
+      free(new_pqueue);                                                       \
+      return NULL;                                                            \
+    }                                                                         \
+    if (NAME##_realloc(new_pqueue, size))                                     \
+    {                                                                         \
+      free(new_pqueue->positions);                                            \
+      free(new_pqueue);                                                       \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    return new_pqueue;                                                        \
+  }
+
+
+# define PQUEUE_INDEXED_DELETE(TYPE, NAME)                                    \
+  void NAME##_delete(NAME* pqueue, NAME##_destructor_func dest)               \
+  {                                                                           \
+    NAME##_clear(pqueue, dest);                                               \
+    vector_free(pqueue->array, pqueue->bytes);                                \
+    free(pqueue->positions);                                                  \
+    free(pqueue);                                                             \
+  }
+
+
+/**
+** @brief Remove every element of the queue, calling dest on each one
+**  first if it is not NULL. Only the positions of the handles that were in
+**  the queue are reset.
+*/
+# define PQUEUE_INDEXED_CLEAR(TYPE, NAME)                                     \
+  void NAME##_clear(NAME* pqueue, NAME##_destructor_func dest)                \
+  {                                                                           \
+    s_entry_##NAME* entry = NULL;                                             \
+                                                                              \
+    for (unsigned i = 0; i < pqueue->count; i++)                              \
+    {                                                                         \
+      entry = pqueue->heap + i;                                               \
+      pqueue->positions[entry->handle] = UINT_MAX;                            \
+      if (dest)                                                               \
+        dest(entry->handle, entry->elt);                                      \
+    }                                                                         \
+    pqueue->count = 0;                                                        \
+  }
+
+
+# define PQUEUE_INDEXED_VISIT(TYPE, NAME)                                     \
+  void NAME##_visit(NAME* pqueue, NAME##_visitor_func v, void* data)          \
+  {                                                                           \
+    for (unsigned i = 0; i < pqueue->count; i++)                              \
+      v(pqueue->heap[i].handle, pqueue->heap[i].elt, data);                   \
+  }
+
+
+# define PQUEUE_INDEXED_CONTAINS(TYPE, NAME)                                  \
+  bool NAME##_contains(NAME* pqueue, unsigned handle)                         \
+  {                                                                           \
+    return handle < pqueue->handles && pqueue->positions[handle] != UINT_MAX; \
+  }
+
+
+/**
+** @brief Return the handle of the element that comes first. The queue
+**  must not be empty.
+*/
+# define PQUEUE_INDEXED_TOP_HANDLE(TYPE, NAME)                                \
+  unsigned NAME##_top_handle(NAME* pqueue)                                    \
+  {                                                                           \
+    return pqueue->heap[0].handle;                                            \
+  }
+
+
+/**
+** @brief Add elt to the queue under handle (lower than UINT_MAX), in
+**  O(log(size)).
+**
+** @return TRUE (1) if all went ok, FALSE (0) if handle is already in the
+**  queue (use NAME_decrease) or if the allocation failed.
+*/
+# define PQUEUE_INDEXED_PUSH(TYPE, CMP, NAME)                                 \
+  bool NAME##_push(NAME* pqueue, unsigned handle, TYPE elt)                   \
+  {                                                                           \
+    s_entry_##NAME entry;                                                     \
+                                                                              \
+    if (handle == UINT_MAX || NAME##_positions(pqueue, handle + 1)            \
+        || pqueue->positions[handle] != UINT_MAX)                             \
+      return FALSE;                                                           \
+    if (pqueue->count == UINT_MAX || NAME##_grow(pqueue, pqueue->count + 1))  \
+      return FALSE;                                                           \
+                                                                              \
+    entry.elt = elt;                                                          \
+    entry.handle = handle;                                                    \
+    NAME##_sift_up(pqueue, pqueue->count++, entry);                           \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Remove the element that comes first and return it. Its handle is
+**  stored in handle if it is not NULL, and is no longer in the queue. The
+**  queue must not be empty.
+*/
+# define PQUEUE_INDEXED_POP(TYPE, NAME)                                       \
+  TYPE NAME##_pop(NAME* pqueue, unsigned* handle)                             \
+  {                                                                           \
+    s_entry_##NAME top = pqueue->heap[0];                                     \
+                                                                              \
+    pqueue->positions[top.handle] = UINT_MAX;                                 \
+    if (--pqueue->count)                                                      \
+      NAME##_sift_down(pqueue, 0, pqueue->heap[pqueue->count]);               \
+    if (handle)                                                               \
+      *handle = top.handle;                                                   \
+                                                                              \
+    return top.elt;                                                           \
+  }
+
+
+/**
+** @brief Replace the element of handle, which must be in the queue, by elt
+**  (decrease-key) : when elt comes before the previous element it is
+**  sifted up, in O(log(size)) moves of one level each. An elt that comes
+**  after it is sifted down instead, so any priority can be changed.
+*/
+# define PQUEUE_INDEXED_DECREASE(TYPE, CMP, NAME)                             \
+  void NAME##_decrease(NAME* pqueue, unsigned handle, TYPE elt)               \
+  {                                                                           \
+    unsigned pos = pqueue->positions[handle];                                 \
+    s_entry_##NAME entry;                                                     \
+                                                                              \
+    entry.elt = elt;                                                          \
+    entry.handle = handle;                                                    \
+    if (CMP(elt, pqueue->heap[pos].elt) <= 0)                                 \
+      NAME##_sift_up(pqueue, pos, entry);                                     \
+    else                                                                      \
+      NAME##_sift_down(pqueue, pos, entry);                                   \
+  }
+
+
+#endif /* !PQUEUE_HXX_ */
@@ -0,0 +1,109 @@
+/******************************************************************************
+**                                                                           **
+**    Test code for the priority queue data structure                        **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include "pqueue.h"
+
+/// @brief Visitor for an element of the indexed queue. Simply print the
+//  handle and the element on stdout, followed by a eol.
+///
+/// @param handle The handle
+/// @param elt The element
+/// @param data Could possibly store data in that pointer
+void
+visitor(unsigned handle, int elt, void* data)
+{
+  printf("%u : %i\n", handle, elt);
+}
+
+
+/// @brief Main function to test the priority queue structures
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(void)
+{
+  int elts[10];
+  unsigned handle = 0;
+  pqueue* q = NULL;
+  ipqueue* iq = NULL;
+
+  printf("\033[33m > Starting priority queue test\033[37m :\n\n");
+
+  // Creating queue
+  printf("[ \033[32mCreating\033[37m queue ..\n");
+  q = pqueue_create();
+  if (!q)
+    return 1;
+  printf("Queue correctly created ] \n\n");
+
+  printf("Is the queue empty ? > %s\n", (pqueue_empty(q) ? "yes" : "no"));
+  printf("Queue size : %i\n\n", pqueue_size(q));
+
+  printf("[ \033[32mPushing\033[37m 20 elements in any order ..\n\n");
+  for (int i = 0; i < 20; i++)
+    pqueue_push(q, (i * 7) % 20);
+
+  printf("Is the queue empty ? > %s\n", (pqueue_empty(q) ? "yes" : "no"));
+  printf("Queue size : %i\n", pqueue_size(q));
+  printf("Top of the queue : %i\n\n", pqueue_top(q));
+
+  printf("[ \033[32mPopping\033[37m 5 elements ..\n");
+  for (int i = 0; i < 5; i++)
+    printf("%i\n", pqueue_pop(q));
+
+  // Adding elements at once
+  printf("\n[ \033[32mHeapifying\033[37m 10 more elements ..\n\n");
+  for (int i = 0; i < 10; i++)
+    elts[i] = 100 - i * 11;
+  pqueue_heapify(q, elts, 10);
+
+  printf("Queue size : %i\n", pqueue_size(q));
+  printf("Top of the queue : %i\n", pqueue_top(q));
+
+  printf("\n[ \033[32mDeleting\033[37m the queue..\n\n");
+  pqueue_delete(q, NULL);
+
+  // Changing the priority of an element through its handle
+  printf("[ \033[32mCreating\033[37m indexed queue ..\n");
+  iq = ipqueue_create();
+  if (!iq)
+    return 1;
+  printf("Queue correctly created ] \n\n");
+
+  for (unsigned i = 0; i < 5; i++)
+    ipqueue_push(iq, i, 10 * (i + 1));
+
+  printf("\033[32mVisiting\033[37m the queue ..\n");
+  ipqueue_visit(iq, visitor, NULL);
+
+  printf("\n[ \033[32mDecreasing\033[37m the element of handle 3 to 5 ..\n\n");
+  ipqueue_decrease(iq, 3, 5);
+  printf("Top of the queue : %i (handle %u)\n", ipqueue_top(iq),
+         ipqueue_top_handle(iq));
+  printf("Popped : %i", ipqueue_pop(iq, &handle));
+  printf(" (handle %u)\n", handle);
+  printf("Does the queue contain handle \033[32m3\033[37m ? > %s\n\n",
+         (ipqueue_contains(iq, 3) ? "yes" : "no"));
+
+  printf("[ \033[32mDeleting\033[37m the queue..\n\n");
+  ipqueue_delete(iq, NULL);
+
+  return 0;
+}
@@ -0,0 +1,32 @@
+/******************************************************************************
+**                                                                           **
+**    Test code for the priority queue data structure                        **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef PQUEUE_H_
+# define PQUEUE_H_
+
+# include "../pqueue.hxx"
+
+/// @brief This macro call will be replace at compile-time by
+//  prototypes and struct declarations for the priority queue data-structure
+PQUEUE_HEADER(int, pqueue_cmp_int, pqueue)
+
+/// @brief Same for a priority queue whose elements have a handle
+PQUEUE_INDEXED_HEADER(int, pqueue_cmp_int, ipqueue)
+
+#endif /* !PQUEUE_H_ */
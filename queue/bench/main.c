@@ -0,0 +1,228 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the ring-buffer queues                              **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "ring.h"
+
+#define BATCH 64
+
+/// @brief Kind of queue (and of calls) exercised by a run.
+enum mode
+{
+  SPSC,
+  SPSC_BATCH,
+  MPMC,
+  MPMC_BATCH,
+  MUTEX
+};
+
+/// @brief Shared state of a run.
+struct run
+{
+  enum mode       mode;
+  spsc*           spsc;
+  mpmc*           mpmc;
+  queue*          queue;
+  pthread_mutex_t lock;
+  unsigned        per_producer;
+  unsigned        per_consumer;
+};
+
+/// @brief What a thread has to do, and what it computed.
+struct worker
+{
+  struct run*         run;
+  unsigned            first;
+  unsigned long long  sum;
+};
+
+
+/// @brief Push [first, first + per_producer[ in the queue of the run,
+//  spinning (with a yield) when it is full.
+static void*
+producer(void* arg)
+{
+  struct worker* w = arg;
+  struct run* r = w->run;
+  unsigned end = w->first + r->per_producer;
+  int batch[BATCH];
+  unsigned n = 0;
+
+  for (unsigned i = w->first; i < end; )
+    switch (r->mode)
+    {
+      case SPSC:
+        if (spsc_try_push(r->spsc, i))
+          i++;
+        else
+          sched_yield();
+        break;
+      case MPMC:
+        if (mpmc_try_push(r->mpmc, i))
+          i++;
+        else
+          sched_yield();
+        break;
+      case SPSC_BATCH:
+      case MPMC_BATCH:
+        n = end - i < BATCH ? end - i : BATCH;
+        for (unsigned j = 0; j < n; j++)
+          batch[j] = i + j;
+        n = r->mode == SPSC_BATCH ? spsc_push_n(r->spsc, batch, n)
+                                  : mpmc_push_n(r->mpmc, batch, n);
+        if (!n)
+          sched_yield();
+        i += n;
+        break;
+      case MUTEX:
+        pthread_mutex_lock(&r->lock);
+        queue_push(r->queue, i++);
+        pthread_mutex_unlock(&r->lock);
+        break;
+    }
+
+  return NULL;
+}
+
+
+/// @brief Pop per_consumer elements from the queue of the run and sum
+//  them, so that the result can be checked.
+static void*
+consumer(void* arg)
+{
+  struct worker* w = arg;
+  struct run* r = w->run;
+  int batch[BATCH];
+  int elt = 0;
+  unsigned n = 0;
+
+  for (unsigned left = r->per_consumer; left; )
+  {
+    switch (r->mode)
+    {
+      case SPSC:
+        n = spsc_try_pop(r->spsc, batch);
+        break;
+      case MPMC:
+        n = mpmc_try_pop(r->mpmc, batch);
+        break;
+      case SPSC_BATCH:
+        n = spsc_pop_n(r->spsc, batch, left < BATCH ? left : BATCH);
+        break;
+      case MPMC_BATCH:
+        n = mpmc_pop_n(r->mpmc, batch, left < BATCH ? left : BATCH);
+        break;
+      case MUTEX:
+        pthread_mutex_lock(&r->lock);
+        if ((n = !queue_empty(r->queue)))
+          elt = queue_pop(r->queue);
+        pthread_mutex_unlock(&r->lock);
+        batch[0] = elt;
+        break;
+    }
+
+    if (!n)
+      sched_yield();
+    for (unsigned j = 0; j < n; j++)
+      w->sum += batch[j];
+    left -= n;
+  }
+
+  return NULL;
+}
+
+
+/// @brief Run a benchmark with the given number of producers / consumers
+//  and print the throughput.
+static void
+bench(const char* label, enum mode mode, unsigned count,
+      unsigned producers, unsigned consumers)
+{
+  struct run r;
+  struct worker w[producers + consumers];
+  pthread_t t[producers + consumers];
+  struct timespec start, stop;
+  unsigned long long sum = 0;
+  unsigned long long expected = 0;
+  double seconds = 0;
+
+  count -= count % (producers * consumers);
+  r.mode = mode;
+  r.spsc = spsc_ncreate(4096);
+  r.mpmc = mpmc_ncreate(4096);
+  r.queue = queue_ncreate(4096);
+  r.per_producer = count / producers;
+  r.per_consumer = count / consumers;
+  pthread_mutex_init(&r.lock, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (unsigned i = 0; i < producers + consumers; i++)
+  {
+    w[i].run = &r;
+    w[i].first = i * r.per_producer;
+    w[i].sum = 0;
+    pthread_create(&t[i], NULL, i < producers ? producer : consumer, &w[i]);
+  }
+  for (unsigned i = 0; i < producers + consumers; i++)
+  {
+    pthread_join(t[i], NULL);
+    sum += i < producers ? 0 : w[i].sum;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+
+  seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+  expected = (unsigned long long)count * (count - 1) / 2;
+  printf("%-12s %2uP/%2uC  %10.2f Mops/s  %s\n", label, producers, consumers,
+         count / seconds / 1e6, sum == expected ? "ok" : "\033[31mKO\033[37m");
+
+  spsc_delete(r.spsc, NULL);
+  mpmc_delete(r.mpmc, NULL);
+  queue_delete(r.queue, NULL);
+  pthread_mutex_destroy(&r.lock);
+}
+
+
+/// @brief Main function to benchmark the ring-buffer queues.
+//  Usage : ./bench [count] [max_threads]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned count = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+  unsigned threads = argc > 2 ? strtoul(argv[2], NULL, 10) : 4;
+
+  printf("\033[33m > Queue throughput, %u elements\033[37m :\n\n", count);
+
+  bench("spsc", SPSC, count, 1, 1);
+  bench("spsc batch", SPSC_BATCH, count, 1, 1);
+  bench("mutex", MUTEX, count, 1, 1);
+
+  for (unsigned n = 1; n <= threads; n *= 2)
+  {
+    bench("mpmc", MPMC, count, n, n);
+    bench("mpmc batch", MPMC_BATCH, count, n, n);
+    bench("mutex", MUTEX, count, n, n);
+  }
+
+  return 0;
+}
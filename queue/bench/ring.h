@@ -0,0 +1,32 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the ring-buffer queues                              **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef RING_H_
+# define RING_H_
+
+# include "../ring.hxx"
+# include "../queue.hxx"
+
+/// @brief Lock-free queues under test, and the classic queue used as a
+//  baseline (protected by a mutex in the benchmark).
+QUEUE_SPSC_HEADER(int, spsc)
+QUEUE_MPMC_HEADER(int, mpmc)
+QUEUE_HEADER(int, queue)
+
+#endif /* !RING_H_ */
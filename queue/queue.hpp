@@ -0,0 +1,306 @@
+/******************************************************************************
+**                                                                           **
+**    C++ front-end of the array-based, dynamic queue                        **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file queue.hpp
+**
+** @author Remi BERSON
+**
+** @brief This file contains ds::ring_queue, the C++ counterpart of the
+**  queues of queue.hxx (see cxx/memory.hpp for what the C++ containers have
+**  in common). As in QUEUE_HEADER, the elements are stored in a circular
+**  array whose size is a power of two : the queue holds the array, the
+**  number of elements, the position of the first one, the size of the
+**  array and the snapshot pointer (always null here), and never the
+**  DS_STATS counters. The sizes given by
+**  Growth are rounded up to powers of two (see queue_round), so any
+**  capacity policy can be used : the array is doubled by default.
+**
+**  The C functions generated by the macros are not affected by this file,
+**  which does not include queue.hxx.
+*/
+
+
+#ifndef QUEUE_HPP_
+# define QUEUE_HPP_
+
+# include "../cxx/memory.hpp"
+
+namespace ds
+{
+  template <typename T, typename Alloc = malloc_allocator<T>,
+            typename Growth = queue_growth>
+  class ring_queue : private Alloc
+  {
+    using traits = std::allocator_traits<Alloc>;
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = unsigned;
+
+    // Construction / Destruction
+
+    /**
+    ** @brief Create an empty queue with room for at least size elements (as
+    **  NAME_ncreate does).
+    */
+    explicit ring_queue(unsigned size = Growth::initial,
+                        const Alloc& alloc = Alloc())
+      : Alloc(alloc), queue_(nullptr), count_(0), begin_(0),
+        array_size_(round(Growth::grow(0, size))), snapshot_(nullptr)
+    {
+      queue_ = traits::allocate(*this, array_size_);
+    }
+
+    ring_queue(const ring_queue& other)
+      : ring_queue(other.array_size_,
+                   traits::select_on_container_copy_construction(
+                     static_cast<const Alloc&>(other)))
+    {
+      other.visit([this](const T& elt) { emplace(elt); });
+    }
+
+    ring_queue(ring_queue&& other) noexcept
+      : Alloc(std::move(static_cast<Alloc&>(other))), queue_(other.queue_),
+        count_(other.count_), begin_(other.begin_),
+        array_size_(other.array_size_), snapshot_(nullptr)
+    {
+      other.queue_ = nullptr;
+      other.count_ = 0;
+      other.begin_ = 0;
+      other.array_size_ = 0;
+    }
+
+    ring_queue& operator=(ring_queue other) noexcept
+    {
+      swap(other);
+      return *this;
+    }
+
+    ~ring_queue()
+    {
+      clear();
+      if (queue_)
+        traits::deallocate(*this, queue_, array_size_);
+    }
+
+    // Visiting
+
+    /**
+    ** @brief Call visit(elt) on each element, from the front to the back.
+    **  The visitor is a template parameter (a lambda, a function object...) :
+    **  its call is inlined in the two loops, one on each side of the end of
+    **  the array.
+    */
+    template <typename Visitor>
+    void visit(Visitor&& visit)
+    {
+      unsigned end = begin_ + count_;
+      unsigned first = end < array_size_ ? end : array_size_;
+
+      for (unsigned i = begin_; i < first; i++)
+        visit(queue_[i]);
+      for (unsigned i = 0; i < end - first; i++)
+        visit(queue_[i]);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visit) const
+    {
+      const_cast<ring_queue*>(this)->visit(
+        [&visit](const T& elt) { visit(elt); });
+    }
+
+    // Capacity
+
+    unsigned size() const noexcept
+    {
+      return count_;
+    }
+
+    unsigned capacity() const noexcept
+    {
+      return array_size_;
+    }
+
+    bool empty() const noexcept
+    {
+      return !count_;
+    }
+
+    // Element access
+
+    T& front() noexcept
+    {
+      return queue_[begin_];
+    }
+
+    T& back() noexcept
+    {
+      return queue_[(begin_ + count_ - 1) & (array_size_ - 1)];
+    }
+
+    // Modifiers
+
+    void push(const T& elt)
+    {
+      emplace(elt);
+    }
+
+    void push(T&& elt)
+    {
+      emplace(std::move(elt));
+    }
+
+    /**
+    ** @brief Construct an element from args at the back of the queue. If
+    **  the array has to grow, the element is built before, as args may
+    **  refer to an element of the queue.
+    */
+    template <typename... Args>
+    T& emplace(Args&&... args)
+    {
+      if (count_ == array_size_)
+      {
+        T elt(std::forward<Args>(args)...);
+
+        grow(count_ + 1);
+        return *new (slot()) T(std::move(elt));
+      }
+
+      return *new (slot()) T(std::forward<Args>(args)...);
+    }
+
+    /**
+    ** @brief Remove and return the front element, moved out of the array.
+    */
+    T pop()
+    {
+      T elt(std::move(queue_[begin_]));
+
+      queue_[begin_].~T();
+      begin_ = (begin_ + 1) & (array_size_ - 1);
+      count_--;
+
+      return elt;
+    }
+
+    void clear() noexcept
+    {
+      visit([](T& elt) { elt.~T(); });
+      count_ = 0;
+      begin_ = 0;
+    }
+
+    void swap(ring_queue& other) noexcept
+    {
+      std::swap(static_cast<Alloc&>(*this), static_cast<Alloc&>(other));
+      std::swap(queue_, other.queue_);
+      std::swap(count_, other.count_);
+      std::swap(begin_, other.begin_);
+      std::swap(array_size_, other.array_size_);
+    }
+
+  private:
+    /**
+    ** @brief The free slot after the back element, now used.
+    */
+    T* slot() noexcept
+    {
+      return queue_ + ((begin_ + count_++) & (array_size_ - 1));
+    }
+
+    /**
+    ** @brief Round a size given by Growth up to a power of two, that the
+    **  positions are masked with.
+    */
+    static unsigned round(unsigned size)
+    {
+      unsigned rounded = queue_round(size);
+
+      if (!rounded)
+        throw std::length_error("ds: capacity too large");
+      return rounded;
+    }
+
+    /**
+    ** @brief Grow the (full) array to hold at least needed elements. With
+    **  realloc, the elements before begin are copied after the old end as
+    **  in QUEUE_PUSH, otherwise all of them are moved to the start of a new
+    **  array.
+    */
+    void grow(unsigned needed)
+    {
+      unsigned size = round(Growth::grow(array_size_, needed));
+      unsigned old = array_size_;
+      T* queue = nullptr;
+      unsigned i = 0;
+
+      // Both sizes are powers of two and size > old, so size >= 2 * old :
+      // the elements that wrapped around the old end fit right after it,
+      // where begin + i now lands.
+      if constexpr (std::is_trivially_copyable_v<T>
+                    && detail::has_reallocate<Alloc>::value)
+      {
+        if (queue_)
+        {
+          queue_ = Alloc::reallocate(queue_, old, size);
+          std::memcpy(static_cast<void*>(queue_ + old), queue_,
+                      begin_ * sizeof (T));
+          array_size_ = size;
+          return;
+        }
+      }
+
+      queue = traits::allocate(*this, size);
+      try
+      {
+        for (; i < count_; i++)
+          new (queue + i)
+            T(std::move_if_noexcept(queue_[(begin_ + i) & (array_size_ - 1)]));
+      }
+      catch (...)
+      {
+        std::destroy(queue, queue + i);
+        traits::deallocate(*this, queue, size);
+        throw;
+      }
+
+      clear();
+      if (queue_)
+        traits::deallocate(*this, queue_, array_size_);
+      queue_ = queue;
+      count_ = i;
+      array_size_ = size;
+    }
+
+    T*          queue_;
+    unsigned    count_;
+    unsigned    begin_;
+    unsigned    array_size_;
+    [[maybe_unused]]
+    void*       snapshot_;
+  };
+}
+
+#endif /* !QUEUE_HPP_ */
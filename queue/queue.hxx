@@ -49,6 +49,9 @@
 **    ~ NAME_push
 **    ~ NAME_pop
 **
+**  The capacity of the circular array is always a power of two, so that
+**  the position of an element is computed with a mask instead of a modulo.
+**
 **  See bellow for more details about this functions.
 */
 
@@ -57,6 +60,10 @@
 # define QUEUE_HXX_
 
 # include <stdlib.h>
+# include <string.h>
+# include "round.hxx"
+# include "../snapshot/snapshot.hxx"
+# include "../stats/stats.hxx"
 
 /**
 ** @brief Defines a "boolean" type. This is much pleasant to use.
@@ -66,13 +73,12 @@ typedef char bool;
 /**
 ** @brief Defines the value TRUE to use with the boolean type.
 */
-# define TRUE 1;
+# define TRUE 1
 
 /**
 ** @brief Defines the value FALSE to use with the boolean type.
 */
-# define FALSE 0;
-
+# define FALSE 0
 
 /**
 ** @brief This macro will be used to declare structures and headers for the
@@ -98,6 +104,8 @@ typedef char bool;
     unsigned count;                                                           \
     unsigned begin;                                                           \
     unsigned array_size;                                                      \
+    struct ds_snapshot* snapshot;                                             \
+    DS_STATS_MEMBER                                                           \
   } NAME;                                                                     \
                                                                               \
                                                                               \
@@ -115,7 +123,9 @@ typedef char bool;
   QUEUE_POP_HEADER(TYPE, NAME);                                               \
   QUEUE_CLEAR_HEADER(TYPE, NAME);                                             \
   QUEUE_DELETE_HEADER(TYPE, NAME);                                            \
-  QUEUE_VISIT_HEADER(TYPE, NAME);
+  DS_SNAPSHOT_HEADER(QUEUE, TYPE, NAME)                                       \
+  QUEUE_VISIT_HEADER(TYPE, NAME);                                             \
+  DS_STATS_HEADER(NAME)
 
 
 /**
@@ -136,7 +146,9 @@ typedef char bool;
   QUEUE_POP(TYPE, NAME)                                                       \
   QUEUE_CLEAR(TYPE, NAME)                                                     \
   QUEUE_DELETE(TYPE, NAME)                                                    \
-  QUEUE_VISIT(TYPE, NAME)
+  DS_SNAPSHOT_SOURCE(QUEUE, TYPE, NAME)                                       \
+  QUEUE_VISIT(TYPE, NAME)                                                     \
+  DS_STATS_SOURCE(TYPE, NAME, count, array_size)
 
 
 
@@ -160,6 +172,15 @@ typedef char bool;
   void NAME##_clear(NAME* queue, destructor_func dest)
 
 
+// Snapshots
+
+# define QUEUE_SAVE_HEADER(TYPE, NAME)                                        \
+  bool NAME##_save(NAME* queue, int fd)
+
+# define QUEUE_MAP_HEADER(TYPE, NAME)                                         \
+  NAME* NAME##_map(const char* path, int flags)
+
+
 // Visiting
 
 # define QUEUE_VISIT_HEADER(TYPE, NAME)                                       \
@@ -214,11 +235,12 @@ typedef char bool;
 
 /**
 ** @brief Create and initialize a new Queue. A new array is initialized
-**  with at size and containing element of type TYPE.
+**  with at least size elements of type TYPE (size is rounded up to the
+**  next power of two).
 **
 ** @param TYPE type of the elements that will be stored by the queue
 ** @param NAME name of the queue structure
-** @param size is the size of the initial array-container of the queue
+** @param size is the minimal size of the initial array-container
 **
 ** @return a pointer on the new allocated queue. If an error occured,
 **  a NULL pointer is returned.
@@ -231,10 +253,17 @@ typedef char bool;
     if (!new_queue)                                                           \
       return NULL;                                                            \
                                                                               \
-    new_queue->queue = malloc(sizeof (TYPE) * size);                          \
+    size = queue_round(size);                                                 \
+    if (!size || !(new_queue->queue = malloc(sizeof (TYPE) * size)))          \
+    {                                                                         \
+      free(new_queue);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
     new_queue->count = 0;                                                     \
     new_queue->begin = 0;                                                     \
     new_queue->array_size = size;                                             \
+    new_queue->snapshot = NULL;                                               \
+    DS_STATS_INIT(new_queue);                                                 \
                                                                               \
     return new_queue;                                                         \
   }
@@ -254,15 +283,71 @@ typedef char bool;
   void NAME##_delete(NAME* queue, destructor_func dest)                       \
   {                                                                           \
     NAME##_clear(queue, dest);                                                \
-    free(queue->queue);                                                       \
+    if (queue->snapshot)                                                      \
+      ds_snapshot_unmap(queue->snapshot);                                     \
+    else                                                                      \
+      free(queue->queue);                                                     \
     free(queue);                                                              \
   }
 
 
+/**
+** @brief Write a snapshot of the queue to fd (see snapshot.hxx), from the
+**  front to the back. TYPE must not hold pointers.
+**
+** @return TRUE (1) if all went ok, FALSE (0) if a write failed.
+*/
+# define QUEUE_SAVE(TYPE, NAME)                                               \
+  bool NAME##_save(NAME* queue, int fd)                                       \
+  {                                                                           \
+    unsigned end = queue->begin + queue->count;                               \
+    unsigned first = end < queue->array_size ? end : queue->array_size;       \
+                                                                              \
+    return ds_snapshot_save(fd, sizeof (TYPE), queue->queue + queue->begin,   \
+                            first - queue->begin, queue->queue, end - first); \
+  }
+
+
+/**
+** @brief Create a queue whose array is the snapshot at path, mapped
+**  read-only or copy-on-write (flags are described in snapshot.hxx). The
+**  elements do not wrap around in the mapping, so only the first push
+**  copies them to the heap.
+**
+** @return a pointer on the new queue. If the file could not be mapped or
+**  is not a snapshot of TYPE elements, a NULL pointer is returned.
+*/
+# define QUEUE_MAP(TYPE, NAME)                                                \
+  NAME* NAME##_map(const char* path, int flags)                               \
+  {                                                                           \
+    NAME* new_queue = NULL;                                                   \
+    struct ds_snapshot* snapshot = NULL;                                      \
+    size_t count = 0;                                                         \
+                                                                              \
+    if (!(snapshot = ds_snapshot_map(path, sizeof (TYPE), flags, &count)))    \
+      return NULL;                                                            \
+    if (count > UINT_MAX / 2 + 1 || !(new_queue = malloc(sizeof (NAME))))     \
+    {                                                                         \
+      ds_snapshot_unmap(snapshot);                                            \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    new_queue->queue = (TYPE*)(snapshot + 1);                                 \
+    new_queue->count = count;                                                 \
+    new_queue->begin = 0;                                                     \
+    new_queue->array_size = queue_round(count);                               \
+    new_queue->snapshot = snapshot;                                           \
+    DS_STATS_INIT(new_queue);                                                 \
+                                                                              \
+    return new_queue;                                                         \
+  }
+
+
 /**
 ** @brief Walk through the queue and, if a destructor has been given, call
 **  it on each element. At the end, we reset the count of elements to 0
-**  (queue empty).
+**  (queue empty). The elements are walked as two flat segments : from
+**  begin to the end of the array, then from the start of the array.
 **
 ** @param TYPE type of the elements that will be stored by the queue
 ** @param NAME name of the queue structure
@@ -273,16 +358,27 @@ typedef char bool;
 # define QUEUE_CLEAR(TYPE, NAME)                                              \
   void NAME##_clear(NAME* queue, destructor_func dest)                        \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+    unsigned end = queue->begin + queue->count;                               \
+    unsigned first = end < queue->array_size ? end : queue->array_size;       \
+                                                                              \
     if (dest)                                                                 \
-      for (unsigned i = 0; i < queue->count; i++)                             \
-        dest(queue->queue[(i + queue->begin) % queue->array_size]);           \
+    {                                                                         \
+      for (unsigned i = queue->begin; i < first; i++)                         \
+        dest(queue->queue[i]);                                                \
+      for (unsigned i = 0; i < end - first; i++)                              \
+        dest(queue->queue[i]);                                                \
+    }                                                                         \
     queue->count = 0;                                                         \
     queue->begin = 0;                                                         \
+    DS_STATS_STOP(queue, CLEAR, stats_start);                                 \
   }
 
 
 /**
 ** @brief Visit the queue and call the visitor function on each element.
+**  As in NAME_clear, the two segments of the circular array are walked by
+**  two flat loops, without computing any position.
 **
 ** @param TYPE type of the elements that will be stored by the queue
 ** @param NAME name of the queue structure
@@ -295,8 +391,15 @@ typedef char bool;
 # define QUEUE_VISIT(TYPE, NAME)                                              \
   void NAME##_visit(NAME* queue, visitor_func v, void* data)                  \
   {                                                                           \
-    for (unsigned i = 0; i < queue->count; i++)                               \
-      v(queue->queue[(i + queue->begin) % queue->array_size], data);          \
+    DS_STATS_START(stats_start);                                              \
+    unsigned end = queue->begin + queue->count;                               \
+    unsigned first = end < queue->array_size ? end : queue->array_size;       \
+                                                                              \
+    for (unsigned i = queue->begin; i < first; i++)                           \
+      v(queue->queue[i], data);                                               \
+    for (unsigned i = 0; i < end - first; i++)                                \
+      v(queue->queue[i], data);                                               \
+    DS_STATS_STOP(queue, VISIT, stats_start);                                 \
   }
 
 
@@ -344,6 +447,7 @@ typedef char bool;
 # define QUEUE_FRONT(TYPE, NAME)                                              \
   TYPE NAME##_front(NAME* queue)                                              \
   {                                                                           \
+    DS_STATS_COUNT(queue, ACCESS);                                            \
     return queue->queue[queue->begin];                                        \
   }
 
@@ -360,12 +464,19 @@ typedef char bool;
 # define QUEUE_BACK(TYPE, NAME)                                               \
   TYPE NAME##_back(NAME* queue)                                               \
   {                                                                           \
-    return queue->queue[queue->begin + queue->count - 1];                     \
+    DS_STATS_COUNT(queue, ACCESS);                                            \
+    return queue->queue[(queue->begin + queue->count - 1)                     \
+                        & (queue->array_size - 1)];                           \
   }
 
 
 /**
-** @brief Push a new element at the end of the queue
+** @brief Push a new element at the end of the queue. When the array is
+**  full, its size is doubled with realloc : the elements stored from begin
+**  to the end of the old array do not move, and the ones that wrapped
+**  around (from the start of the array to begin) are copied with a single
+**  memcpy right after them. A queue mapped from a snapshot is first copied
+**  to the heap.
 **
 ** @param TYPE type of the elements that will be stored by the queue
 ** @param NAME name of the queue structure
@@ -375,18 +486,40 @@ typedef char bool;
 # define QUEUE_PUSH(TYPE, NAME)                                               \
   void NAME##_push(NAME* queue, TYPE elt)                                     \
   {                                                                           \
-    if (queue->count >= queue->array_size - 1)                                \
+    DS_STATS_START(stats_start);                                              \
+    TYPE* tmp = NULL;                                                         \
+                                                                              \
+    if ((queue->snapshot || queue->count == queue->array_size)                \
+        && queue->array_size > UINT_MAX / 2)                                  \
+      return;                                                                 \
+    if (queue->snapshot)                                                      \
+    {                                                                         \
+      if (!(tmp = malloc(2 * queue->array_size * sizeof (TYPE))))             \
+        return;                                                               \
+      DS_STATS_REALLOC(queue, queue->count * sizeof (TYPE));                  \
+      memcpy(tmp, queue->queue + queue->begin, queue->count * sizeof (TYPE)); \
+      ds_snapshot_unmap(queue->snapshot);                                     \
+      queue->snapshot = NULL;                                                 \
+      queue->queue = tmp;                                                     \
+      queue->begin = 0;                                                       \
+      queue->array_size *= 2;                                                 \
+    }                                                                         \
+    else if (queue->count == queue->array_size)                               \
     {                                                                         \
-        queue->array_size += queue->array_size / 2;                           \
-        TYPE* tmp = malloc(sizeof (TYPE) * queue->array_size);                \
-        for (unsigned i = 0; i < queue->count; i++)                           \
-          tmp[i] = queue->queue[(i + queue->begin) % queue->array_size];      \
-        queue->begin = 0;                                                     \
-        free(queue->queue);                                                   \
-        queue->queue = tmp;                                                   \
+      if (!(tmp = realloc(queue->queue,                                       \
+                          2 * queue->array_size * sizeof (TYPE))))            \
+        return;                                                               \
+      DS_STATS_REALLOC(queue, (queue->array_size + queue->begin)              \
+                              * sizeof (TYPE));                               \
+      memcpy(tmp + queue->array_size, tmp, queue->begin * sizeof (TYPE));     \
+      queue->queue = tmp;                                                     \
+      queue->array_size *= 2;                                                 \
     }                                                                         \
                                                                               \
-    queue->queue[(queue->begin + queue->count++) % queue->array_size] = elt;  \
+    queue->queue[(queue->begin + queue->count++)                              \
+                 & (queue->array_size - 1)] = elt;                            \
+    DS_STATS_STOP(queue, INSERT, stats_start);                                \
+    DS_STATS_SIZE(queue, queue->count);                                       \
   }
 
 
@@ -402,7 +535,14 @@ typedef char bool;
 # define QUEUE_POP(TYPE, NAME)                                                \
   TYPE NAME##_pop(NAME* queue)                                                \
   {                                                                           \
-    return queue->queue[queue->begin + --queue->count];                       \
+    DS_STATS_START(stats_start);                                              \
+    TYPE elt = queue->queue[queue->begin];                                    \
+                                                                              \
+    queue->begin = (queue->begin + 1) & (queue->array_size - 1);              \
+    queue->count--;                                                           \
+    DS_STATS_STOP(queue, ERASE, stats_start);                                 \
+                                                                              \
+    return elt;                                                               \
   }
 
 
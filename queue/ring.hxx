@@ -0,0 +1,735 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of lock-free ring-buffer queues using X-macros        **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file ring.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  thread-safe queues, based on fixed-capacity ring buffers and C11 atomics.
+**  Two families are available :
+**
+**    - QUEUE_SPSC_HEADER / QUEUE_SPSC_SOURCE : one producer thread and one
+**      consumer thread.
+**    - QUEUE_MPMC_HEADER / QUEUE_MPMC_SOURCE : any number of producer and
+**      consumer threads.
+**
+**  The capacity is always rounded up to a power of two, so that positions
+**  are computed with a mask. The head and tail indices live on their own
+**  cache line, so that producers and consumers do not share a line. No
+**  function ever blocks : when the queue is full (resp. empty), try_push
+**  (resp. try_pop) fails and returns FALSE. Assuming that you used NAME as
+**  the name of the structure and TYPE as the type of the elements, the
+**  names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_ncreate
+**    ~ NAME_delete
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**    ~ NAME_capacity
+**
+**    ~ NAME_try_push
+**    ~ NAME_try_pop
+**    ~ NAME_push_n
+**    ~ NAME_pop_n
+**
+**  NAME_create, NAME_ncreate and NAME_delete are not thread-safe. NAME_size
+**  and NAME_empty only give a snapshot when used concurrently.
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef RING_HXX_
+# define RING_HXX_
+
+# include <stdlib.h>
+# include <string.h>
+# include <stdatomic.h>
+# include "round.hxx"
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Size of a cache line. Indices written by different threads are
+**  aligned on it. Define it before including ring.hxx to change it.
+*/
+# ifndef QUEUE_CACHE_LINE
+#  define QUEUE_CACHE_LINE 64
+# endif
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  single-producer / single-consumer queue. As mentionned in the README,
+**  you should create a header file for your "specialized" structure,
+**  include ring.hxx and call this macro.
+**
+** @param TYPE Is the type of the element that you want to store in this
+**  structure. (e.g : QUEUE_SPSC_HEADER(int, ...))
+**
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro.
+*/
+# define QUEUE_SPSC_HEADER(TYPE, NAME)                                        \
+  typedef struct                                                              \
+  {                                                                           \
+    _Alignas(QUEUE_CACHE_LINE) atomic_uint head;                              \
+    unsigned tail_cache;                                                      \
+    _Alignas(QUEUE_CACHE_LINE) atomic_uint tail;                              \
+    unsigned head_cache;                                                      \
+    _Alignas(QUEUE_CACHE_LINE) TYPE* ring;                                    \
+    unsigned mask;                                                            \
+  } NAME;                                                                     \
+                                                                              \
+  typedef void (*destructor_func)(TYPE);                                      \
+                                                                              \
+  QUEUE_RING_NCREATE_HEADER(TYPE, NAME);                                      \
+  QUEUE_RING_CREATE_HEADER(TYPE, NAME);                                       \
+  QUEUE_RING_DELETE_HEADER(TYPE, NAME);                                       \
+  QUEUE_RING_EMPTY_HEADER(TYPE, NAME);                                        \
+  QUEUE_RING_SIZE_HEADER(TYPE, NAME);                                         \
+  QUEUE_RING_CAPACITY_HEADER(TYPE, NAME);                                     \
+  QUEUE_RING_TRY_PUSH_HEADER(TYPE, NAME);                                     \
+  QUEUE_RING_TRY_POP_HEADER(TYPE, NAME);                                      \
+  QUEUE_RING_PUSH_N_HEADER(TYPE, NAME);                                       \
+  QUEUE_RING_POP_N_HEADER(TYPE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on SPSC queues. Call it with the *same
+**  arguments* as QUEUE_SPSC_HEADER.
+*/
+# define QUEUE_SPSC_SOURCE(TYPE, NAME)                                        \
+  QUEUE_SPSC_NCREATE(TYPE, NAME)                                              \
+  QUEUE_RING_CREATE(TYPE, NAME)                                               \
+  QUEUE_SPSC_DELETE(TYPE, NAME)                                               \
+  QUEUE_RING_EMPTY(TYPE, NAME)                                                \
+  QUEUE_RING_SIZE(TYPE, NAME)                                                 \
+  QUEUE_RING_CAPACITY(TYPE, NAME)                                             \
+  QUEUE_SPSC_TRY_PUSH(TYPE, NAME)                                             \
+  QUEUE_SPSC_TRY_POP(TYPE, NAME)                                              \
+  QUEUE_SPSC_PUSH_N(TYPE, NAME)                                               \
+  QUEUE_SPSC_POP_N(TYPE, NAME)
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  multi-producer / multi-consumer queue. Each slot of the ring carries a
+**  sequence number telling whether it is ready to be written or read for
+**  a given position, so that producers (resp. consumers) only have to
+**  agree on the tail (resp. head) index with a compare-and-swap.
+**
+** @param TYPE Is the type of the element that you want to store in this
+**  structure. (e.g : QUEUE_MPMC_HEADER(int, ...))
+**
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro.
+*/
+# define QUEUE_MPMC_HEADER(TYPE, NAME)                                        \
+  typedef struct                                                              \
+  {                                                                           \
+    atomic_uint seq;                                                          \
+    TYPE        elt;                                                          \
+  } s_cell_##NAME;                                                            \
+                                                                              \
+  typedef struct                                                              \
+  {                                                                           \
+    _Alignas(QUEUE_CACHE_LINE) atomic_uint head;                              \
+    _Alignas(QUEUE_CACHE_LINE) atomic_uint tail;                              \
+    _Alignas(QUEUE_CACHE_LINE) s_cell_##NAME* ring;                           \
+    unsigned mask;                                                            \
+  } NAME;                                                                     \
+                                                                              \
+  typedef void (*destructor_func)(TYPE);                                      \
+                                                                              \
+  QUEUE_RING_NCREATE_HEADER(TYPE, NAME);                                      \
+  QUEUE_RING_CREATE_HEADER(TYPE, NAME);                                       \
+  QUEUE_RING_DELETE_HEADER(TYPE, NAME);                                       \
+  QUEUE_RING_EMPTY_HEADER(TYPE, NAME);                                        \
+  QUEUE_RING_SIZE_HEADER(TYPE, NAME);                                         \
+  QUEUE_RING_CAPACITY_HEADER(TYPE, NAME);                                     \
+  QUEUE_RING_TRY_PUSH_HEADER(TYPE, NAME);                                     \
+  QUEUE_RING_TRY_POP_HEADER(TYPE, NAME);                                      \
+  QUEUE_RING_PUSH_N_HEADER(TYPE, NAME);                                       \
+  QUEUE_RING_POP_N_HEADER(TYPE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on MPMC queues. Call it with the *same
+**  arguments* as QUEUE_MPMC_HEADER.
+*/
+# define QUEUE_MPMC_SOURCE(TYPE, NAME)                                        \
+  QUEUE_MPMC_NCREATE(TYPE, NAME)                                              \
+  QUEUE_RING_CREATE(TYPE, NAME)                                               \
+  QUEUE_MPMC_DELETE(TYPE, NAME)                                               \
+  QUEUE_RING_EMPTY(TYPE, NAME)                                                \
+  QUEUE_RING_SIZE(TYPE, NAME)                                                 \
+  QUEUE_RING_CAPACITY(TYPE, NAME)                                             \
+  QUEUE_MPMC_TRY_PUSH(TYPE, NAME)                                             \
+  QUEUE_MPMC_TRY_POP(TYPE, NAME)                                              \
+  QUEUE_MPMC_PUSH_N(TYPE, NAME)                                               \
+  QUEUE_MPMC_POP_N(TYPE, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define QUEUE_RING_CREATE_HEADER(TYPE, NAME)                                 \
+  NAME* NAME##_create()
+
+# define QUEUE_RING_NCREATE_HEADER(TYPE, NAME)                                \
+  NAME* NAME##_ncreate(unsigned size)
+
+# define QUEUE_RING_DELETE_HEADER(TYPE, NAME)                                 \
+  void NAME##_delete(NAME* queue, destructor_func dest)
+
+
+// Capacity
+
+# define QUEUE_RING_EMPTY_HEADER(TYPE, NAME)                                  \
+  bool NAME##_empty(NAME* queue)
+
+# define QUEUE_RING_SIZE_HEADER(TYPE, NAME)                                   \
+  unsigned NAME##_size(NAME* queue)
+
+# define QUEUE_RING_CAPACITY_HEADER(TYPE, NAME)                               \
+  unsigned NAME##_capacity(NAME* queue)
+
+
+// Modifiers
+
+# define QUEUE_RING_TRY_PUSH_HEADER(TYPE, NAME)                               \
+  bool NAME##_try_push(NAME* queue, TYPE elt)
+
+# define QUEUE_RING_TRY_POP_HEADER(TYPE, NAME)                                \
+  bool NAME##_try_pop(NAME* queue, TYPE* elt)
+
+# define QUEUE_RING_PUSH_N_HEADER(TYPE, NAME)                                 \
+  unsigned NAME##_push_n(NAME* queue, const TYPE* elts, unsigned n)
+
+# define QUEUE_RING_POP_N_HEADER(TYPE, NAME)                                  \
+  unsigned NAME##_pop_n(NAME* queue, TYPE* elts, unsigned n)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Simply call the ncreate function with a default value,
+**  see bellow for more details.
+*/
+# define QUEUE_RING_CREATE(TYPE, NAME)                                        \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    return NAME##_ncreate(42);                                                \
+  }
+
+
+/**
+** @brief Create and initialize a new SPSC queue able to hold at least size
+**  elements (the capacity is rounded up to a power of two).
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param size is the minimal capacity of the queue
+**
+** @return a pointer on the new allocated queue. If an error occured,
+**  a NULL pointer is returned.
+*/
+# define QUEUE_SPSC_NCREATE(TYPE, NAME)                                       \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_queue = aligned_alloc(QUEUE_CACHE_LINE, sizeof (NAME));         \
+    unsigned capacity = queue_round(size);                               \
+                                                                              \
+    if (!new_queue)                                                           \
+      return NULL;                                                            \
+    if (!capacity)                                                            \
+    {                                                                         \
+      free(new_queue);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    if (!(new_queue->ring = malloc(sizeof (TYPE) * capacity)))                \
+    {                                                                         \
+      free(new_queue);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    atomic_init(&new_queue->head, 0);                                         \
+    atomic_init(&new_queue->tail, 0);                                         \
+    new_queue->tail_cache = 0;                                                \
+    new_queue->head_cache = 0;                                                \
+    new_queue->mask = capacity - 1;                                           \
+                                                                              \
+    return new_queue;                                                         \
+  }
+
+
+/**
+** @brief Create and initialize a new MPMC queue able to hold at least size
+**  elements (the capacity is rounded up to a power of two). The sequence
+**  number of each slot is set to its position, meaning "ready to be
+**  written for the first lap".
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param size is the minimal capacity of the queue
+**
+** @return a pointer on the new allocated queue. If an error occured,
+**  a NULL pointer is returned.
+*/
+# define QUEUE_MPMC_NCREATE(TYPE, NAME)                                       \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_queue = aligned_alloc(QUEUE_CACHE_LINE, sizeof (NAME));         \
+    unsigned capacity = queue_round(size);                               \
+                                                                              \
+    if (!new_queue)                                                           \
+      return NULL;                                                            \
+    if (!capacity)                                                            \
+    {                                                                         \
+      free(new_queue);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    if (!(new_queue->ring = malloc(sizeof (s_cell_##NAME) * capacity)))       \
+    {                                                                         \
+      free(new_queue);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    for (unsigned i = 0; i < capacity; i++)                                   \
+      atomic_init(&new_queue->ring[i].seq, i);                                \
+                                                                              \
+    atomic_init(&new_queue->head, 0);                                         \
+    atomic_init(&new_queue->tail, 0);                                         \
+    new_queue->mask = capacity - 1;                                           \
+                                                                              \
+    return new_queue;                                                         \
+  }
+
+
+/**
+** @brief Pop every remaining element, calling the destructor on it if one
+**  is given, then free the queue. No other thread may use the queue.
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param queue The queue to delete
+** @param dest The function pointer to call on each element so as to delete
+**  them if needed (this pointer could be NULL if no freeing is needed).
+*/
+# define QUEUE_SPSC_DELETE(TYPE, NAME)                                        \
+  void NAME##_delete(NAME* queue, destructor_func dest)                       \
+  {                                                                           \
+    TYPE elt;                                                                 \
+                                                                              \
+    if (dest)                                                                 \
+      while (NAME##_try_pop(queue, &elt))                                     \
+        dest(elt);                                                            \
+                                                                              \
+    free(queue->ring);                                                        \
+    free(queue);                                                              \
+  }
+
+# define QUEUE_MPMC_DELETE(TYPE, NAME)                                        \
+  QUEUE_SPSC_DELETE(TYPE, NAME)
+
+
+/**
+** @brief Check if the given queue is empty or not. Only a snapshot if other
+**  threads are using the queue.
+**
+** @return TRUE (1) if the queue is empty (or NULL) and 0 otherwise
+*/
+# define QUEUE_RING_EMPTY(TYPE, NAME)                                         \
+  bool NAME##_empty(NAME* queue)                                              \
+  {                                                                           \
+    return !(queue && NAME##_size(queue));                                    \
+  }
+
+
+/**
+** @brief Return the number of elements in the queue. Only a snapshot if
+**  other threads are using the queue.
+*/
+# define QUEUE_RING_SIZE(TYPE, NAME)                                          \
+  unsigned NAME##_size(NAME* queue)                                           \
+  {                                                                           \
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire); \
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire); \
+                                                                              \
+    return tail - head > queue->mask + 1 ? 0 : tail - head;                   \
+  }
+
+
+/**
+** @brief Return the maximum number of elements the queue can hold.
+*/
+# define QUEUE_RING_CAPACITY(TYPE, NAME)                                      \
+  unsigned NAME##_capacity(NAME* queue)                                       \
+  {                                                                           \
+    return queue->mask + 1;                                                   \
+  }
+
+
+/**
+** @brief Push a new element at the end of the queue. Must only be called by
+**  the producer thread. The head index written by the consumer is only
+**  re-read when the cached copy says that the queue is full.
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param queue the queue
+** @param elt element to push in the queue
+**
+** @return TRUE if the element was pushed, FALSE if the queue was full
+*/
+# define QUEUE_SPSC_TRY_PUSH(TYPE, NAME)                                      \
+  bool NAME##_try_push(NAME* queue, TYPE elt)                                 \
+  {                                                                           \
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed); \
+                                                                              \
+    if (tail - queue->head_cache > queue->mask)                               \
+    {                                                                         \
+      queue->head_cache = atomic_load_explicit(&queue->head,                  \
+                                               memory_order_acquire);         \
+      if (tail - queue->head_cache > queue->mask)                             \
+        return FALSE;                                                         \
+    }                                                                         \
+                                                                              \
+    queue->ring[tail & queue->mask] = elt;                                    \
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);      \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Remove the element at the front of the queue. Must only be called
+**  by the consumer thread.
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param queue the queue
+** @param elt where the front-element is stored
+**
+** @return TRUE if an element was popped, FALSE if the queue was empty
+*/
+# define QUEUE_SPSC_TRY_POP(TYPE, NAME)                                       \
+  bool NAME##_try_pop(NAME* queue, TYPE* elt)                                 \
+  {                                                                           \
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed); \
+                                                                              \
+    if (head == queue->tail_cache)                                            \
+    {                                                                         \
+      queue->tail_cache = atomic_load_explicit(&queue->tail,                  \
+                                               memory_order_acquire);         \
+      if (head == queue->tail_cache)                                          \
+        return FALSE;                                                         \
+    }                                                                         \
+                                                                              \
+    *elt = queue->ring[head & queue->mask];                                   \
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);      \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Push as many elements of elts as possible (at most n), copying
+**  them in at most two memcpy (before and after the end of the ring) and
+**  publishing them with a single store.
+**
+** @return the number of elements pushed
+*/
+# define QUEUE_SPSC_PUSH_N(TYPE, NAME)                                        \
+  unsigned NAME##_push_n(NAME* queue, const TYPE* elts, unsigned n)           \
+  {                                                                           \
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed); \
+    unsigned room = queue->mask + 1 - (tail - queue->head_cache);             \
+    unsigned pos = tail & queue->mask;                                        \
+    unsigned first = 0;                                                       \
+                                                                              \
+    if (room < n)                                                             \
+    {                                                                         \
+      queue->head_cache = atomic_load_explicit(&queue->head,                  \
+                                               memory_order_acquire);         \
+      room = queue->mask + 1 - (tail - queue->head_cache);                    \
+      if (room < n)                                                           \
+        n = room;                                                             \
+    }                                                                         \
+                                                                              \
+    first = queue->mask + 1 - pos < n ? queue->mask + 1 - pos : n;            \
+    memcpy(queue->ring + pos, elts, first * sizeof (TYPE));                   \
+    memcpy(queue->ring, elts + first, (n - first) * sizeof (TYPE));           \
+    atomic_store_explicit(&queue->tail, tail + n, memory_order_release);      \
+                                                                              \
+    return n;                                                                 \
+  }
+
+
+/**
+** @brief Pop as many elements as possible (at most n) into elts, copying
+**  them in at most two memcpy and releasing the slots with a single store.
+**
+** @return the number of elements popped
+*/
+# define QUEUE_SPSC_POP_N(TYPE, NAME)                                         \
+  unsigned NAME##_pop_n(NAME* queue, TYPE* elts, unsigned n)                  \
+  {                                                                           \
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed); \
+    unsigned pos = head & queue->mask;                                        \
+    unsigned first = 0;                                                       \
+                                                                              \
+    if (queue->tail_cache - head < n)                                         \
+    {                                                                         \
+      queue->tail_cache = atomic_load_explicit(&queue->tail,                  \
+                                               memory_order_acquire);         \
+      if (queue->tail_cache - head < n)                                       \
+        n = queue->tail_cache - head;                                         \
+    }                                                                         \
+                                                                              \
+    first = queue->mask + 1 - pos < n ? queue->mask + 1 - pos : n;            \
+    memcpy(elts, queue->ring + pos, first * sizeof (TYPE));                   \
+    memcpy(elts + first, queue->ring, (n - first) * sizeof (TYPE));           \
+    atomic_store_explicit(&queue->head, head + n, memory_order_release);      \
+                                                                              \
+    return n;                                                                 \
+  }
+
+
+/**
+** @brief Push a new element at the end of the queue. The producer first
+**  reserves a position by moving the tail forward with a compare-and-swap,
+**  then writes the slot and publishes it by setting its sequence number to
+**  position + 1.
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param queue the queue
+** @param elt element to push in the queue
+**
+** @return TRUE if the element was pushed, FALSE if the queue was full
+*/
+# define QUEUE_MPMC_TRY_PUSH(TYPE, NAME)                                      \
+  bool NAME##_try_push(NAME* queue, TYPE elt)                                 \
+  {                                                                           \
+    unsigned pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);  \
+    s_cell_##NAME* cell = NULL;                                               \
+    int diff = 0;                                                             \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+      cell = &queue->ring[pos & queue->mask];                                 \
+      diff = atomic_load_explicit(&cell->seq, memory_order_acquire) - pos;    \
+                                                                              \
+      if (diff < 0)                                                           \
+        return FALSE;                                                         \
+      if (!diff && atomic_compare_exchange_weak_explicit(&queue->tail,        \
+                     &pos, pos + 1, memory_order_relaxed,                     \
+                     memory_order_relaxed))                                   \
+        break;                                                                \
+      if (diff)                                                               \
+        pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);       \
+    }                                                                         \
+                                                                              \
+    cell->elt = elt;                                                          \
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);         \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Remove the element at the front of the queue. The slot is given
+**  back to the producers of the next lap by setting its sequence number to
+**  position + capacity.
+**
+** @param TYPE type of the elements that will be stored by the queue
+** @param NAME name of the queue structure
+** @param queue the queue
+** @param elt where the front-element is stored
+**
+** @return TRUE if an element was popped, FALSE if the queue was empty
+*/
+# define QUEUE_MPMC_TRY_POP(TYPE, NAME)                                       \
+  bool NAME##_try_pop(NAME* queue, TYPE* elt)                                 \
+  {                                                                           \
+    unsigned pos = atomic_load_explicit(&queue->head, memory_order_relaxed);  \
+    s_cell_##NAME* cell = NULL;                                               \
+    int diff = 0;                                                             \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+      cell = &queue->ring[pos & queue->mask];                                 \
+      diff = atomic_load_explicit(&cell->seq, memory_order_acquire)           \
+             - (pos + 1);                                                     \
+                                                                              \
+      if (diff < 0)                                                           \
+        return FALSE;                                                         \
+      if (!diff && atomic_compare_exchange_weak_explicit(&queue->head,        \
+                     &pos, pos + 1, memory_order_relaxed,                     \
+                     memory_order_relaxed))                                   \
+        break;                                                                \
+      if (diff)                                                               \
+        pos = atomic_load_explicit(&queue->head, memory_order_relaxed);       \
+    }                                                                         \
+                                                                              \
+    *elt = cell->elt;                                                         \
+    atomic_store_explicit(&cell->seq, pos + queue->mask + 1,                  \
+                          memory_order_release);                              \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Push up to n elements with a single compare-and-swap on the tail :
+**  we count how many consecutive slots are ready for writing from the tail
+**  on, reserve them all at once, then fill and publish them.
+**
+** @return the number of elements pushed
+*/
+# define QUEUE_MPMC_PUSH_N(TYPE, NAME)                                        \
+  unsigned NAME##_push_n(NAME* queue, const TYPE* elts, unsigned n)           \
+  {                                                                           \
+    unsigned pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);  \
+    unsigned count = 0;                                                       \
+    s_cell_##NAME* cell = NULL;                                               \
+    int diff = 0;                                                             \
+                                                                              \
+    if (!n)                                                                   \
+      return 0;                                                               \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+      for (count = 0; count < n; count++)                                     \
+      {                                                                       \
+        cell = &queue->ring[(pos + count) & queue->mask];                     \
+        diff = atomic_load_explicit(&cell->seq, memory_order_acquire)         \
+               - (pos + count);                                               \
+        if (diff)                                                             \
+          break;                                                              \
+      }                                                                       \
+                                                                              \
+      if (!count && diff < 0)                                                 \
+        return 0;                                                             \
+      if (count && atomic_compare_exchange_weak_explicit(&queue->tail,        \
+                     &pos, pos + count, memory_order_relaxed,                 \
+                     memory_order_relaxed))                                   \
+        break;                                                                \
+      if (!count)                                                             \
+        pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);       \
+    }                                                                         \
+                                                                              \
+    for (unsigned i = 0; i < count; i++)                                      \
+    {                                                                         \
+      queue->ring[(pos + i) & queue->mask].elt = elts[i];                     \
+      atomic_store_explicit(&queue->ring[(pos + i) & queue->mask].seq,        \
+                            pos + i + 1, memory_order_release);               \
+    }                                                                         \
+                                                                              \
+    return count;                                                             \
+  }
+
+
+/**
+** @brief Pop up to n elements with a single compare-and-swap on the head,
+**  the same way NAME_push_n does.
+**
+** @return the number of elements popped
+*/
+# define QUEUE_MPMC_POP_N(TYPE, NAME)                                         \
+  unsigned NAME##_pop_n(NAME* queue, TYPE* elts, unsigned n)                  \
+  {                                                                           \
+    unsigned pos = atomic_load_explicit(&queue->head, memory_order_relaxed);  \
+    unsigned count = 0;                                                       \
+    s_cell_##NAME* cell = NULL;                                               \
+    int diff = 0;                                                             \
+                                                                              \
+    if (!n)                                                                   \
+      return 0;                                                               \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+      for (count = 0; count < n; count++)                                     \
+      {                                                                       \
+        cell = &queue->ring[(pos + count) & queue->mask];                     \
+        diff = atomic_load_explicit(&cell->seq, memory_order_acquire)         \
+               - (pos + count + 1);                                           \
+        if (diff)                                                             \
+          break;                                                              \
+      }                                                                       \
+                                                                              \
+      if (!count && diff < 0)                                                 \
+        return 0;                                                             \
+      if (count && atomic_compare_exchange_weak_explicit(&queue->head,        \
+                     &pos, pos + count, memory_order_relaxed,                 \
+                     memory_order_relaxed))                                   \
+        break;                                                                \
+      if (!count)                                                             \
+        pos = atomic_load_explicit(&queue->head, memory_order_relaxed);       \
+    }                                                                         \
+                                                                              \
+    for (unsigned i = 0; i < count; i++)                                      \
+    {                                                                         \
+      elts[i] = queue->ring[(pos + i) & queue->mask].elt;                     \
+      atomic_store_explicit(&queue->ring[(pos + i) & queue->mask].seq,        \
+                            pos + i + queue->mask + 1, memory_order_release); \
+    }                                                                         \
+                                                                              \
+    return count;                                                             \
+  }
+
+
+#endif /* !RING_HXX_ */
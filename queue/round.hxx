@@ -0,0 +1,66 @@
+/******************************************************************************
+**                                                                           **
+**    Capacity policy shared by the queues                                   **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file round.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains the capacity policy shared by the queues of
+**  queue.hxx, the rings of ring.hxx and the power_of_two_growth policy of
+**  the C++ containers (cxx/memory.hpp) : their arrays have a power of two
+**  size, so that a position wraps around with a mask. In C++, queue_round
+**  is constexpr, so that it can give the capacity of a policy at compile
+**  time.
+*/
+
+
+#ifndef ROUND_HXX_
+# define ROUND_HXX_
+
+# include <limits.h>
+
+# ifdef __cplusplus
+#  define QUEUE_ROUND_INLINE static constexpr
+# else
+#  define QUEUE_ROUND_INLINE static inline
+# endif
+
+/**
+** @brief Round size up to the next power of two (at least 2).
+**
+** @return the rounded size, or 0 if it does not fit in an unsigned.
+*/
+QUEUE_ROUND_INLINE unsigned queue_round(unsigned size)
+{
+  unsigned capacity = 2;
+
+  if (size > UINT_MAX / 2 + 1)
+    return 0;
+  while (capacity < size)
+    capacity <<= 1;
+
+  return capacity;
+}
+
+
+#endif /* !ROUND_HXX_ */
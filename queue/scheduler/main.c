@@ -0,0 +1,150 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the work-stealing deques                            **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "scheduler.h"
+
+/// @brief Below this argument, fib is computed sequentially. The smaller
+//  it is, the more (and the smaller) tasks the schedulers have to handle.
+static unsigned cutoff = 12;
+
+
+/// @brief A fib(n) task : run computes result.
+struct fib
+{
+  struct task   task;
+  unsigned      n;
+  unsigned long result;
+};
+
+
+static unsigned long
+fib_seq(unsigned n)
+{
+  return n < 2 ? n : fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+
+/// @brief The recursive workload : fib(n - 1) is spawned, fib(n - 2) is
+//  computed by the current worker, which then waits for fib(n - 1).
+static void
+fib_run(struct task* task, struct worker* worker)
+{
+  struct fib* fib = (struct fib*)task;
+  struct fib left = { { fib_run, 0 }, fib->n - 1, 0 };
+  struct fib right = { { fib_run, 0 }, fib->n - 2, 0 };
+
+  if (fib->n < cutoff)
+  {
+    fib->result = fib_seq(fib->n);
+    return;
+  }
+
+  sched_spawn(worker, &left.task);
+  fib_run(&right.task, worker);
+  sched_sync(worker, &left.task);
+
+  fib->result = left.result + right.result;
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+/// @brief Compute fib(n) on a scheduler of threads workers.
+//
+//  @return the elapsed seconds, or -1 if the scheduler could not be
+//  created or if the result is wrong.
+static double
+bench(unsigned n, unsigned threads, bool central, unsigned long expected)
+{
+  struct sched* sched = sched_create(threads, central);
+  struct fib root = { { fib_run, 0 }, n, 0 };
+  double t = 0;
+
+  if (!sched)
+    return -1;
+
+  t = now();
+  sched_run(sched, &root.task);
+  t = now() - t;
+
+  sched_delete(sched);
+  return root.result == expected ? t : -1;
+}
+
+
+/// @brief Main function to benchmark the scaling of fib(n) on 1, 2, 4...
+//  threads, up to the number of online processors, with work stealing and
+//  with the central stack.
+//  Usage : ./bench [n [cutoff]]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned n = 34;
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned long expected = 0;
+  double base = 0;
+  double ws = 0;
+  double central = 0;
+
+  if (argc > 1)
+    n = strtoul(argv[1], NULL, 10);
+  if (argc > 2)
+    cutoff = strtoul(argv[2], NULL, 10);
+  if (cutoff < 2)
+    cutoff = 2;
+
+  base = now();
+  expected = fib_seq(n);
+  base = now() - base;
+
+  printf("\033[33m > fib(%u), tasks below %u computed sequentially, "
+         "sequential time %.1f ms\033[37m :\n\n", n, cutoff, base * 1e3);
+  printf("%8s   %10s %8s   %10s %8s\n", "threads", "stealing", "speedup",
+         "central", "speedup");
+
+  for (unsigned threads = 1; threads <= online || threads == 1; threads *= 2)
+  {
+    ws = bench(n, threads, FALSE, expected);
+    central = bench(n, threads, TRUE, expected);
+    if (ws < 0 || central < 0)
+    {
+      printf("%8u   failed\n", threads);
+      return 1;
+    }
+    printf("%8u   %8.1fms %8.2f   %8.1fms %8.2f\n", threads, ws * 1e3,
+           base / ws, central * 1e3, base / central);
+    fflush(stdout);
+  }
+
+  return 0;
+}
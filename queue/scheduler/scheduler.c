@@ -0,0 +1,236 @@
+/******************************************************************************
+**                                                                           **
+**    Fork-join scheduler on work-stealing deques                            **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+/// @brief A small fork-join scheduler. Each worker pushes the tasks it
+//  spawns at the bottom of its own deque, and runs them back in LIFO
+//  order, as a sequential program would. A worker with nothing to do
+//  steals the top of the deque of another worker, picked at random : the
+//  oldest task, which is usually the biggest one. Only thieves touch the
+//  top, so the owners almost never contend with each other.
+//
+//  sched_sync does not block : while the awaited task is not done (it has
+//  been stolen), the worker runs other tasks, its own ones first.
+//
+//  The central scheduler is the baseline : the same code, with one stack
+//  shared by all the workers and protected by a mutex. It is a stack and
+//  not a queue.hxx FIFO because a helping sync that always takes the oldest
+//  task nests an unbounded number of frames on the worker stack.
+
+#include <sched.h>
+#include "scheduler.h"
+
+WSDEQUE_SOURCE(struct task*, task_deque)
+STACK_SOURCE(struct task*, task_stack)
+
+
+/// @brief Run task, then publish its result with done (release).
+static void
+execute(struct worker* worker, struct task* task)
+{
+  task->run(task, worker);
+  atomic_store_explicit(&task->done, 1, memory_order_release);
+}
+
+
+/// @brief Xorshift, to pick the victims.
+static unsigned
+next_victim(struct worker* worker)
+{
+  worker->seed ^= worker->seed << 13;
+  worker->seed ^= worker->seed >> 17;
+  worker->seed ^= worker->seed << 5;
+
+  return worker->seed % worker->sched->threads;
+}
+
+
+/// @brief Find a task to run : the last one pushed on the deque of the
+//  worker, or else one stolen from the others (threads random tries).
+//
+//  @return the task, or NULL if none was found.
+static struct task*
+find(struct worker* worker)
+{
+  struct sched* sched = worker->sched;
+  struct task* task = NULL;
+
+  if (sched->central)
+  {
+    pthread_mutex_lock(&sched->lock);
+    if (!task_stack_empty(sched->stack))
+      task = task_stack_pop(sched->stack);
+    pthread_mutex_unlock(&sched->lock);
+    return task;
+  }
+
+  if (task_deque_pop(worker->deque, &task))
+    return task;
+
+  for (unsigned i = 0; i < sched->threads; i++)
+  {
+    unsigned victim = next_victim(worker);
+
+    if (victim != worker->index
+        && task_deque_steal(sched->workers[victim].deque, &task))
+      return task;
+  }
+
+  return NULL;
+}
+
+
+/// @brief Main loop of the workers 1 to n - 1 : run whatever can be found,
+//  until the scheduler is deleted.
+static void*
+worker_main(void* arg)
+{
+  struct worker* worker = arg;
+  struct task* task = NULL;
+
+  while (!atomic_load_explicit(&worker->sched->stop, memory_order_relaxed))
+    if ((task = find(worker)))
+      execute(worker, task);
+    else
+      sched_yield();
+
+  return NULL;
+}
+
+
+/// @brief Create a scheduler of threads workers (the calling thread is
+//  worker 0, it runs the root task in sched_run).
+//
+//  @return the scheduler, or NULL if something could not be allocated.
+struct sched*
+sched_create(unsigned threads, bool central)
+{
+  struct sched* sched = NULL;
+  unsigned i = 0;
+
+  if (!threads || !(sched = malloc(sizeof (struct sched))))
+    return NULL;
+
+  sched->threads = threads;
+  sched->central = central;
+  atomic_init(&sched->stop, 0);
+  pthread_mutex_init(&sched->lock, NULL);
+  sched->stack = task_stack_create();
+  sched->workers = aligned_alloc(WSDEQUE_CACHE_LINE,
+                                 threads * sizeof (struct worker));
+  if (!sched->stack || !sched->workers)
+    goto error;
+
+  for (; i < threads; i++)
+  {
+    sched->workers[i].sched = sched;
+    sched->workers[i].index = i;
+    sched->workers[i].seed = 2654435761u * (i + 1);
+    if (!(sched->workers[i].deque = task_deque_create()))
+      goto error;
+  }
+
+  for (i = 1; i < threads; i++)
+    if (pthread_create(&sched->workers[i].thread, NULL, worker_main,
+                       &sched->workers[i]))
+    {
+      atomic_store(&sched->stop, 1);
+      while (--i)
+        pthread_join(sched->workers[i].thread, NULL);
+      i = threads;
+      goto error;
+    }
+
+  return sched;
+
+error:
+  while (i--)
+    task_deque_delete(sched->workers[i].deque, NULL);
+  free(sched->workers);
+  if (sched->stack)
+    task_stack_delete(sched->stack, NULL);
+  pthread_mutex_destroy(&sched->lock);
+  free(sched);
+  return NULL;
+}
+
+
+/// @brief Stop the workers and free the scheduler.
+void
+sched_delete(struct sched* sched)
+{
+  atomic_store(&sched->stop, 1);
+  for (unsigned i = 1; i < sched->threads; i++)
+    pthread_join(sched->workers[i].thread, NULL);
+
+  for (unsigned i = 0; i < sched->threads; i++)
+    task_deque_delete(sched->workers[i].deque, NULL);
+  free(sched->workers);
+  task_stack_delete(sched->stack, NULL);
+  pthread_mutex_destroy(&sched->lock);
+  free(sched);
+}
+
+
+/// @brief Run root, and all the tasks it spawns, on the calling thread and
+//  the workers of the scheduler.
+void
+sched_run(struct sched* sched, struct task* root)
+{
+  atomic_init(&root->done, 0);
+  execute(&sched->workers[0], root);
+}
+
+
+/// @brief Make task available to the other workers. If it cannot be
+//  pushed, it is run at once.
+void
+sched_spawn(struct worker* worker, struct task* task)
+{
+  struct sched* sched = worker->sched;
+  bool pushed = FALSE;
+
+  atomic_init(&task->done, 0);
+  if (sched->central)
+  {
+    pthread_mutex_lock(&sched->lock);
+    task_stack_push(sched->stack, task);
+    pushed = task_stack_size(sched->stack)
+             && task_stack_top(sched->stack) == task;
+    pthread_mutex_unlock(&sched->lock);
+  }
+  else
+    pushed = task_deque_push(worker->deque, task);
+
+  if (!pushed)
+    execute(worker, task);
+}
+
+
+/// @brief Wait until task is done, running other tasks meanwhile.
+void
+sched_sync(struct worker* worker, struct task* task)
+{
+  struct task* other = NULL;
+
+  while (!atomic_load_explicit(&task->done, memory_order_acquire))
+    if ((other = find(worker)))
+      execute(worker, other);
+    else
+      sched_yield();
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+**                                                                           **
+**    Fork-join scheduler on work-stealing deques                            **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef SCHEDULER_H_
+# define SCHEDULER_H_
+
+# include <pthread.h>
+# include "../wsdeque.hxx"
+# include "../../stack/stack.hxx"
+
+/// @brief A task : run is called once, on any worker, then done is set. A
+//  task is usually the first member of a bigger structure that holds its
+//  arguments and its result, and lives in the frame of the task that
+//  spawned it (which waits for it in sched_sync before returning).
+struct task;
+struct worker;
+
+struct task
+{
+  void          (*run)(struct task* task, struct worker* worker);
+  atomic_int    done;
+};
+
+/// @brief The deque of each worker, and the single shared stack (protected
+//  by a mutex) of the central scheduler used as a baseline.
+WSDEQUE_HEADER(struct task*, task_deque)
+STACK_HEADER(struct task*, task_stack)
+
+/// @brief A worker : a thread, and the deque where it pushes the tasks it
+//  spawns. Each one takes a cache line.
+struct worker
+{
+  _Alignas(WSDEQUE_CACHE_LINE) struct sched* sched;
+  task_deque*   deque;
+  pthread_t     thread;
+  unsigned      index;
+  unsigned      seed;
+};
+
+/// @brief The scheduler. With central set, all the workers share one
+//  stack of tasks behind a mutex instead of stealing from each other.
+struct sched
+{
+  struct worker*        workers;
+  unsigned              threads;
+  atomic_int            stop;
+  bool                  central;
+  pthread_mutex_t       lock;
+  task_stack*           stack;
+};
+
+struct sched* sched_create(unsigned threads, bool central);
+void sched_delete(struct sched* sched);
+void sched_run(struct sched* sched, struct task* root);
+void sched_spawn(struct worker* worker, struct task* task);
+void sched_sync(struct worker* worker, struct task* task);
+
+#endif /* !SCHEDULER_H_ */
@@ -0,0 +1,470 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of work-stealing deques using X-macros                **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file wsdeque.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  work-stealing deques (Chase and Lev, "Dynamic circular work-stealing
+**  deque", with the C11 memory orders of Le et al.). A deque belongs to one
+**  thread, its owner, which pushes and pops elements at the bottom, as on
+**  a stack. Any other thread can steal the element at the top, the oldest
+**  one, without lock. This is the queue of each worker of a task scheduler:
+**  a worker takes its own tasks in LIFO order, and the idle ones steal the
+**  oldest (and generally biggest) ones from the others.
+**
+**  As in queue.hxx and ring.hxx, the elements are stored in a circular
+**  array whose size is a power of two, at position index & mask. The top
+**  and bottom indices only grow, and each lives on its own cache line.
+**  When the array is full, the owner copies the elements to an array twice
+**  as large and publishes it : thieves still reading the old array are
+**  not blocked, and old arrays are kept until NAME_delete (they take less
+**  memory than the current one).
+**
+**  Slots are _Atomic(TYPE) : TYPE should be a pointer or an integer, for
+**  which atomic loads and stores are plain moves. Assuming that you used
+**  NAME as the name of the structure and TYPE as the type of the elements,
+**  the names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_ncreate
+**    ~ NAME_delete
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**
+**    ~ NAME_push   (owner only)
+**    ~ NAME_pop    (owner only)
+**    ~ NAME_steal  (any thread)
+**
+**  NAME_create, NAME_ncreate and NAME_delete are not thread-safe. NAME_size
+**  and NAME_empty only give a snapshot when used concurrently.
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef WSDEQUE_HXX_
+# define WSDEQUE_HXX_
+
+# include <stdlib.h>
+# include <stdatomic.h>
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Size of a cache line. The indices written by the owner and by the
+**  thieves are aligned on it. Define it before including wsdeque.hxx to
+**  change it.
+*/
+# ifndef WSDEQUE_CACHE_LINE
+#  define WSDEQUE_CACHE_LINE 64
+# endif
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  work-stealing deque. As mentionned in the README, you should create a
+**  header file for your "specialized" structure, include wsdeque.hxx and
+**  call this macro.
+**
+** @param TYPE Is the type of the element that you want to store in this
+**  structure, usually a pointer on a task. (e.g : WSDEQUE_HEADER(task*, ...))
+**
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro.
+*/
+# define WSDEQUE_HEADER(TYPE, NAME)                                           \
+  typedef struct s_wsarray_##NAME s_wsarray_##NAME;                           \
+                                                                              \
+  struct s_wsarray_##NAME                                                     \
+  {                                                                           \
+    s_wsarray_##NAME* previous;                                               \
+    long long mask;                                                           \
+    _Atomic(TYPE) elts[];                                                     \
+  };                                                                          \
+                                                                              \
+  typedef struct                                                              \
+  {                                                                           \
+    _Alignas(WSDEQUE_CACHE_LINE) atomic_llong top;                            \
+    _Alignas(WSDEQUE_CACHE_LINE) atomic_llong bottom;                         \
+    _Alignas(WSDEQUE_CACHE_LINE) _Atomic(s_wsarray_##NAME*) array;            \
+  } NAME;                                                                     \
+                                                                              \
+  typedef void (*destructor_func)(TYPE);                                      \
+                                                                              \
+  WSDEQUE_CREATE_HEADER(TYPE, NAME);                                          \
+  WSDEQUE_NCREATE_HEADER(TYPE, NAME);                                         \
+  WSDEQUE_DELETE_HEADER(TYPE, NAME);                                          \
+  WSDEQUE_EMPTY_HEADER(TYPE, NAME);                                           \
+  WSDEQUE_SIZE_HEADER(TYPE, NAME);                                            \
+  WSDEQUE_PUSH_HEADER(TYPE, NAME);                                            \
+  WSDEQUE_POP_HEADER(TYPE, NAME);                                             \
+  WSDEQUE_STEAL_HEADER(TYPE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on work-stealing deques. Call it with
+**  the *same arguments* as WSDEQUE_HEADER.
+*/
+# define WSDEQUE_SOURCE(TYPE, NAME)                                           \
+  WSDEQUE_ARRAY(TYPE, NAME)                                                   \
+  WSDEQUE_CREATE(TYPE, NAME)                                                  \
+  WSDEQUE_NCREATE(TYPE, NAME)                                                 \
+  WSDEQUE_DELETE(TYPE, NAME)                                                  \
+  WSDEQUE_EMPTY(TYPE, NAME)                                                   \
+  WSDEQUE_SIZE(TYPE, NAME)                                                    \
+  WSDEQUE_GROW(TYPE, NAME)                                                    \
+  WSDEQUE_PUSH(TYPE, NAME)                                                    \
+  WSDEQUE_POP(TYPE, NAME)                                                     \
+  WSDEQUE_STEAL(TYPE, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define WSDEQUE_CREATE_HEADER(TYPE, NAME)                                    \
+  NAME* NAME##_create()
+
+# define WSDEQUE_NCREATE_HEADER(TYPE, NAME)                                   \
+  NAME* NAME##_ncreate(unsigned size)
+
+# define WSDEQUE_DELETE_HEADER(TYPE, NAME)                                    \
+  void NAME##_delete(NAME* deque, destructor_func dest)
+
+
+// Capacity
+
+# define WSDEQUE_EMPTY_HEADER(TYPE, NAME)                                     \
+  bool NAME##_empty(NAME* deque)
+
+# define WSDEQUE_SIZE_HEADER(TYPE, NAME)                                      \
+  unsigned NAME##_size(NAME* deque)
+
+
+// Modifiers
+
+# define WSDEQUE_PUSH_HEADER(TYPE, NAME)                                      \
+  bool NAME##_push(NAME* deque, TYPE elt)
+
+# define WSDEQUE_POP_HEADER(TYPE, NAME)                                       \
+  bool NAME##_pop(NAME* deque, TYPE* elt)
+
+# define WSDEQUE_STEAL_HEADER(TYPE, NAME)                                     \
+  bool NAME##_steal(NAME* deque, TYPE* elt)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Allocate an array of size elements (a power of two), which will be
+**  freed after previous.
+*/
+# define WSDEQUE_ARRAY(TYPE, NAME)                                            \
+  static s_wsarray_##NAME* NAME##_array(long long size,                       \
+                                        s_wsarray_##NAME* previous)           \
+  {                                                                           \
+    s_wsarray_##NAME* array = NULL;                                           \
+                                                                              \
+    if (!(array = malloc(sizeof (s_wsarray_##NAME)                            \
+                         + size * sizeof (_Atomic(TYPE)))))                   \
+      return NULL;                                                            \
+                                                                              \
+    array->previous = previous;                                               \
+    array->mask = size - 1;                                                   \
+                                                                              \
+    return array;                                                             \
+  }
+
+
+/**
+** @brief Simply call the ncreate function with a default value,
+**  see bellow for more details.
+*/
+# define WSDEQUE_CREATE(TYPE, NAME)                                           \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    return NAME##_ncreate(42);                                                \
+  }
+
+
+/**
+** @brief Create and initialize a new deque, with an array of at least size
+**  elements (rounded up to a power of two).
+**
+** @return a pointer on the new allocated deque. If an error occured,
+**  a NULL pointer is returned.
+*/
+# define WSDEQUE_NCREATE(TYPE, NAME)                                          \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_deque = aligned_alloc(WSDEQUE_CACHE_LINE, sizeof (NAME));       \
+    s_wsarray_##NAME* array = NULL;                                           \
+    long long capacity = 2;                                                   \
+                                                                              \
+    while (capacity < size)                                                   \
+      capacity <<= 1;                                                         \
+                                                                              \
+    if (!new_deque)                                                           \
+      return NULL;                                                            \
+                                                                              \
+    if (!(array = NAME##_array(capacity, NULL)))                              \
+    {                                                                         \
+      free(new_deque);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    atomic_init(&new_deque->top, 0);                                          \
+    atomic_init(&new_deque->bottom, 0);                                       \
+    atomic_init(&new_deque->array, array);                                    \
+                                                                              \
+    return new_deque;                                                         \
+  }
+
+
+/**
+** @brief Call the destructor on each element left in the deque (if dest is
+**  not NULL), from the top to the bottom, then free the arrays and the
+**  deque.
+*/
+# define WSDEQUE_DELETE(TYPE, NAME)                                           \
+  void NAME##_delete(NAME* deque, destructor_func dest)                       \
+  {                                                                           \
+    s_wsarray_##NAME* array = atomic_load(&deque->array);                     \
+    s_wsarray_##NAME* previous = NULL;                                        \
+    long long bottom = atomic_load(&deque->bottom);                           \
+                                                                              \
+    if (dest)                                                                 \
+      for (long long i = atomic_load(&deque->top); i < bottom; i++)           \
+        dest(atomic_load_explicit(&array->elts[i & array->mask],              \
+                                  memory_order_relaxed));                     \
+                                                                              \
+    for (; array; array = previous)                                           \
+    {                                                                         \
+      previous = array->previous;                                             \
+      free(array);                                                            \
+    }                                                                         \
+    free(deque);                                                              \
+  }
+
+
+/**
+** @brief Check if the deque is empty.
+**
+** @return TRUE (1) if the deque is empty, FALSE (0) otherwise.
+*/
+# define WSDEQUE_EMPTY(TYPE, NAME)                                            \
+  bool NAME##_empty(NAME* deque)                                              \
+  {                                                                           \
+    return NAME##_size(deque) == 0;                                           \
+  }
+
+
+/**
+** @brief Return the number of elements in the deque.
+*/
+# define WSDEQUE_SIZE(TYPE, NAME)                                             \
+  unsigned NAME##_size(NAME* deque)                                           \
+  {                                                                           \
+    long long bottom = atomic_load_explicit(&deque->bottom,                   \
+                                            memory_order_relaxed);            \
+    long long top = atomic_load_explicit(&deque->top, memory_order_relaxed);  \
+                                                                              \
+    return bottom > top ? bottom - top : 0;                                   \
+  }
+
+
+/**
+** @brief Copy the elements from top to bottom to an array twice as large,
+**  at the same indices, and publish it. Called by the owner only, when the
+**  array is full : thieves that loaded the old array still read the same
+**  elements in it, so they never wait for the copy.
+**
+** @return the new array, or NULL if the allocation failed.
+*/
+# define WSDEQUE_GROW(TYPE, NAME)                                             \
+  static s_wsarray_##NAME* NAME##_grow(NAME* deque, s_wsarray_##NAME* array,  \
+                                       long long top, long long bottom)       \
+  {                                                                           \
+    s_wsarray_##NAME* new_array = NULL;                                       \
+                                                                              \
+    if (!(new_array = NAME##_array(2 * (array->mask + 1), array)))            \
+      return NULL;                                                            \
+                                                                              \
+    for (long long i = top; i < bottom; i++)                                  \
+    {                                                                         \
+      TYPE elt = atomic_load_explicit(&array->elts[i & array->mask],          \
+                                      memory_order_relaxed);                  \
+                                                                              \
+      atomic_store_explicit(&new_array->elts[i & new_array->mask], elt,       \
+                            memory_order_relaxed);                            \
+    }                                                                         \
+    atomic_store_explicit(&deque->array, new_array, memory_order_release);    \
+                                                                              \
+    return new_array;                                                         \
+  }
+
+
+/**
+** @brief Push an element at the bottom of the deque. Only the owner of the
+**  deque may call this function. The element is written before bottom is
+**  published (release), so a thief that sees the new bottom sees it too.
+**
+** @return TRUE (1) if all went ok, FALSE (0) if the array was full and
+**  could not grow.
+*/
+# define WSDEQUE_PUSH(TYPE, NAME)                                             \
+  bool NAME##_push(NAME* deque, TYPE elt)                                     \
+  {                                                                           \
+    long long bottom = atomic_load_explicit(&deque->bottom,                   \
+                                            memory_order_relaxed);            \
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);  \
+    s_wsarray_##NAME* array = atomic_load_explicit(&deque->array,             \
+                                                   memory_order_relaxed);     \
+                                                                              \
+    if (bottom - top > array->mask                                            \
+        && !(array = NAME##_grow(deque, array, top, bottom)))                 \
+      return FALSE;                                                           \
+                                                                              \
+    atomic_store_explicit(&array->elts[bottom & array->mask], elt,            \
+                          memory_order_relaxed);                              \
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);  \
+                                                                              \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Pop the element at the bottom of the deque (the last pushed one).
+**  Only the owner of the deque may call this function. bottom is first
+**  decremented to reserve the element, and the full fence orders this
+**  store before the load of top : if a thief has already taken it, top
+**  is seen past bottom. When a single element is left, the owner and the
+**  thieves race for it with a CAS on top.
+**
+** @param elt where the element is written.
+**
+** @return TRUE (1) if an element was popped, FALSE (0) if the deque was
+**  empty.
+*/
+# define WSDEQUE_POP(TYPE, NAME)                                              \
+  bool NAME##_pop(NAME* deque, TYPE* elt)                                     \
+  {                                                                           \
+    long long bottom = atomic_load_explicit(&deque->bottom,                   \
+                                            memory_order_relaxed) - 1;        \
+    s_wsarray_##NAME* array = atomic_load_explicit(&deque->array,             \
+                                                   memory_order_relaxed);     \
+    long long top = 0;                                                        \
+    bool popped = TRUE;                                                       \
+                                                                              \
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);      \
+    atomic_thread_fence(memory_order_seq_cst);                                \
+    top = atomic_load_explicit(&deque->top, memory_order_relaxed);            \
+                                                                              \
+    if (top > bottom)                                                         \
+    {                                                                         \
+      atomic_store_explicit(&deque->bottom, bottom + 1,                       \
+                            memory_order_relaxed);                            \
+      return FALSE;                                                           \
+    }                                                                         \
+                                                                              \
+    *elt = atomic_load_explicit(&array->elts[bottom & array->mask],           \
+                                memory_order_relaxed);                        \
+    if (top == bottom)                                                        \
+    {                                                                         \
+      popped = atomic_compare_exchange_strong_explicit(&deque->top, &top,     \
+                                                       top + 1,               \
+                                                       memory_order_seq_cst,  \
+                                                       memory_order_relaxed); \
+      atomic_store_explicit(&deque->bottom, bottom + 1,                       \
+                            memory_order_relaxed);                            \
+    }                                                                         \
+                                                                              \
+    return popped;                                                            \
+  }
+
+
+/**
+** @brief Steal the element at the top of the deque (the oldest one). Any
+**  thread may call this function. The element is read before the CAS on
+**  top that claims it, and thrown away if the CAS fails.
+**
+** @param elt where the element is written.
+**
+** @return TRUE (1) if an element was stolen, FALSE (0) if the deque was
+**  empty or if another thread took the element first (try again, or try
+**  another deque).
+*/
+# define WSDEQUE_STEAL(TYPE, NAME)                                            \
+  bool NAME##_steal(NAME* deque, TYPE* elt)                                   \
+  {                                                                           \
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);  \
+    long long bottom = 0;                                                     \
+    s_wsarray_##NAME* array = NULL;                                           \
+    TYPE stolen;                                                              \
+                                                                              \
+    atomic_thread_fence(memory_order_seq_cst);                                \
+    bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);      \
+    if (top >= bottom)                                                        \
+      return FALSE;                                                           \
+                                                                              \
+    array = atomic_load_explicit(&deque->array, memory_order_acquire);        \
+    stolen = atomic_load_explicit(&array->elts[top & array->mask],            \
+                                  memory_order_relaxed);                      \
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,  \
+                                                 memory_order_seq_cst,        \
+                                                 memory_order_relaxed))       \
+      return FALSE;                                                           \
+                                                                              \
+    *elt = stolen;                                                            \
+    return TRUE;                                                              \
+  }
+
+
+#endif /* !WSDEQUE_HXX_ */
@@ -0,0 +1,24 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the skip list data structure                        **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include "list.h"
+
+/// @brief This macro call will be replaced at compile-time by
+//  the definitions of all the functions to work on skip lists.
+SKIPLIST_SOURCE(uint64_t, uint64_t, CMP_U64, slist)
@@ -0,0 +1,32 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the skip list data structure                        **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef LIST_H_
+# define LIST_H_
+
+# include "../skiplist.hxx"
+
+/// @brief Compare unsigned 64 bits keys.
+# define CMP_U64(a, b) (((a) > (b)) - ((a) < (b)))
+
+/// @brief This macro call will be replace at compile-time by
+//  prototypes and struct declarations for the skip list data-structure
+SKIPLIST_HEADER(uint64_t, uint64_t, CMP_U64, slist)
+
+#endif /* !LIST_H_ */
@@ -0,0 +1,226 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the skip list data structure                        **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "list.h"
+#include "tree.h"
+
+/// @brief Number of distinct keys, half of them are in the map at start.
+#define KEYS (1u << 20)
+
+/// @brief Number of operations of each thread.
+#define OPS 1000000
+
+/// @brief Length of the range scans.
+#define SCAN 64
+
+struct run
+{
+  slist*            list;
+  tree*             tree;
+  pthread_rwlock_t* lock;
+  unsigned          update;
+  unsigned          seed;
+  uint64_t          sum;
+};
+
+
+/// @brief Visitor of the range scans : sum the values.
+static void
+list_visitor(uint64_t key, uint64_t value, void* data)
+{
+  *(uint64_t*)data += value;
+}
+
+
+static void
+tree_visitor(uint64_t key, uint64_t value, void* data)
+{
+  *(uint64_t*)data += value;
+}
+
+
+/// @brief xorshift, each thread has its own state.
+static unsigned
+next(unsigned* seed)
+{
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 17;
+  *seed ^= *seed << 5;
+  return *seed;
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+/// @brief Operation mix of a thread : update% of the operations are
+//  inserts and erases (half each), the others are lookups, with one range
+//  scan every ten reads.
+static void*
+list_thread(void* data)
+{
+  struct run* r = data;
+  int tid = slist_join(r->list);
+  uint64_t value = 0;
+  unsigned x = 0;
+  uint64_t k = 0;
+
+  for (unsigned i = 0; i < OPS; i++)
+  {
+    x = next(&r->seed);
+    k = x % KEYS;
+    if (x / KEYS % 100 < r->update)
+    {
+      if (x & (1u << 31))
+        slist_insert(r->list, tid, k, k);
+      else
+        slist_erase(r->list, tid, k, NULL);
+    }
+    else if (!(x / KEYS % 10))
+      slist_visit_range(r->list, tid, k, k + SCAN, list_visitor, &r->sum);
+    else if (slist_find(r->list, tid, k, &value))
+      r->sum += value;
+  }
+
+  slist_leave(r->list, tid);
+  return NULL;
+}
+
+
+static void*
+tree_thread(void* data)
+{
+  struct run* r = data;
+  uint64_t* value = NULL;
+  unsigned x = 0;
+  uint64_t k = 0;
+
+  for (unsigned i = 0; i < OPS; i++)
+  {
+    x = next(&r->seed);
+    k = x % KEYS;
+    if (x / KEYS % 100 < r->update)
+    {
+      pthread_rwlock_wrlock(r->lock);
+      if (x & (1u << 31))
+        tree_insert(r->tree, k, k);
+      else
+        tree_erase(r->tree, k, NULL);
+      pthread_rwlock_unlock(r->lock);
+    }
+    else
+    {
+      pthread_rwlock_rdlock(r->lock);
+      if (!(x / KEYS % 10))
+        tree_visit_range(r->tree, k, k + SCAN, tree_visitor, &r->sum);
+      else if ((value = tree_get(r->tree, k)))
+        r->sum += *value;
+      pthread_rwlock_unlock(r->lock);
+    }
+  }
+
+  return NULL;
+}
+
+
+/// @brief Run n threads on the skip list, then on the locked B+tree, and
+//  print the throughput of both in millions of operations per second.
+static void
+bench(unsigned n, unsigned update)
+{
+  slist* list = slist_create();
+  tree* t = tree_create();
+  pthread_rwlock_t lock;
+  pthread_t threads[n];
+  struct run runs[n];
+  int tid = slist_join(list);
+  double time[2];
+  uint64_t sum = 0;
+
+  pthread_rwlock_init(&lock, NULL);
+  for (uint64_t k = 0; k < KEYS; k += 2)
+  {
+    slist_insert(list, tid, k, k);
+    tree_insert(t, k, k);
+  }
+  slist_leave(list, tid);
+
+  for (unsigned j = 0; j < 2; j++)
+  {
+    time[j] = now();
+    for (unsigned i = 0; i < n; i++)
+    {
+      runs[i] = (struct run){ list, t, &lock, update, 2463534242u + i, 0 };
+      pthread_create(&threads[i], NULL, j ? tree_thread : list_thread,
+                     &runs[i]);
+    }
+    for (unsigned i = 0; i < n; i++)
+    {
+      pthread_join(threads[i], NULL);
+      sum += runs[i].sum;
+    }
+    time[j] = now() - time[j];
+  }
+
+  printf("%8u %12.2f %12.2f\n", n, n * (OPS / 1e6) / time[0],
+         n * (OPS / 1e6) / time[1]);
+  fprintf(stderr, "%lu\r", (unsigned long)sum);
+
+  slist_delete(list, NULL);
+  tree_delete(t, NULL);
+  pthread_rwlock_destroy(&lock);
+}
+
+
+/// @brief Main function to benchmark the skip list against a B+tree behind
+//  a readers-writer lock, from 1 to max threads.
+//  Usage : ./bench [max threads] [update %]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned max = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned update = 10;
+
+  if (argc > 1)
+    max = strtoul(argv[1], NULL, 10);
+  if (argc > 2)
+    update = strtoul(argv[2], NULL, 10);
+
+  printf("\033[33m > Skip list vs B+tree + rwlock, %u%% updates, "
+         "Mops/s\033[37m :\n\n", update);
+  printf("%8s %12s %12s\n", "threads", "skiplist", "btree+lock");
+
+  for (unsigned n = 1; n <= max; n *= 2)
+    bench(n, update);
+
+  return 0;
+}
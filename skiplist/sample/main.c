@@ -0,0 +1,108 @@
+/******************************************************************************
+**                                                                           **
+**    Test code for the skip list data structure                             **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <pthread.h>
+#include "skiplist.h"
+
+/// @brief Each writer inserts the multiples of WRITERS, starting from its
+//  own number.
+#define WRITERS 4
+
+static omap* list = NULL;
+
+
+/// @brief Visitor for an entry of the list. Simply print the key and
+//  the value on stdout, followed by a eol.
+///
+/// @param key The key
+/// @param value The value
+/// @param data Could possibly store data in that pointer
+void
+visitor(int key, int value, void* data)
+{
+  printf("%i : %i\n", key, value);
+}
+
+
+/// @brief Writer thread : insert 100 keys, then erase the even ones.
+void*
+writer(void* data)
+{
+  int tid = omap_join(list);
+
+  for (int k = (long)data; k < 100 * WRITERS; k += WRITERS)
+    omap_insert(list, tid, k, k * k);
+  for (int k = (long)data; k < 100 * WRITERS; k += WRITERS)
+    if (!(k % 2))
+      omap_erase(list, tid, k, NULL);
+
+  omap_leave(list, tid);
+  return NULL;
+}
+
+
+/// @brief Main function to test the skip list structure : several writers
+//  fill the list at the same time, then the main thread reads it.
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(void)
+{
+  pthread_t threads[WRITERS];
+  int tid = 0;
+  int value = 0;
+
+  printf("\033[33m > Starting skip list test\033[37m :\n\n");
+
+  // Creating list
+  printf("[ \033[32mCreating\033[37m list ..\n");
+  list = omap_create();
+  if (!list)
+    return 1;
+  printf("List correctly created ] \n\n");
+
+  printf("Is the list empty ? > %s\n", (omap_empty(list) ? "yes" : "no"));
+  printf("List size : %i\n\n", omap_size(list));
+
+  printf("[ \033[32mFilling\033[37m the list from %i threads ..\n\n",
+         WRITERS);
+  for (long i = 0; i < WRITERS; i++)
+    pthread_create(&threads[i], NULL, writer, (void*)i);
+  for (int i = 0; i < WRITERS; i++)
+    pthread_join(threads[i], NULL);
+
+  printf("Is the list empty ? > %s\n", (omap_empty(list) ? "yes" : "no"));
+  printf("List size : %i\n\n", omap_size(list));
+
+  tid = omap_join(list);
+  if (omap_find(list, tid, 7, &value))
+    printf("Value of \033[32m7\033[37m : %i\n", value);
+  printf("Does the list contain \033[32m8\033[37m ? > %s\n\n",
+         (omap_find(list, tid, 8, NULL) ? "yes" : "no"));
+
+  printf("\033[32mVisiting\033[37m the keys in [10, 30] ..\n");
+  omap_visit_range(list, tid, 10, 30, visitor, NULL);
+  omap_leave(list, tid);
+
+  printf("\n[ \033[32mDeleting\033[37m the list..\n\n");
+  omap_delete(list, NULL);
+
+  return 0;
+}
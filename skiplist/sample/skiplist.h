@@ -0,0 +1,32 @@
+/******************************************************************************
+**                                                                           **
+**    Test code for the skip list data structure                             **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef SKIPLIST_H_
+# define SKIPLIST_H_
+
+# include "../skiplist.hxx"
+
+/// @brief Compare two ints.
+# define CMP_INT(a, b) (((a) > (b)) - ((a) < (b)))
+
+/// @brief This macro call will be replace at compile-time by
+//  prototypes and struct declarations for the skip list data-structure
+SKIPLIST_HEADER(int, int, CMP_INT, omap)
+
+#endif /* !SKIPLIST_H_ */
@@ -0,0 +1,794 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of concurrent skip lists using X-macros               **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file skiplist.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  concurrent ordered maps, based on lock-free skip lists and C11 atomics.
+**  Readers never write to shared memory and never wait : NAME_find and
+**  NAME_visit_range only follow pointers. Writers link and unlink nodes with
+**  compare-and-swap : NAME_erase first marks the links of a node (logical
+**  delete), then the node is unlinked by whichever thread walks past it.
+**
+**  The tower of links of a node is allocated with the node, right after the
+**  key and the value, so that a lookup reads a single line per node visited.
+**
+**  Unlinked nodes are freed with epoch-based reclamation : every thread
+**  using the list first calls NAME_join to get a thread id, which it gives
+**  to each operation. A node unlinked during epoch e is only freed once
+**  every thread inside an operation has seen epoch e + 2, so that no thread
+**  can still be reading it. Assuming that you used NAME as the name of the
+**  structure, the names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_delete
+**
+**    ~ NAME_join
+**    ~ NAME_leave
+**
+**    ~ NAME_visit
+**    ~ NAME_visit_range
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**
+**    ~ NAME_find
+**
+**    ~ NAME_insert
+**    ~ NAME_erase
+**
+**  NAME_create and NAME_delete are not thread-safe. NAME_size and
+**  NAME_empty only give a snapshot when used concurrently.
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef SKIPLIST_HXX_
+# define SKIPLIST_HXX_
+
+# include <stdlib.h>
+# include <stdint.h>
+# include <stdatomic.h>
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Size of a cache line. The epoch of each thread is aligned on it.
+**  Define it before including skiplist.hxx to change it.
+*/
+# ifndef SKIPLIST_CACHE_LINE
+#  define SKIPLIST_CACHE_LINE 64
+# endif
+
+/**
+** @brief Maximum number of threads that can join a list at the same time.
+*/
+# ifndef SKIPLIST_THREADS
+#  define SKIPLIST_THREADS 64
+# endif
+
+/**
+** @brief Maximum height of a tower. Each level holds a quarter of the nodes
+**  of the level bellow, so 16 levels are enough for 2^32 keys.
+*/
+# define SKIPLIST_MAX_LEVEL 16
+
+/**
+** @brief Number of nodes a thread retires between two attempts to move
+**  the global epoch forward.
+*/
+# define SKIPLIST_RETIRE_BATCH 64
+
+/**
+** @brief The lowest bit of a link marks the node that holds it as deleted.
+*/
+# define SKIPLIST_MARKED(LINK) ((LINK) & 1)
+# define SKIPLIST_NODE(NAME, LINK) ((s_node_##NAME*)((LINK) & ~(uintptr_t)1))
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  skip list data structure. As mentionned in the README, you should create
+**  a header file for your "specialized" structure, include skiplist.hxx and
+**  call this macro.
+**
+** @param KEY Is the type of the keys.
+** @param VALUE Is the type of the values.
+** @param CMP Is a function (or a macro) comparing two KEYs, and returning a
+**  negative number, 0 or a positive number (see btree_cmp_int in btree.hxx).
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro. For exemple :
+**
+**    SKIPLIST_HEADER(int, double, CMP_INT, index)
+**
+**  As for hash maps, the visitor and destructor types are named
+**  NAME_visitor_func and NAME_destructor_func.
+*/
+# define SKIPLIST_HEADER(KEY, VALUE, CMP, NAME)                               \
+  typedef struct NAME NAME;                                                   \
+  typedef struct s_node_##NAME s_node_##NAME;                                 \
+  typedef struct s_thread_##NAME s_thread_##NAME;                             \
+                                                                              \
+  typedef void (*NAME##_visitor_func)(KEY, VALUE, void*);                     \
+  typedef void (*NAME##_destructor_func)(KEY, VALUE);                         \
+                                                                              \
+  struct s_node_##NAME                                                        \
+  {                                                                           \
+    KEY                     key;                                              \
+    VALUE                   value;                                            \
+    NAME##_destructor_func  dest;                                             \
+    s_node_##NAME*          garbage;                                          \
+    atomic_uint             refs;                                             \
+    unsigned                level;                                            \
+    atomic_uintptr_t        next[];                                           \
+  };                                                                          \
+                                                                              \
+  struct s_thread_##NAME                                                      \
+  {                                                                           \
+    _Alignas(SKIPLIST_CACHE_LINE) atomic_uint state;                          \
+    atomic_uint             used;                                             \
+    unsigned                seed;                                             \
+    unsigned                retired;                                          \
+    unsigned                epochs[3];                                        \
+    s_node_##NAME*          limbo[3];                                         \
+  };                                                                          \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    s_node_##NAME*          head;                                             \
+    _Alignas(SKIPLIST_CACHE_LINE) atomic_uint epoch;                          \
+    _Alignas(SKIPLIST_CACHE_LINE) atomic_uint count;                          \
+    s_thread_##NAME         threads[SKIPLIST_THREADS];                        \
+  };                                                                          \
+                                                                              \
+  SKIPLIST_CREATE_HEADER(KEY, VALUE, NAME);                                   \
+  SKIPLIST_DELETE_HEADER(KEY, VALUE, NAME);                                   \
+  SKIPLIST_JOIN_HEADER(KEY, VALUE, NAME);                                     \
+  SKIPLIST_LEAVE_HEADER(KEY, VALUE, NAME);                                    \
+  SKIPLIST_VISIT_HEADER(KEY, VALUE, NAME);                                    \
+  SKIPLIST_VISIT_RANGE_HEADER(KEY, VALUE, NAME);                              \
+  SKIPLIST_EMPTY_HEADER(KEY, VALUE, NAME);                                    \
+  SKIPLIST_SIZE_HEADER(KEY, VALUE, NAME);                                     \
+  SKIPLIST_FIND_HEADER(KEY, VALUE, NAME);                                     \
+  SKIPLIST_INSERT_HEADER(KEY, VALUE, NAME);                                   \
+  SKIPLIST_ERASE_HEADER(KEY, VALUE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on skip lists. Call it with the *same
+**  arguments* as SKIPLIST_HEADER.
+*/
+# define SKIPLIST_SOURCE(KEY, VALUE, CMP, NAME)                               \
+  SKIPLIST_EPOCH(KEY, VALUE, NAME)                                            \
+  SKIPLIST_SEARCH(KEY, VALUE, CMP, NAME)                                      \
+  SKIPLIST_CREATE(KEY, VALUE, NAME)                                           \
+  SKIPLIST_DELETE(KEY, VALUE, NAME)                                           \
+  SKIPLIST_JOIN(KEY, VALUE, NAME)                                             \
+  SKIPLIST_LEAVE(KEY, VALUE, NAME)                                            \
+  SKIPLIST_VISIT(KEY, VALUE, NAME)                                            \
+  SKIPLIST_VISIT_RANGE(KEY, VALUE, CMP, NAME)                                 \
+  SKIPLIST_EMPTY(KEY, VALUE, NAME)                                            \
+  SKIPLIST_SIZE(KEY, VALUE, NAME)                                             \
+  SKIPLIST_FIND(KEY, VALUE, CMP, NAME)                                        \
+  SKIPLIST_INSERT(KEY, VALUE, CMP, NAME)                                      \
+  SKIPLIST_ERASE(KEY, VALUE, CMP, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+// Construction / Destruction
+
+# define SKIPLIST_CREATE_HEADER(KEY, VALUE, NAME)                             \
+  NAME* NAME##_create()
+
+# define SKIPLIST_DELETE_HEADER(KEY, VALUE, NAME)                             \
+  void NAME##_delete(NAME* list, NAME##_destructor_func dest)
+
+
+// Threads
+
+# define SKIPLIST_JOIN_HEADER(KEY, VALUE, NAME)                               \
+  int NAME##_join(NAME* list)
+
+# define SKIPLIST_LEAVE_HEADER(KEY, VALUE, NAME)                              \
+  void NAME##_leave(NAME* list, int tid)
+
+
+// Visiting
+
+# define SKIPLIST_VISIT_HEADER(KEY, VALUE, NAME)                              \
+  void NAME##_visit(NAME* list, int tid, NAME##_visitor_func v, void* data)
+
+# define SKIPLIST_VISIT_RANGE_HEADER(KEY, VALUE, NAME)                        \
+  void NAME##_visit_range(NAME* list, int tid, KEY lo, KEY hi,                \
+                          NAME##_visitor_func v, void* data)
+
+
+// Capacity
+
+# define SKIPLIST_EMPTY_HEADER(KEY, VALUE, NAME)                              \
+  bool NAME##_empty(NAME* list)
+
+# define SKIPLIST_SIZE_HEADER(KEY, VALUE, NAME)                               \
+  unsigned NAME##_size(NAME* list)
+
+
+// Lookup
+
+# define SKIPLIST_FIND_HEADER(KEY, VALUE, NAME)                               \
+  bool NAME##_find(NAME* list, int tid, KEY key, VALUE* value)
+
+
+// Modifiers
+
+# define SKIPLIST_INSERT_HEADER(KEY, VALUE, NAME)                             \
+  bool NAME##_insert(NAME* list, int tid, KEY key, VALUE value)
+
+# define SKIPLIST_ERASE_HEADER(KEY, VALUE, NAME)                              \
+  bool NAME##_erase(NAME* list, int tid, KEY key,                             \
+                    NAME##_destructor_func dest)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Epoch-based reclamation. The state of a thread is 0 when it is
+**  outside of any operation, and 2 * epoch + 1 inside, epoch being the
+**  global epoch it saw when entering. Each thread keeps the nodes it
+**  retired in three lists, one per epoch modulo 3. The global epoch only
+**  moves from e to e + 1 once every thread inside an operation has seen e,
+**  so a list retired during e can be freed as soon as the epoch is e + 2.
+*/
+# define SKIPLIST_EPOCH(KEY, VALUE, NAME)                                     \
+  static void NAME##_free_limbo(s_node_##NAME* node)                          \
+  {                                                                           \
+    s_node_##NAME* garbage = NULL;                                            \
+                                                                              \
+    for (; node; node = garbage)                                              \
+    {                                                                         \
+      garbage = node->garbage;                                                \
+      if (node->dest)                                                         \
+        node->dest(node->key, node->value);                                   \
+      free(node);                                                             \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static void NAME##_enter(NAME* list, s_thread_##NAME* self)                 \
+  {                                                                           \
+    unsigned seen = 0;                                                        \
+    unsigned epoch = atomic_load(&list->epoch);                               \
+                                                                              \
+    do                                                                        \
+    {                                                                         \
+      seen = epoch;                                                           \
+      atomic_store(&self->state, 2 * seen + 1);                               \
+      epoch = atomic_load(&list->epoch);                                      \
+    }                                                                         \
+    while (epoch != seen);                                                    \
+                                                                              \
+    for (unsigned i = 0; i < 3; i++)                                          \
+      if (self->limbo[i] && epoch - self->epochs[i] >= 2)                     \
+      {                                                                       \
+        NAME##_free_limbo(self->limbo[i]);                                    \
+        self->limbo[i] = NULL;                                                \
+      }                                                                       \
+  }                                                                           \
+                                                                              \
+  static void NAME##_exit(s_thread_##NAME* self)                              \
+  {                                                                           \
+    atomic_store_explicit(&self->state, 0, memory_order_release);             \
+  }                                                                           \
+                                                                              \
+  static void NAME##_advance(NAME* list)                                      \
+  {                                                                           \
+    unsigned epoch = atomic_load(&list->epoch);                               \
+    unsigned state = 0;                                                       \
+                                                                              \
+    for (unsigned i = 0; i < SKIPLIST_THREADS; i++)                           \
+    {                                                                         \
+      state = atomic_load(&list->threads[i].state);                           \
+      if (state && state != 2 * epoch + 1)                                    \
+        return;                                                               \
+    }                                                                         \
+                                                                              \
+    atomic_compare_exchange_strong(&list->epoch, &epoch, epoch + 1);          \
+  }                                                                           \
+                                                                              \
+  static void NAME##_retire(NAME* list, s_thread_##NAME* self,                \
+                            s_node_##NAME* node)                              \
+  {                                                                           \
+    unsigned epoch = atomic_load(&list->epoch);                               \
+    unsigned i = epoch % 3;                                                   \
+                                                                              \
+    if (self->limbo[i] && self->epochs[i] != epoch)                           \
+    {                                                                         \
+      NAME##_free_limbo(self->limbo[i]);                                      \
+      self->limbo[i] = NULL;                                                  \
+    }                                                                         \
+                                                                              \
+    node->garbage = self->limbo[i];                                           \
+    self->limbo[i] = node;                                                    \
+    self->epochs[i] = epoch;                                                  \
+                                                                              \
+    if (!(++self->retired % SKIPLIST_RETIRE_BATCH))                           \
+      NAME##_advance(list);                                                   \
+  }
+
+
+/**
+** @brief Fill preds / succs with, for each level, the last node whose key
+**  is lower than key and the node that follows it. Marked nodes found on
+**  the way are unlinked ; if one of them can not be, because its
+**  predecessor changed meanwhile, the search starts again from the head.
+**
+** @return TRUE if succs[0] holds key.
+*/
+# define SKIPLIST_SEARCH(KEY, VALUE, CMP, NAME)                               \
+  static bool NAME##_search(NAME* list, KEY key, s_node_##NAME** preds,       \
+                            s_node_##NAME** succs)                            \
+  {                                                                           \
+    s_node_##NAME* pred = NULL;                                               \
+    s_node_##NAME* curr = NULL;                                               \
+    uintptr_t link = 0;                                                       \
+    uintptr_t expected = 0;                                                   \
+                                                                              \
+  retry:                                                                      \
+    pred = list->head;                                                        \
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--)             \
+    {                                                                         \
+      curr = SKIPLIST_NODE(NAME, atomic_load_explicit(&pred->next[level],     \
+                                                      memory_order_acquire)); \
+      while (curr)                                                            \
+      {                                                                       \
+        link = atomic_load_explicit(&curr->next[level],                       \
+                                    memory_order_acquire);                    \
+        if (SKIPLIST_MARKED(link))                                            \
+        {                                                                     \
+          expected = (uintptr_t)curr;                                         \
+          if (!atomic_compare_exchange_strong(&pred->next[level], &expected,  \
+                                              link & ~(uintptr_t)1))          \
+            goto retry;                                                       \
+          curr = SKIPLIST_NODE(NAME, link);                                   \
+          continue;                                                           \
+        }                                                                     \
+        if (CMP(curr->key, key) >= 0)                                         \
+          break;                                                              \
+        pred = curr;                                                          \
+        curr = SKIPLIST_NODE(NAME, link);                                     \
+      }                                                                       \
+      preds[level] = pred;                                                    \
+      succs[level] = curr;                                                    \
+    }                                                                         \
+                                                                              \
+    return curr && !CMP(curr->key, key);                                      \
+  }
+
+
+/**
+** @brief Create a new, empty skip list.
+**
+** @return a pointer on the new allocated list. If an error occured, a NULL
+**  pointer is returned.
+*/
+# define SKIPLIST_CREATE(KEY, VALUE, NAME)                                    \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    NAME* new_list = aligned_alloc(SKIPLIST_CACHE_LINE, sizeof (NAME));       \
+                                                                              \
+    if (!new_list)                                                            \
+      return NULL;                                                            \
+                                                                              \
+    new_list->head = malloc(sizeof (s_node_##NAME) + SKIPLIST_MAX_LEVEL       \
+                            * sizeof (atomic_uintptr_t));                     \
+    if (!new_list->head)                                                      \
+    {                                                                         \
+      free(new_list);                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    new_list->head->level = SKIPLIST_MAX_LEVEL;                               \
+    for (unsigned i = 0; i < SKIPLIST_MAX_LEVEL; i++)                         \
+      atomic_init(&new_list->head->next[i], 0);                               \
+                                                                              \
+    atomic_init(&new_list->epoch, 0);                                         \
+    atomic_init(&new_list->count, 0);                                         \
+    for (unsigned i = 0; i < SKIPLIST_THREADS; i++)                           \
+    {                                                                         \
+      atomic_init(&new_list->threads[i].state, 0);                            \
+      atomic_init(&new_list->threads[i].used, 0);                             \
+      new_list->threads[i].seed = 2463534242u + i;                            \
+      new_list->threads[i].retired = 0;                                       \
+      for (unsigned j = 0; j < 3; j++)                                        \
+      {                                                                       \
+        new_list->threads[i].epochs[j] = 0;                                   \
+        new_list->threads[i].limbo[j] = NULL;                                 \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    return new_list;                                                          \
+  }
+
+
+/**
+** @brief Free every node of the list, including the retired ones, then the
+**  list itself. No other thread may use the list anymore.
+**
+** @param list The list to delete
+** @param dest The function pointer to call on each entry so as to delete
+**  it if needed (this pointer could be NULL if no freeing is needed).
+*/
+# define SKIPLIST_DELETE(KEY, VALUE, NAME)                                    \
+  void NAME##_delete(NAME* list, NAME##_destructor_func dest)                 \
+  {                                                                           \
+    s_node_##NAME* node = SKIPLIST_NODE(NAME, list->head->next[0]);           \
+    s_node_##NAME* next = NULL;                                               \
+                                                                              \
+    for (; node; node = next)                                                 \
+    {                                                                         \
+      next = SKIPLIST_NODE(NAME, node->next[0]);                              \
+      if (dest)                                                               \
+        dest(node->key, node->value);                                         \
+      free(node);                                                             \
+    }                                                                         \
+                                                                              \
+    for (unsigned i = 0; i < SKIPLIST_THREADS; i++)                           \
+      for (unsigned j = 0; j < 3; j++)                                        \
+        NAME##_free_limbo(list->threads[i].limbo[j]);                         \
+                                                                              \
+    free(list->head);                                                         \
+    free(list);                                                               \
+  }
+
+
+/**
+** @brief Reserve a thread id, that the calling thread must give to every
+**  operation on the list.
+**
+** @return the thread id, or -1 if SKIPLIST_THREADS threads already joined.
+*/
+# define SKIPLIST_JOIN(KEY, VALUE, NAME)                                      \
+  int NAME##_join(NAME* list)                                                 \
+  {                                                                           \
+    unsigned expected = 0;                                                    \
+                                                                              \
+    for (int i = 0; i < SKIPLIST_THREADS; i++)                                \
+    {                                                                         \
+      expected = 0;                                                           \
+      if (atomic_compare_exchange_strong(&list->threads[i].used, &expected,   \
+                                         1))                                  \
+        return i;                                                             \
+    }                                                                         \
+                                                                              \
+    return -1;                                                                \
+  }
+
+
+/**
+** @brief Give back a thread id. The nodes retired by the thread stay with
+**  the id, and will be freed by the next thread that joins with it (or by
+**  NAME_delete).
+*/
+# define SKIPLIST_LEAVE(KEY, VALUE, NAME)                                     \
+  void NAME##_leave(NAME* list, int tid)                                      \
+  {                                                                           \
+    atomic_store(&list->threads[tid].used, 0);                                \
+  }
+
+
+/**
+** @brief Call the visitor on each entry of the list, by increasing keys.
+*/
+# define SKIPLIST_VISIT(KEY, VALUE, NAME)                                     \
+  void NAME##_visit(NAME* list, int tid, NAME##_visitor_func v, void* data)   \
+  {                                                                           \
+    s_thread_##NAME* self = &list->threads[tid];                              \
+    s_node_##NAME* node = NULL;                                               \
+    uintptr_t link = 0;                                                       \
+                                                                              \
+    NAME##_enter(list, self);                                                 \
+                                                                              \
+    link = atomic_load_explicit(&list->head->next[0], memory_order_acquire);  \
+    for (node = SKIPLIST_NODE(NAME, link); node;                              \
+         node = SKIPLIST_NODE(NAME, link))                                    \
+    {                                                                         \
+      link = atomic_load_explicit(&node->next[0], memory_order_acquire);      \
+      if (!SKIPLIST_MARKED(link))                                             \
+        v(node->key, node->value, data);                                      \
+    }                                                                         \
+                                                                              \
+    NAME##_exit(self);                                                        \
+  }
+
+
+/**
+** @brief Call the visitor on each entry whose key is in [lo, hi], by
+**  increasing keys. The search for lo goes down the towers without writing
+**  anything ; deleted nodes that are not unlinked yet are skipped.
+*/
+# define SKIPLIST_VISIT_RANGE(KEY, VALUE, CMP, NAME)                          \
+  void NAME##_visit_range(NAME* list, int tid, KEY lo, KEY hi,                \
+                          NAME##_visitor_func v, void* data)                  \
+  {                                                                           \
+    s_thread_##NAME* self = &list->threads[tid];                              \
+    s_node_##NAME* pred = list->head;                                         \
+    s_node_##NAME* node = NULL;                                               \
+    uintptr_t link = 0;                                                       \
+                                                                              \
+    NAME##_enter(list, self);                                                 \
+                                                                              \
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--)             \
+      for (node = SKIPLIST_NODE(NAME, atomic_load_explicit(                   \
+             &pred->next[level], memory_order_acquire));                      \
+           node && CMP(node->key, lo) < 0;                                    \
+           node = SKIPLIST_NODE(NAME, atomic_load_explicit(                   \
+             &node->next[level], memory_order_acquire)))                      \
+        pred = node;                                                          \
+                                                                              \
+    for (; node && CMP(node->key, hi) <= 0;                                   \
+         node = SKIPLIST_NODE(NAME, link))                                    \
+    {                                                                         \
+      link = atomic_load_explicit(&node->next[0], memory_order_acquire);      \
+      if (!SKIPLIST_MARKED(link))                                             \
+        v(node->key, node->value, data);                                      \
+    }                                                                         \
+                                                                              \
+    NAME##_exit(self);                                                        \
+  }
+
+
+/**
+** @return TRUE (1) if the list is empty (or NULL) and 0 otherwise
+*/
+# define SKIPLIST_EMPTY(KEY, VALUE, NAME)                                     \
+  bool NAME##_empty(NAME* list)                                               \
+  {                                                                           \
+    return !(list && atomic_load(&list->count));                              \
+  }
+
+
+/**
+** @return the number of entries in the list
+*/
+# define SKIPLIST_SIZE(KEY, VALUE, NAME)                                      \
+  unsigned NAME##_size(NAME* list)                                            \
+  {                                                                           \
+    return atomic_load(&list->count);                                         \
+  }
+
+
+/**
+** @brief Look key up, without writing to shared memory.
+**
+** @param value If not NULL and key is found, receives a copy of its value
+**  (nodes may be freed once the function returned, so no pointer is given).
+**
+** @return TRUE if key is in the list, FALSE otherwise.
+*/
+# define SKIPLIST_FIND(KEY, VALUE, CMP, NAME)                                 \
+  bool NAME##_find(NAME* list, int tid, KEY key, VALUE* value)                \
+  {                                                                           \
+    s_thread_##NAME* self = &list->threads[tid];                              \
+    s_node_##NAME* pred = list->head;                                         \
+    s_node_##NAME* node = NULL;                                               \
+    bool found = FALSE;                                                       \
+                                                                              \
+    NAME##_enter(list, self);                                                 \
+                                                                              \
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--)             \
+      for (node = SKIPLIST_NODE(NAME, atomic_load_explicit(                   \
+             &pred->next[level], memory_order_acquire));                      \
+           node && CMP(node->key, key) < 0;                                   \
+           node = SKIPLIST_NODE(NAME, atomic_load_explicit(                   \
+             &node->next[level], memory_order_acquire)))                      \
+        pred = node;                                                          \
+                                                                              \
+    if (node && !CMP(node->key, key)                                          \
+        && !SKIPLIST_MARKED(atomic_load_explicit(&node->next[0],              \
+                                                 memory_order_acquire)))      \
+    {                                                                         \
+      found = TRUE;                                                           \
+      if (value)                                                              \
+        *value = node->value;                                                 \
+    }                                                                         \
+                                                                              \
+    NAME##_exit(self);                                                        \
+    return found;                                                             \
+  }
+
+
+/**
+** @brief Insert key with value if key is not in the list yet. The node is
+**  published by linking it at level 0, then it is linked level by level up
+**  its tower, unless it is erased meanwhile. The node holds two references,
+**  one for the list and one for the inserter while it links the upper
+**  levels : an eraser may unlink it during that time, and only the last of
+**  the two to be done retires it.
+**
+** @return TRUE if key was inserted, FALSE if it was already in the list (or
+**  if an allocation failed).
+*/
+# define SKIPLIST_INSERT(KEY, VALUE, CMP, NAME)                               \
+  bool NAME##_insert(NAME* list, int tid, KEY key, VALUE value)               \
+  {                                                                           \
+    s_thread_##NAME* self = &list->threads[tid];                              \
+    s_node_##NAME* preds[SKIPLIST_MAX_LEVEL];                                 \
+    s_node_##NAME* succs[SKIPLIST_MAX_LEVEL];                                 \
+    s_node_##NAME* node = NULL;                                               \
+    uintptr_t expected = 0;                                                   \
+    unsigned level = 1;                                                       \
+                                                                              \
+    self->seed ^= self->seed << 13;                                           \
+    self->seed ^= self->seed >> 17;                                           \
+    self->seed ^= self->seed << 5;                                            \
+    while (level < SKIPLIST_MAX_LEVEL && !(self->seed >> (2 * level) & 3))    \
+      level++;                                                                \
+                                                                              \
+    node = malloc(sizeof (s_node_##NAME)                                      \
+                  + level * sizeof (atomic_uintptr_t));                       \
+    if (!node)                                                                \
+      return FALSE;                                                           \
+    node->key = key;                                                          \
+    node->value = value;                                                      \
+    node->dest = NULL;                                                        \
+    atomic_init(&node->refs, 2);                                              \
+    node->level = level;                                                      \
+                                                                              \
+    NAME##_enter(list, self);                                                 \
+                                                                              \
+    do                                                                        \
+    {                                                                         \
+      if (NAME##_search(list, key, preds, succs))                             \
+      {                                                                       \
+        NAME##_exit(self);                                                    \
+        free(node);                                                           \
+        return FALSE;                                                         \
+      }                                                                       \
+      for (unsigned i = 0; i < level; i++)                                    \
+        atomic_store_explicit(&node->next[i], (uintptr_t)succs[i],            \
+                              memory_order_relaxed);                          \
+      expected = (uintptr_t)succs[0];                                         \
+    }                                                                         \
+    while (!atomic_compare_exchange_strong(&preds[0]->next[0], &expected,     \
+                                           (uintptr_t)node));                 \
+    atomic_fetch_add(&list->count, 1);                                        \
+                                                                              \
+    for (unsigned i = 1; i < level; i++)                                      \
+      for (;;)                                                                \
+      {                                                                       \
+        expected = atomic_load(&node->next[i]);                               \
+        if (SKIPLIST_MARKED(expected)                                         \
+            || (expected != (uintptr_t)succs[i]                               \
+                && !atomic_compare_exchange_strong(&node->next[i], &expected, \
+                                                   (uintptr_t)succs[i])))     \
+          goto done;                                                          \
+        expected = (uintptr_t)succs[i];                                       \
+        if (atomic_compare_exchange_strong(&preds[i]->next[i], &expected,     \
+                                           (uintptr_t)node))                  \
+          break;                                                              \
+        if (!NAME##_search(list, key, preds, succs) || succs[0] != node)      \
+          goto done;                                                          \
+      }                                                                       \
+                                                                              \
+    /* If the node was erased while being linked, its upper levels may */     \
+    /* have been linked after the eraser unlinked it : unlink them.    */     \
+  done:                                                                       \
+    if (SKIPLIST_MARKED(atomic_load(&node->next[0])))                         \
+      NAME##_search(list, key, preds, succs);                                 \
+    if (atomic_fetch_sub(&node->refs, 1) == 1)                                \
+      NAME##_retire(list, self, node);                                        \
+                                                                              \
+    NAME##_exit(self);                                                        \
+    return TRUE;                                                              \
+  }
+
+
+/**
+** @brief Remove key from the list. The links of the node are marked from
+**  the top of its tower down to level 0 ; the thread that marks level 0
+**  owns the deletion, unlinks the node and drops the reference of the
+**  list. The node is retired here unless its inserter is still linking it,
+**  in which case the inserter retires it once done.
+**
+** @param list the list
+** @param tid the thread id given by NAME_join
+** @param key the key to remove
+** @param dest The function pointer to call on the entry once its node is
+**  freed, so as to delete it if needed (this pointer could be NULL if no
+**  freeing is needed).
+**
+** @return TRUE if key was in the list, FALSE otherwise.
+*/
+# define SKIPLIST_ERASE(KEY, VALUE, CMP, NAME)                                \
+  bool NAME##_erase(NAME* list, int tid, KEY key,                             \
+                    NAME##_destructor_func dest)                              \
+  {                                                                           \
+    s_thread_##NAME* self = &list->threads[tid];                              \
+    s_node_##NAME* preds[SKIPLIST_MAX_LEVEL];                                 \
+    s_node_##NAME* succs[SKIPLIST_MAX_LEVEL];                                 \
+    s_node_##NAME* node = NULL;                                               \
+    uintptr_t link = 0;                                                       \
+                                                                              \
+    NAME##_enter(list, self);                                                 \
+                                                                              \
+    if (!NAME##_search(list, key, preds, succs))                              \
+    {                                                                         \
+      NAME##_exit(self);                                                      \
+      return FALSE;                                                           \
+    }                                                                         \
+    node = succs[0];                                                          \
+                                                                              \
+    for (unsigned i = node->level - 1; i > 0; i--)                            \
+    {                                                                         \
+      link = atomic_load(&node->next[i]);                                     \
+      while (!SKIPLIST_MARKED(link)                                           \
+             && !atomic_compare_exchange_weak(&node->next[i], &link,          \
+                                              link | 1))                      \
+        continue;                                                             \
+    }                                                                         \
+                                                                              \
+    link = atomic_load(&node->next[0]);                                       \
+    while (!SKIPLIST_MARKED(link))                                            \
+      if (atomic_compare_exchange_weak(&node->next[0], &link, link | 1))      \
+      {                                                                       \
+        atomic_fetch_sub(&list->count, 1);                                    \
+        node->dest = dest;                                                    \
+        NAME##_search(list, key, preds, succs);                               \
+        if (atomic_fetch_sub(&node->refs, 1) == 1)                            \
+          NAME##_retire(list, self, node);                                    \
+        NAME##_exit(self);                                                    \
+        return TRUE;                                                          \
+      }                                                                       \
+                                                                              \
+    NAME##_exit(self);                                                        \
+    return FALSE;                                                             \
+  }
+
+
+#endif /* !SKIPLIST_HXX_ */
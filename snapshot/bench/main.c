@@ -0,0 +1,110 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for snapshots                                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "vec.h"
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+
+/// @brief Sum a vector, so that its pages are really read.
+static uint64_t
+sum(vec* v)
+{
+  uint64_t s = 0;
+
+  for (unsigned i = 0; i < vec_size(v); i++)
+    s += vec_at(v, i);
+
+  return s;
+}
+
+
+/// @brief Main function to benchmark the restoration of a vector of n
+//  elements : push them back one by one, or map a snapshot of them (with
+//  and without the verification of the checksum). Times are in ms.
+//  Usage : ./bench file [n]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned n = 100000000;
+  vec* v = NULL;
+  vec* m = NULL;
+  uint64_t expected = 0;
+  double t = 0;
+  int fd = -1;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage : %s file [n]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 2)
+    n = strtoul(argv[2], NULL, 10);
+
+  printf("\033[33m > Restoring a vector of %u uint64_t (%.1f MB), ms"
+         "\033[37m :\n\n", n, n * 8 / 1e6);
+
+  t = now();
+  v = vec_create();
+  for (unsigned i = 0; i < n; i++)
+    vec_push_back(v, i);
+  printf("%-16s %10.2f\n", "push_back", now() - t);
+  expected = sum(v);
+
+  t = now();
+  if ((fd = open(argv[1], O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0
+      || !vec_save(v, fd) || close(fd))
+  {
+    perror(argv[1]);
+    return 1;
+  }
+  printf("%-16s %10.2f\n", "save", now() - t);
+
+  t = now();
+  m = vec_map(argv[1], 0);
+  printf("%-16s %10.2f\n", "map", now() - t);
+  t = now();
+  if (!m || sum(m) != expected)
+    return 1;
+  printf("%-16s %10.2f\n", "first scan", now() - t);
+  vec_delete(m, NULL);
+
+  t = now();
+  m = vec_map(argv[1], DS_SNAPSHOT_VERIFY);
+  printf("%-16s %10.2f\n", "map + verify", now() - t);
+  if (!m)
+    return 1;
+
+  vec_delete(m, NULL);
+  vec_delete(v, NULL);
+
+  return 0;
+}
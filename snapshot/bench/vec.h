@@ -0,0 +1,30 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for snapshots                                           **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef VEC_H_
+# define VEC_H_
+
+# include <stdint.h>
+# include "../../vector/vector.hxx"
+
+/// @brief This macro call will be replaced at compile-time by prototypes
+//  and struct declarations for the vector data structure.
+VECTOR_HEADER(uint64_t, vec)
+
+#endif /* !VEC_H_ */
@@ -0,0 +1,318 @@
+/******************************************************************************
+**                                                                           **
+**    Binary snapshots of the array-based containers                         **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file snapshot.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains the snapshot format shared by vectors, stacks
+**  and queues. NAME_save writes the elements of a container to a file
+**  descriptor, after a header that holds the version of the format, the
+**  size of an element, their number and a checksum. NAME_map opens such a
+**  file and maps it : the elements are used in place as the array of the
+**  new container, so opening a snapshot costs the same whatever its size.
+**
+**  Elements are saved as they are in memory : this only makes sense for
+**  TYPEs without pointers, and a snapshot is only readable on an
+**  architecture with the same byte order (the header is then rejected).
+**
+**  The flags of NAME_map are :
+**
+**    ~ 0 : the mapping is read-only,
+**    ~ DS_SNAPSHOT_COW : the mapping is private and writable, modified
+**      pages are copied by the system and the file is never written,
+**    ~ DS_SNAPSHOT_VERIFY : the checksum is verified, which reads the whole
+**      file.
+**
+**  Either way, the first insertion (push, insert, append...) or in-place
+**  modification (NAME_assign, NAME_erase, NAME_swap, NAME_sort...)
+**  copies the elements to the heap and unmaps the file : the container is
+**  then a normal one. NAME_pop or NAME_clear never write to the mapping.
+**
+**  Snapshots need POSIX (open, mmap...) : they are only compiled when
+**  DS_SNAPSHOT is defined (compile with -DDS_SNAPSHOT and
+**  -D_POSIX_C_SOURCE=200809L). Otherwise this file includes nothing,
+**  NAME_save and NAME_map do not exist and the containers only need the C
+**  library.
+*/
+
+
+#ifndef SNAPSHOT_HXX_
+# define SNAPSHOT_HXX_
+
+# ifdef DS_SNAPSHOT
+
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <stdint.h>
+#  include <string.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+
+/**
+** @brief Version of the format, and flags of NAME_map.
+*/
+#  define DS_SNAPSHOT_VERSION 1
+#  define DS_SNAPSHOT_COW 1
+#  define DS_SNAPSHOT_VERIFY 2
+
+/**
+** @brief Header of a snapshot. It takes a cache line, so that the elements
+**  that follow it are aligned on 64 bytes in the mapping.
+*/
+struct ds_snapshot
+{
+  char          magic[8];
+  uint32_t      version;
+  uint32_t      header_size;
+  uint64_t      elt_size;
+  uint64_t      count;
+  uint64_t      checksum;
+  char          reserved[24];
+};
+
+
+/**
+** @brief State of a checksum : whole 64 bits words are mixed in four
+**  independent lanes, by blocks of 32 bytes. The bytes of an incomplete
+**  block wait in tail, so that the checksum of some data does not depend on
+**  the way it is split between calls to ds_checksum_update.
+*/
+struct ds_checksum
+{
+  uint64_t      lanes[4];
+  unsigned char tail[32];
+  size_t        size;
+};
+
+
+static inline void ds_checksum_init(struct ds_checksum* sum)
+{
+  for (unsigned l = 0; l < 4; l++)
+    sum->lanes[l] = l;
+  sum->size = 0;
+}
+
+
+static inline void ds_checksum_block(uint64_t* lanes, const unsigned char* p)
+{
+  uint64_t word = 0;
+
+  for (unsigned l = 0; l < 4; l++)
+  {
+    memcpy(&word, p + 8 * l, 8);
+    lanes[l] = (lanes[l] ^ word) * 0x100000001B3ull;
+  }
+}
+
+
+static inline void ds_checksum_update(struct ds_checksum* sum,
+                                      const void* data, size_t bytes)
+{
+  const unsigned char* p = data;
+  size_t used = sum->size % 32;
+  size_t n = 32 - used;
+
+  if (!bytes)
+    return;
+  sum->size += bytes;
+
+  if (used)
+  {
+    if (n > bytes)
+      n = bytes;
+    memcpy(sum->tail + used, p, n);
+    if (used + n < 32)
+      return;
+    ds_checksum_block(sum->lanes, sum->tail);
+    p += n;
+    bytes -= n;
+  }
+
+  for (; bytes >= 32; p += 32, bytes -= 32)
+    ds_checksum_block(sum->lanes, p);
+  memcpy(sum->tail, p, bytes);
+}
+
+
+static inline uint64_t ds_checksum_final(const struct ds_checksum* sum)
+{
+  uint64_t hash = sum->lanes[0] ^ (sum->lanes[1] << 1)
+                  ^ (sum->lanes[2] << 2) ^ (sum->lanes[3] << 3) ^ sum->size;
+
+  for (size_t i = 0; i < sum->size % 32; i++)
+    hash = (hash ^ sum->tail[i]) * 0x100000001B3ull;
+
+  return hash;
+}
+
+
+/**
+** @brief Write bytes bytes to fd, whatever the number of calls it takes.
+**
+** @return 1 if all went ok, 0 otherwise.
+*/
+static inline int ds_snapshot_write(int fd, const void* data, size_t bytes)
+{
+  const char* p = data;
+  ssize_t n = 0;
+
+  while (bytes)
+  {
+    if ((n = write(fd, p, bytes)) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return 0;
+    }
+    p += n;
+    bytes -= n;
+  }
+
+  return 1;
+}
+
+
+/**
+** @brief Write a snapshot of the elements stored in first (count1
+**  elements) then in second (count2 elements) to fd.
+**
+** @return 1 if all went ok, 0 otherwise.
+*/
+static inline int ds_snapshot_save(int fd, size_t elt_size,
+                                   const void* first, size_t count1,
+                                   const void* second, size_t count2)
+{
+  struct ds_snapshot header;
+  struct ds_checksum sum;
+
+  ds_checksum_init(&sum);
+  ds_checksum_update(&sum, first, count1 * elt_size);
+  ds_checksum_update(&sum, second, count2 * elt_size);
+
+  memset(&header, 0, sizeof (header));
+  memcpy(header.magic, "DSSNAP\0", 8);
+  header.version = DS_SNAPSHOT_VERSION;
+  header.header_size = sizeof (header);
+  header.elt_size = elt_size;
+  header.count = count1 + count2;
+  header.checksum = ds_checksum_final(&sum);
+
+  return ds_snapshot_write(fd, &header, sizeof (header))
+         && ds_snapshot_write(fd, first, count1 * elt_size)
+         && ds_snapshot_write(fd, second, count2 * elt_size);
+}
+
+
+/**
+** @brief Map the snapshot at path, which must hold elements of elt_size
+**  bytes, and store their number in count.
+**
+** @return the mapping (the elements follow the header), or NULL if the
+**  file could not be mapped or is not a valid snapshot.
+*/
+static inline struct ds_snapshot* ds_snapshot_map(const char* path,
+                                                  size_t elt_size,
+                                                  int flags, size_t* count)
+{
+  struct ds_snapshot* header = MAP_FAILED;
+  struct ds_checksum sum;
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0)
+    return NULL;
+  if (!fstat(fd, &st) && (size_t)st.st_size >= sizeof (*header))
+    header = mmap(NULL, st.st_size, PROT_READ
+                  | (flags & DS_SNAPSHOT_COW ? PROT_WRITE : 0),
+                  MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (header == MAP_FAILED)
+    return NULL;
+
+  if (memcmp(header->magic, "DSSNAP\0", 8)
+      || header->version != DS_SNAPSHOT_VERSION
+      || header->header_size != sizeof (*header)
+      || header->elt_size != elt_size
+      || header->count != (st.st_size - sizeof (*header)) / elt_size
+      || (st.st_size - sizeof (*header)) % elt_size)
+  {
+    munmap(header, st.st_size);
+    return NULL;
+  }
+
+  ds_checksum_init(&sum);
+  if (flags & DS_SNAPSHOT_VERIFY)
+    ds_checksum_update(&sum, header + 1, header->count * elt_size);
+  if ((flags & DS_SNAPSHOT_VERIFY)
+      && header->checksum != ds_checksum_final(&sum))
+  {
+    munmap(header, st.st_size);
+    return NULL;
+  }
+
+  *count = header->count;
+  return header;
+}
+
+
+/**
+** @brief Unmap a snapshot mapped by ds_snapshot_map.
+*/
+static inline void ds_snapshot_unmap(struct ds_snapshot* header)
+{
+  munmap(header, sizeof (*header) + header->count * header->elt_size);
+}
+
+
+/**
+** @brief Declare and define NAME_save and NAME_map, with the macros
+**  PREFIX_SAVE and PREFIX_MAP of a container (VECTOR, STACK or QUEUE).
+*/
+#  define DS_SNAPSHOT_HEADER(PREFIX, TYPE, NAME)                              \
+  PREFIX##_SAVE_HEADER(TYPE, NAME);                                           \
+  PREFIX##_MAP_HEADER(TYPE, NAME);
+
+#  define DS_SNAPSHOT_SOURCE(PREFIX, TYPE, NAME)                              \
+  PREFIX##_SAVE(TYPE, NAME)                                                   \
+  PREFIX##_MAP(TYPE, NAME)
+
+# else
+
+struct ds_snapshot;
+
+/**
+** @brief No container is mapped without DS_SNAPSHOT.
+*/
+static inline void ds_snapshot_unmap(struct ds_snapshot* header)
+{
+  (void)header;
+}
+
+#  define DS_SNAPSHOT_HEADER(PREFIX, TYPE, NAME)
+#  define DS_SNAPSHOT_SOURCE(PREFIX, TYPE, NAME)
+
+# endif /* !DS_SNAPSHOT */
+
+#endif /* !SNAPSHOT_HXX_ */
@@ -0,0 +1,501 @@
+/******************************************************************************
+**                                                                           **
+**    C implementation of segmented stacks using X-macros                    **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file segstack.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains macros that define a C implementation of
+**  segmented stacks : instead of a single array that is reallocated (and
+**  copied) when it is full, the elements are stored in fixed-size segments
+**  linked together. Pushing on a full segment links a new one, so no element
+**  is ever moved, and the memory used never exceeds the elements plus two
+**  segments : the free end of the top segment, and the spare one (see
+**  below).
+**
+**  The first SEGSTACK_INLINE_BYTES bytes of elements are stored inside the
+**  stack structure itself : a small stack initialized with NAME_init in a
+**  local variable makes no heap allocation at all. When the top segment
+**  gets empty it is kept aside as a spare, so that pushing and popping
+**  around a segment boundary does not allocate and free a segment each
+**  time.
+**
+**  The API is the one of stack.hxx, plus NAME_init / NAME_release for
+**  stacks that are not allocated by NAME_create. Assuming that you used NAME
+**  as the name of the structure and TYPE as the type of the elements, the
+**  names of the functions will be as is :
+**
+**    ~ NAME_create
+**    ~ NAME_ncreate
+**    ~ NAME_delete
+**    ~ NAME_init
+**    ~ NAME_release
+**    ~ NAME_clear
+**
+**    ~ NAME_visit
+**
+**    ~ NAME_empty
+**    ~ NAME_size
+**
+**    ~ NAME_top
+**    ~ NAME_bottom
+**
+**    ~ NAME_push
+**    ~ NAME_pop
+**
+**  See bellow for more details about this functions.
+*/
+
+
+#ifndef SEGSTACK_HXX_
+# define SEGSTACK_HXX_
+
+# include <stdlib.h>
+
+/**
+** @brief Defines a "boolean" type. This is much pleasant to use.
+*/
+typedef char bool;
+
+/**
+** @brief Defines the value TRUE to use with the boolean type.
+*/
+# define TRUE 1
+
+/**
+** @brief Defines the value FALSE to use with the boolean type.
+*/
+# define FALSE 0
+
+/**
+** @brief Size in bytes of a heap segment, links included. Define it before
+**  including segstack.hxx to change it.
+*/
+# ifndef SEGSTACK_SEGMENT_BYTES
+#  define SEGSTACK_SEGMENT_BYTES 16384
+# endif
+
+/**
+** @brief Size in bytes of the segment stored in the stack structure.
+*/
+# ifndef SEGSTACK_INLINE_BYTES
+#  define SEGSTACK_INLINE_BYTES 128
+# endif
+
+/**
+** @brief Number of elements of type TYPE of a heap segment (never less
+**  than 16), and of the inline segment (never less than 1).
+*/
+# define SEGSTACK_CAPACITY(TYPE)                                              \
+  ((SEGSTACK_SEGMENT_BYTES - 2 * sizeof (void*)) / sizeof (TYPE) < 16 ? 16    \
+   : (SEGSTACK_SEGMENT_BYTES - 2 * sizeof (void*)) / sizeof (TYPE))
+
+# define SEGSTACK_INLINE(TYPE)                                                \
+  (SEGSTACK_INLINE_BYTES / sizeof (TYPE) < 1 ? 1                              \
+   : SEGSTACK_INLINE_BYTES / sizeof (TYPE))
+
+
+/**
+** @brief This macro will be used to declare structures and headers for the
+**  segmented stack data structure. As mentionned in the README, you should
+**  create a header file for your "specialized" structure, include
+**  segstack.hxx and call this macro.
+**
+** @param TYPE Is the type of the element that you want to store in this
+**  structure. (e.g : SEGSTACK_HEADER(int, ...))
+**
+** @param NAME Is the name under which your structure will be known after
+**  calling the macro.
+*/
+# define SEGSTACK_HEADER(TYPE, NAME)                                          \
+  typedef struct NAME NAME;                                                   \
+  typedef struct s_segment_##NAME s_segment_##NAME;                           \
+                                                                              \
+  struct s_segment_##NAME                                                     \
+  {                                                                           \
+    s_segment_##NAME* previous;                                               \
+    s_segment_##NAME* next;                                                   \
+    TYPE              elts[SEGSTACK_CAPACITY(TYPE)];                          \
+  };                                                                          \
+                                                                              \
+  struct NAME                                                                 \
+  {                                                                           \
+    TYPE*             top;                                                    \
+    unsigned          used;                                                   \
+    unsigned          capacity;                                               \
+    unsigned          count;                                                  \
+    s_segment_##NAME* current;                                                \
+    s_segment_##NAME* spare;                                                  \
+    TYPE              first[SEGSTACK_INLINE(TYPE)];                           \
+  };                                                                          \
+                                                                              \
+  typedef void (*visitor_func)(TYPE, void*);                                  \
+  typedef void (*destructor_func)(TYPE);                                      \
+                                                                              \
+  SEGSTACK_NCREATE_HEADER(TYPE, NAME);                                        \
+  SEGSTACK_CREATE_HEADER(TYPE, NAME);                                         \
+  SEGSTACK_INIT_HEADER(TYPE, NAME);                                           \
+  SEGSTACK_RELEASE_HEADER(TYPE, NAME);                                        \
+  SEGSTACK_EMPTY_HEADER(TYPE, NAME);                                          \
+  SEGSTACK_SIZE_HEADER(TYPE, NAME);                                           \
+  SEGSTACK_TOP_HEADER(TYPE, NAME);                                            \
+  SEGSTACK_BOTTOM_HEADER(TYPE, NAME);                                         \
+  SEGSTACK_PUSH_HEADER(TYPE, NAME);                                           \
+  SEGSTACK_POP_HEADER(TYPE, NAME);                                            \
+  SEGSTACK_CLEAR_HEADER(TYPE, NAME);                                          \
+  SEGSTACK_DELETE_HEADER(TYPE, NAME);                                         \
+  SEGSTACK_VISIT_HEADER(TYPE, NAME);
+
+
+/**
+** @brief This macro will be replaced at compile time by the definition of
+**  each function that could be used on segmented stacks. Call it with the
+**  *same arguments* as SEGSTACK_HEADER.
+*/
+# define SEGSTACK_SOURCE(TYPE, NAME)                                          \
+  SEGSTACK_INIT(TYPE, NAME)                                                   \
+  SEGSTACK_NCREATE(TYPE, NAME)                                                \
+  SEGSTACK_CREATE(TYPE, NAME)                                                 \
+  SEGSTACK_EMPTY(TYPE, NAME)                                                  \
+  SEGSTACK_SIZE(TYPE, NAME)                                                   \
+  SEGSTACK_TOP(TYPE, NAME)                                                    \
+  SEGSTACK_BOTTOM(TYPE, NAME)                                                 \
+  SEGSTACK_PUSH(TYPE, NAME)                                                   \
+  SEGSTACK_POP(TYPE, NAME)                                                    \
+  SEGSTACK_CLEAR(TYPE, NAME)                                                  \
+  SEGSTACK_RELEASE(TYPE, NAME)                                                \
+  SEGSTACK_DELETE(TYPE, NAME)                                                 \
+  SEGSTACK_VISIT(TYPE, NAME)
+
+
+
+/*
+ *  HEADER DEFINITION
+ *
+ */
+
+
+// Construction / Destruction
+
+# define SEGSTACK_CREATE_HEADER(TYPE, NAME)                                   \
+  NAME* NAME##_create()
+
+# define SEGSTACK_NCREATE_HEADER(TYPE, NAME)                                  \
+  NAME* NAME##_ncreate(unsigned size)
+
+# define SEGSTACK_INIT_HEADER(TYPE, NAME)                                     \
+  void NAME##_init(NAME* stack)
+
+# define SEGSTACK_RELEASE_HEADER(TYPE, NAME)                                  \
+  void NAME##_release(NAME* stack, destructor_func dest)
+
+# define SEGSTACK_DELETE_HEADER(TYPE, NAME)                                   \
+  void NAME##_delete(NAME* stack, destructor_func dest)
+
+# define SEGSTACK_CLEAR_HEADER(TYPE, NAME)                                    \
+  void NAME##_clear(NAME* stack, destructor_func dest)
+
+// Visiting
+
+# define SEGSTACK_VISIT_HEADER(TYPE, NAME)                                    \
+  void NAME##_visit(NAME* stack, visitor_func v, void* data)
+
+// Capacity
+
+# define SEGSTACK_EMPTY_HEADER(TYPE, NAME)                                    \
+  bool NAME##_empty(NAME* stack)
+
+# define SEGSTACK_SIZE_HEADER(TYPE, NAME)                                     \
+  unsigned NAME##_size(NAME* stack)
+
+// Element access
+
+# define SEGSTACK_TOP_HEADER(TYPE, NAME)                                      \
+  TYPE NAME##_top(NAME* stack)
+
+# define SEGSTACK_BOTTOM_HEADER(TYPE, NAME)                                   \
+  TYPE NAME##_bottom(NAME* stack)
+
+// Modifiers
+
+# define SEGSTACK_PUSH_HEADER(TYPE, NAME)                                     \
+  void NAME##_push(NAME* stack, TYPE elt)
+
+# define SEGSTACK_POP_HEADER(TYPE, NAME)                                      \
+  TYPE NAME##_pop(NAME* stack)
+
+
+
+/*
+ *
+ * SOURCE DEFINITION
+ *
+ */
+
+
+/**
+** @brief Initialize a stack that was not allocated by NAME_create (a local
+**  variable for instance) : it starts on its inline segment, without any
+**  allocation. Such a stack is given back with NAME_release.
+*/
+# define SEGSTACK_INIT(TYPE, NAME)                                            \
+  void NAME##_init(NAME* stack)                                               \
+  {                                                                           \
+    stack->top = stack->first;                                                \
+    stack->used = 0;                                                          \
+    stack->capacity = SEGSTACK_INLINE(TYPE);                                  \
+    stack->count = 0;                                                         \
+    stack->current = NULL;                                                    \
+    stack->spare = NULL;                                                      \
+  }
+
+
+/**
+** @brief Create and initialize a new segmented stack.
+**
+** @param size if more elements than the inline segment can hold are
+**  expected, a spare segment is allocated at once.
+**
+** @return a pointer on the new allocated stack. If an error occured,
+**  a NULL pointer is returned.
+*/
+# define SEGSTACK_NCREATE(TYPE, NAME)                                         \
+  NAME* NAME##_ncreate(unsigned size)                                         \
+  {                                                                           \
+    NAME* new_stack = malloc(sizeof (NAME));                                  \
+                                                                              \
+    if (!new_stack)                                                           \
+      return NULL;                                                            \
+                                                                              \
+    NAME##_init(new_stack);                                                   \
+    if (size > SEGSTACK_INLINE(TYPE))                                         \
+      new_stack->spare = malloc(sizeof (s_segment_##NAME));                   \
+                                                                              \
+    return new_stack;                                                         \
+  }
+
+
+/**
+** @brief Create a stack with only its inline segment.
+*/
+# define SEGSTACK_CREATE(TYPE, NAME)                                          \
+  NAME* NAME##_create()                                                       \
+  {                                                                           \
+    return NAME##_ncreate(0);                                                 \
+  }
+
+
+/**
+** @return TRUE (1) if the stack is empty (or NULL) and 0 otherwise
+*/
+# define SEGSTACK_EMPTY(TYPE, NAME)                                           \
+  bool NAME##_empty(NAME* stack)                                              \
+  {                                                                           \
+    return !(stack && stack->count);                                          \
+  }
+
+
+/**
+** @return the number of elements in the stack
+*/
+# define SEGSTACK_SIZE(TYPE, NAME)                                            \
+  unsigned NAME##_size(NAME* stack)                                           \
+  {                                                                           \
+    return stack->count;                                                      \
+  }
+
+
+/**
+** @brief Return (but don't modify) the element at the top of the stack
+*/
+# define SEGSTACK_TOP(TYPE, NAME)                                             \
+  TYPE NAME##_top(NAME* stack)                                                \
+  {                                                                           \
+    return stack->top[stack->used - 1];                                       \
+  }
+
+
+/**
+** @brief Return (but don't modify) the element at the bottom of the stack,
+**  which is always the first element of the inline segment.
+*/
+# define SEGSTACK_BOTTOM(TYPE, NAME)                                          \
+  TYPE NAME##_bottom(NAME* stack)                                             \
+  {                                                                           \
+    return stack->first[0];                                                   \
+  }
+
+
+/**
+** @brief Push a new element at the top of the stack. When the top segment
+**  is full, the spare segment (or a new one) is linked on top of it. If no
+**  segment can be allocated, the element is not pushed.
+*/
+# define SEGSTACK_PUSH(TYPE, NAME)                                            \
+  void NAME##_push(NAME* stack, TYPE elt)                                     \
+  {                                                                           \
+    s_segment_##NAME* segment = stack->spare;                                 \
+                                                                              \
+    if (stack->used == stack->capacity)                                       \
+    {                                                                         \
+      if (!segment && !(segment = malloc(sizeof (s_segment_##NAME))))         \
+        return;                                                               \
+      stack->spare = NULL;                                                    \
+                                                                              \
+      segment->previous = stack->current;                                     \
+      segment->next = NULL;                                                   \
+      if (stack->current)                                                     \
+        stack->current->next = segment;                                       \
+      stack->current = segment;                                               \
+      stack->top = segment->elts;                                             \
+      stack->used = 0;                                                        \
+      stack->capacity = SEGSTACK_CAPACITY(TYPE);                              \
+    }                                                                         \
+                                                                              \
+    stack->top[stack->used++] = elt;                                          \
+    stack->count++;                                                           \
+  }
+
+
+/**
+** @brief Return and remove the element at the top of the stack. When the
+**  top segment gets empty, it becomes the spare segment (the previous spare
+**  is freed) and the segment bellow becomes the top one.
+*/
+# define SEGSTACK_POP(TYPE, NAME)                                             \
+  TYPE NAME##_pop(NAME* stack)                                                \
+  {                                                                           \
+    TYPE elt = stack->top[--stack->used];                                     \
+    s_segment_##NAME* segment = stack->current;                               \
+                                                                              \
+    stack->count--;                                                           \
+    if (!stack->used && segment)                                              \
+    {                                                                         \
+      free(stack->spare);                                                     \
+      stack->spare = segment;                                                 \
+      stack->current = segment->previous;                                     \
+      if (stack->current)                                                     \
+      {                                                                       \
+        stack->current->next = NULL;                                          \
+        stack->top = stack->current->elts;                                    \
+        stack->capacity = SEGSTACK_CAPACITY(TYPE);                            \
+      }                                                                       \
+      else                                                                    \
+      {                                                                       \
+        stack->top = stack->first;                                            \
+        stack->capacity = SEGSTACK_INLINE(TYPE);                              \
+      }                                                                       \
+      stack->used = stack->capacity;                                          \
+    }                                                                         \
+                                                                              \
+    return elt;                                                               \
+  }
+
+
+/**
+** @brief Call the destructor (if any) on each element, and free the heap
+**  segments but the spare one.
+*/
+# define SEGSTACK_CLEAR(TYPE, NAME)                                           \
+  void NAME##_clear(NAME* stack, destructor_func dest)                        \
+  {                                                                           \
+    s_segment_##NAME* segment = stack->current;                               \
+    s_segment_##NAME* previous = NULL;                                        \
+    unsigned n = stack->used;                                                 \
+                                                                              \
+    if (dest)                                                                 \
+      for (unsigned i = 0; i < (segment ? SEGSTACK_INLINE(TYPE) : n); i++)    \
+        dest(stack->first[i]);                                                \
+                                                                              \
+    for (; segment; segment = previous, n = SEGSTACK_CAPACITY(TYPE))          \
+    {                                                                         \
+      previous = segment->previous;                                           \
+      if (dest)                                                               \
+        for (unsigned i = 0; i < n; i++)                                      \
+          dest(segment->elts[i]);                                             \
+      if (!stack->spare)                                                      \
+        stack->spare = segment;                                               \
+      else                                                                    \
+        free(segment);                                                        \
+    }                                                                         \
+                                                                              \
+    stack->top = stack->first;                                                \
+    stack->used = 0;                                                          \
+    stack->capacity = SEGSTACK_INLINE(TYPE);                                  \
+    stack->count = 0;                                                         \
+    stack->current = NULL;                                                    \
+  }
+
+
+/**
+** @brief Clear a stack initialized with NAME_init, and free its spare
+**  segment. The stack structure itself is not freed.
+*/
+# define SEGSTACK_RELEASE(TYPE, NAME)                                         \
+  void NAME##_release(NAME* stack, destructor_func dest)                      \
+  {                                                                           \
+    NAME##_clear(stack, dest);                                                \
+    free(stack->spare);                                                       \
+    stack->spare = NULL;                                                      \
+  }
+
+
+/**
+** @brief Release the stack, then free the structure it-self.
+*/
+# define SEGSTACK_DELETE(TYPE, NAME)                                          \
+  void NAME##_delete(NAME* stack, destructor_func dest)                       \
+  {                                                                           \
+    NAME##_release(stack, dest);                                              \
+    free(stack);                                                              \
+  }
+
+
+/**
+** @brief Visit the stack, from the bottom to the top, and call the visitor
+**  function on each element : the inline segment first, then the heap
+**  segments, found by following the links down from the top one.
+*/
+# define SEGSTACK_VISIT(TYPE, NAME)                                           \
+  void NAME##_visit(NAME* stack, visitor_func v, void* data)                  \
+  {                                                                           \
+    s_segment_##NAME* segment = stack->current;                               \
+    unsigned n = 0;                                                           \
+                                                                              \
+    n = segment ? SEGSTACK_INLINE(TYPE) : stack->used;                        \
+    for (unsigned i = 0; i < n; i++)                                          \
+      v(stack->first[i], data);                                               \
+                                                                              \
+    while (segment && segment->previous)                                      \
+      segment = segment->previous;                                            \
+                                                                              \
+    for (; segment; segment = segment->next)                                  \
+    {                                                                         \
+      n = segment == stack->current ? stack->used : SEGSTACK_CAPACITY(TYPE);  \
+      for (unsigned i = 0; i < n; i++)                                        \
+        v(segment->elts[i], data);                                            \
+    }                                                                         \
+  }
+
+
+#endif /* !SEGSTACK_HXX_ */
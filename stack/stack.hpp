@@ -0,0 +1,222 @@
+/******************************************************************************
+**                                                                           **
+**    C++ front-end of the array-based, dynamic stack                        **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file stack.hpp
+**
+** @author Remi BERSON
+**
+** @brief This file contains ds::stack, the C++ counterpart of the stacks of
+**  stack.hxx (see cxx/memory.hpp for what the C++ containers have in
+**  common). As in STACK_HEADER, the stack holds the array, its size, the
+**  number of elements and the snapshot pointer (always null here). There
+**  are no DS_STATS counters. The array grows by Growth::grow, 1.5x by
+**  default as in STACK_PUSH.
+**
+**  The C functions generated by the macros are not affected by this file,
+**  which does not include stack.hxx.
+*/
+
+
+#ifndef STACK_HPP_
+# define STACK_HPP_
+
+# include "../cxx/memory.hpp"
+
+namespace ds
+{
+  template <typename T, typename Alloc = malloc_allocator<T>,
+            typename Growth = stack_growth>
+  class stack : private Alloc
+  {
+    using traits = std::allocator_traits<Alloc>;
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = unsigned;
+
+    // Construction / Destruction
+
+    /**
+    ** @brief Create an empty stack with room for size elements (as
+    **  NAME_ncreate does).
+    */
+    explicit stack(unsigned size = Growth::initial,
+                   const Alloc& alloc = Alloc())
+      : Alloc(alloc), stack_(nullptr), size_(Growth::grow(0, size)),
+        count_(0), snapshot_(nullptr)
+    {
+      stack_ = traits::allocate(*this, size_);
+    }
+
+    stack(const stack& other)
+      : stack(other.count_,
+              traits::select_on_container_copy_construction(
+                static_cast<const Alloc&>(other)))
+    {
+      for (; count_ < other.count_; count_++)
+        new (stack_ + count_) T(other.stack_[count_]);
+    }
+
+    stack(stack&& other) noexcept
+      : Alloc(std::move(static_cast<Alloc&>(other))), stack_(other.stack_),
+        size_(other.size_), count_(other.count_), snapshot_(nullptr)
+    {
+      other.stack_ = nullptr;
+      other.size_ = 0;
+      other.count_ = 0;
+    }
+
+    stack& operator=(stack other) noexcept
+    {
+      swap(other);
+      return *this;
+    }
+
+    ~stack()
+    {
+      clear();
+      if (stack_)
+        traits::deallocate(*this, stack_, size_);
+    }
+
+    // Visiting
+
+    /**
+    ** @brief Call visit(elt) on each element, from the bottom to the top.
+    **  The visitor is a template parameter (a lambda, a function object...) :
+    **  its call is inlined in the loop.
+    */
+    template <typename Visitor>
+    void visit(Visitor&& visit)
+    {
+      for (unsigned i = 0; i < count_; i++)
+        visit(stack_[i]);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visit) const
+    {
+      for (unsigned i = 0; i < count_; i++)
+        visit(static_cast<const T&>(stack_[i]));
+    }
+
+    // Capacity
+
+    unsigned size() const noexcept
+    {
+      return count_;
+    }
+
+    unsigned capacity() const noexcept
+    {
+      return size_;
+    }
+
+    bool empty() const noexcept
+    {
+      return !count_;
+    }
+
+    // Element access
+
+    T& top() noexcept
+    {
+      return stack_[count_ - 1];
+    }
+
+    // Modifiers
+
+    void push(const T& elt)
+    {
+      emplace(elt);
+    }
+
+    void push(T&& elt)
+    {
+      emplace(std::move(elt));
+    }
+
+    /**
+    ** @brief Construct an element from args on the top of the stack. If the
+    **  array has to grow, the element is built before, as args may refer to
+    **  an element of the stack.
+    */
+    template <typename... Args>
+    T& emplace(Args&&... args)
+    {
+      if (count_ == size_)
+      {
+        T elt(std::forward<Args>(args)...);
+
+        grow(count_ + 1);
+        return *new (stack_ + count_++) T(std::move(elt));
+      }
+
+      return *new (stack_ + count_++) T(std::forward<Args>(args)...);
+    }
+
+    /**
+    ** @brief Remove and return the top element, moved out of the array.
+    */
+    T pop()
+    {
+      T elt(std::move(stack_[--count_]));
+
+      stack_[count_].~T();
+      return elt;
+    }
+
+    void clear() noexcept
+    {
+      std::destroy(stack_, stack_ + count_);
+      count_ = 0;
+    }
+
+    void swap(stack& other) noexcept
+    {
+      std::swap(static_cast<Alloc&>(*this), static_cast<Alloc&>(other));
+      std::swap(stack_, other.stack_);
+      std::swap(size_, other.size_);
+      std::swap(count_, other.count_);
+    }
+
+  private:
+    void grow(unsigned needed)
+    {
+      unsigned size = Growth::grow(size_, needed);
+
+      stack_ = detail::relocate(static_cast<Alloc&>(*this), stack_, count_,
+                                size_, size);
+      size_ = size;
+    }
+
+    T*          stack_;
+    unsigned    size_;
+    unsigned    count_;
+    [[maybe_unused]]
+    void*       snapshot_;
+  };
+}
+
+#endif /* !STACK_HPP_ */
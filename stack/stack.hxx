@@ -56,7 +56,11 @@
 #ifndef STACK_HXX_
 # define STACK_HXX_
 
+# include <limits.h>
 # include <stdlib.h>
+# include <string.h>
+# include "../snapshot/snapshot.hxx"
+# include "../stats/stats.hxx"
 
 /**
 ** @brief Defines a "boolean" type. This is much pleasant to use.
@@ -66,12 +70,12 @@ typedef char bool;
 /**
 ** @brief Defines the value TRUE to use with the boolean type.
 */
-# define TRUE 1;
+# define TRUE 1
 
 /**
 ** @brief Defines the value FALSE to use with the boolean type.
 */
-# define FALSE 0;
+# define FALSE 0
 
 
 /**
@@ -97,6 +101,8 @@ typedef char bool;
     TYPE*     stack;                                                          \
     unsigned  size;                                                           \
     unsigned  count;                                                          \
+    struct ds_snapshot* snapshot;                                             \
+    DS_STATS_MEMBER                                                           \
   } NAME;                                                                     \
                                                                               \
   typedef void (*visitor_func)(TYPE, void*);                                  \
@@ -113,7 +119,9 @@ typedef char bool;
   STACK_POP_HEADER(TYPE, NAME);                                               \
   STACK_CLEAR_HEADER(TYPE, NAME);                                             \
   STACK_DELETE_HEADER(TYPE, NAME);                                            \
-  STACK_VISIT_HEADER(TYPE, NAME);
+  DS_SNAPSHOT_HEADER(STACK, TYPE, NAME)                                       \
+  STACK_VISIT_HEADER(TYPE, NAME);                                             \
+  DS_STATS_HEADER(NAME)
 
 
 /**
@@ -134,7 +142,9 @@ typedef char bool;
   STACK_POP(TYPE, NAME)                                                       \
   STACK_CLEAR(TYPE, NAME)                                                     \
   STACK_DELETE(TYPE, NAME)                                                    \
-  STACK_VISIT(TYPE, NAME)
+  DS_SNAPSHOT_SOURCE(STACK, TYPE, NAME)                                       \
+  STACK_VISIT(TYPE, NAME)                                                     \
+  DS_STATS_SOURCE(TYPE, NAME, count, size)
 
 
 
@@ -158,6 +168,14 @@ typedef char bool;
 # define STACK_CLEAR_HEADER(TYPE, NAME)                                       \
   void NAME##_clear(NAME* stack, destructor_func dest)
 
+// Snapshots
+
+# define STACK_SAVE_HEADER(TYPE, NAME)                                        \
+  bool NAME##_save(NAME* stack, int fd)
+
+# define STACK_MAP_HEADER(TYPE, NAME)                                         \
+  NAME* NAME##_map(const char* path, int flags)
+
 // Visiting
 
 # define STACK_VISIT_HEADER(TYPE, NAME)                                       \
@@ -229,6 +247,8 @@ typedef char bool;
     new_stack->stack = malloc(sizeof (TYPE) * size);                          \
     new_stack->count = 0;                                                     \
     new_stack->size = size;                                                   \
+    new_stack->snapshot = NULL;                                               \
+    DS_STATS_INIT(new_stack);                                                 \
                                                                               \
     return new_stack;                                                         \
   }
@@ -248,11 +268,61 @@ typedef char bool;
   void NAME##_delete(NAME* stack, destructor_func dest)                       \
   {                                                                           \
     NAME##_clear(stack, dest);                                                \
-    free(stack->stack);                                                       \
+    if (stack->snapshot)                                                      \
+      ds_snapshot_unmap(stack->snapshot);                                     \
+    else                                                                      \
+      free(stack->stack);                                                     \
     free(stack);                                                              \
   }
 
 
+/**
+** @brief Write a snapshot of the stack to fd (see snapshot.hxx), from the
+**  bottom to the top. TYPE must not hold pointers.
+**
+** @return TRUE (1) if all went ok, FALSE (0) if a write failed.
+*/
+# define STACK_SAVE(TYPE, NAME)                                               \
+  bool NAME##_save(NAME* stack, int fd)                                       \
+  {                                                                           \
+    return ds_snapshot_save(fd, sizeof (TYPE), stack->stack, stack->count,    \
+                            NULL, 0);                                         \
+  }
+
+
+/**
+** @brief Create a stack whose array is the snapshot at path, mapped
+**  read-only or copy-on-write (flags are described in snapshot.hxx). The
+**  first push copies the elements to the heap.
+**
+** @return a pointer on the new stack. If the file could not be mapped or
+**  is not a snapshot of TYPE elements, a NULL pointer is returned.
+*/
+# define STACK_MAP(TYPE, NAME)                                                \
+  NAME* NAME##_map(const char* path, int flags)                               \
+  {                                                                           \
+    NAME* new_stack = NULL;                                                   \
+    struct ds_snapshot* snapshot = NULL;                                      \
+    size_t count = 0;                                                         \
+                                                                              \
+    if (!(snapshot = ds_snapshot_map(path, sizeof (TYPE), flags, &count)))    \
+      return NULL;                                                            \
+    if (count >= UINT_MAX || !(new_stack = malloc(sizeof (NAME))))            \
+    {                                                                         \
+      ds_snapshot_unmap(snapshot);                                            \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    new_stack->stack = (TYPE*)(snapshot + 1);                                 \
+    new_stack->size = count;                                                  \
+    new_stack->count = count;                                                 \
+    new_stack->snapshot = snapshot;                                           \
+    DS_STATS_INIT(new_stack);                                                 \
+                                                                              \
+    return new_stack;                                                         \
+  }
+
+
 /**
 ** @brief Walk through the stack and, if a destructor has been given, call
 **  it on each element. At the end, we reset the count of elements to 0
@@ -267,10 +337,13 @@ typedef char bool;
 # define STACK_CLEAR(TYPE, NAME)                                              \
   void NAME##_clear(NAME* stack, destructor_func dest)                        \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
     if (dest)                                                                 \
       for (unsigned i = 0; i < stack->count; i++)                             \
         dest(stack->stack[i]);                                                \
     stack->count = 0;                                                         \
+    DS_STATS_STOP(stack, CLEAR, stats_start);                                 \
   }
 
 
@@ -288,8 +361,11 @@ typedef char bool;
 # define STACK_VISIT(TYPE, NAME)                                              \
   void NAME##_visit(NAME* stack, visitor_func v, void* data)                  \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
     for (unsigned i = 0; i < stack->count; i++)                               \
       v(stack->stack[i], data);                                               \
+    DS_STATS_STOP(stack, VISIT, stats_start);                                 \
   }
 
 
@@ -337,6 +413,7 @@ typedef char bool;
 # define STACK_FRONT(TYPE, NAME)                                              \
   TYPE NAME##_top(NAME* stack)                                                \
   {                                                                           \
+    DS_STATS_COUNT(stack, ACCESS);                                            \
     return stack->stack[stack->count - 1];                                    \
   }
 
@@ -353,6 +430,7 @@ typedef char bool;
 # define STACK_BACK(TYPE, NAME)                                               \
   TYPE NAME##_bottom(NAME* stack)                                             \
   {                                                                           \
+    DS_STATS_COUNT(stack, ACCESS);                                            \
     return stack->stack[0];                                                   \
   }
 
@@ -368,13 +446,34 @@ typedef char bool;
 # define STACK_PUSH(TYPE, NAME)                                               \
   void NAME##_push(NAME* stack, TYPE elt)                                     \
   {                                                                           \
-    if (stack->count >= stack->size - 1)                                      \
+    DS_STATS_START(stats_start);                                              \
+    unsigned size = stack->size + stack->size / 2;                            \
+    TYPE* array = NULL;                                                       \
+                                                                              \
+    if (stack->count + 1 >= stack->size || stack->snapshot)                   \
     {                                                                         \
-        stack->size += stack->size / 2;                                       \
-        stack->stack = realloc(stack->stack, stack->size * sizeof (TYPE));    \
+      if (size < stack->count + 2)                                            \
+        size = stack->count + 2;                                              \
+                                                                              \
+      if (!stack->snapshot)                                                   \
+        array = realloc(stack->stack, size * sizeof (TYPE));                  \
+      else if ((array = malloc(size * sizeof (TYPE))))                        \
+      {                                                                       \
+        memcpy(array, stack->stack, stack->count * sizeof (TYPE));            \
+        ds_snapshot_unmap(stack->snapshot);                                   \
+        stack->snapshot = NULL;                                               \
+      }                                                                       \
+                                                                              \
+      if (!array)                                                             \
+        return;                                                               \
+      DS_STATS_REALLOC(stack, stack->size * sizeof (TYPE));                   \
+      stack->stack = array;                                                   \
+      stack->size = size;                                                     \
     }                                                                         \
                                                                               \
     stack->stack[stack->count++] = elt;                                       \
+    DS_STATS_STOP(stack, INSERT, stats_start);                                \
+    DS_STATS_SIZE(stack, stack->count);                                       \
   }
 
 
@@ -390,7 +489,11 @@ typedef char bool;
 # define STACK_POP(TYPE, NAME)                                                \
   TYPE NAME##_pop(NAME* stack)                                                \
   {                                                                           \
-    return stack->stack[--stack->count];                                      \
+    DS_STATS_START(stats_start);                                              \
+    TYPE elt = stack->stack[--stack->count];                                  \
+                                                                              \
+    DS_STATS_STOP(stack, ERASE, stats_start);                                 \
+    return elt;                                                               \
   }
 
 
@@ -0,0 +1,210 @@
+/******************************************************************************
+**                                                                           **
+**    Compile-time instrumentation of the containers                         **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file stats.hxx
+**
+** @author Remi BERSON
+**
+** @brief This file contains the instrumentation shared by the vectors,
+**  lists, queues and stacks. When DS_STATS is defined (compile with
+**  -DDS_STATS), each of these structures embeds a struct ds_stats, that
+**  counts :
+**
+**    ~ the operations, by kind (insert, erase, access, visit, clear), and
+**      the latency of each one in a log2 histogram of nanoseconds (accesses
+**      are only counted : timing them would cost much more than them),
+**    ~ the reallocations of the array, and the bytes they may have copied,
+**    ~ the high-water mark of the number of elements,
+**    ~ the nodes walked by NAME_insert in lists.
+**
+**  NAME_stats(container, out) prints them, with the capacity left unused.
+**  Latencies are read from the POSIX monotonic clock, so an instrumented
+**  build needs _POSIX_C_SOURCE (-D_POSIX_C_SOURCE=200809L).
+**
+**  When DS_STATS is not defined, every macro of this file expands to
+**  nothing : the structures, the functions and their cost are exactly the
+**  ones of an uninstrumented build, and NAME_stats does not exist.
+*/
+
+
+#ifndef STATS_HXX_
+# define STATS_HXX_
+
+# ifdef DS_STATS
+
+#  include <stdio.h>
+#  include <string.h>
+#  include <time.h>
+
+/**
+** @brief Number of buckets of the latency histograms : bucket b counts the
+**  operations that took less than 2^(b+1) ns, the last one all the others.
+*/
+#  ifndef DS_STATS_BUCKETS
+#   define DS_STATS_BUCKETS 32
+#  endif
+
+/**
+** @brief Kinds of operations.
+*/
+enum ds_op
+{
+  DS_OP_INSERT,
+  DS_OP_ERASE,
+  DS_OP_ACCESS,
+  DS_OP_VISIT,
+  DS_OP_CLEAR,
+  DS_OPS
+};
+
+/**
+** @brief Counters embedded in each instance.
+*/
+struct ds_stats
+{
+  unsigned long ops[DS_OPS];
+  unsigned long latency[DS_OPS][DS_STATS_BUCKETS];
+  unsigned long reallocs;
+  unsigned long copied;
+  unsigned long walks;
+  unsigned long walked;
+  unsigned      high_water;
+};
+
+
+/**
+** @return the time elapsed since an arbitrary point, in nanoseconds. The
+**  monotonic clock is not moved by changes of the wall clock.
+*/
+static inline long long ds_stats_now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+
+
+/**
+** @brief Count an operation of kind op, started at start.
+*/
+static inline void ds_stats_record(struct ds_stats* stats, enum ds_op op,
+                                   long long start)
+{
+  long long ns = ds_stats_now() - start;
+  unsigned bucket = 0;
+
+  while (ns > 1 && bucket < DS_STATS_BUCKETS - 1)
+  {
+    ns >>= 1;
+    bucket++;
+  }
+
+  stats->ops[op]++;
+  stats->latency[op][bucket]++;
+}
+
+
+/**
+** @brief Print the counters of the container name, which holds count
+**  elements of size bytes in an array of capacity elements.
+*/
+static inline void ds_stats_print(const struct ds_stats* stats,
+                                  const char* name, unsigned count,
+                                  unsigned capacity, size_t size, FILE* out)
+{
+  static const char* ops[DS_OPS] =
+  {
+    "insert", "erase", "access", "visit", "clear"
+  };
+
+  fprintf(out, "%s : %u elements, capacity %u (%lu bytes unused), "
+          "high-water mark %u\n", name, count, capacity,
+          (unsigned long)((capacity - count) * size), stats->high_water);
+  fprintf(out, "  %lu reallocations, %lu bytes copied\n", stats->reallocs,
+          stats->copied);
+  if (stats->walks)
+    fprintf(out, "  insert walked %.1f nodes on average (%lu calls)\n",
+            (double)stats->walked / stats->walks, stats->walks);
+
+  for (unsigned op = 0; op < DS_OPS; op++)
+  {
+    if (!stats->ops[op])
+      continue;
+
+    fprintf(out, "  %-6s %10lu", ops[op], stats->ops[op]);
+    for (unsigned b = 0; b < DS_STATS_BUCKETS; b++)
+      if (stats->latency[op][b])
+        fprintf(out, " [<%lluns %lu]", 2ull << b, stats->latency[op][b]);
+    fprintf(out, "\n");
+  }
+}
+
+
+/**
+** @brief Hooks used by the containers. C is the container, OP one of
+**  INSERT, ERASE, ACCESS, VISIT or CLEAR, and T the name of the local
+**  variable holding the start time of the operation.
+*/
+#  define DS_STATS_MEMBER struct ds_stats stats;
+#  define DS_STATS_INIT(C) memset(&(C)->stats, 0, sizeof (struct ds_stats))
+#  define DS_STATS_START(T) long long T = ds_stats_now()
+#  define DS_STATS_STOP(C, OP, T) ds_stats_record(&(C)->stats, DS_OP_##OP, T)
+#  define DS_STATS_COUNT(C, OP) ((C)->stats.ops[DS_OP_##OP]++)
+#  define DS_STATS_REALLOC(C, BYTES)                                          \
+  ((C)->stats.reallocs++, (C)->stats.copied += (BYTES))
+#  define DS_STATS_WALK(C, N)                                                 \
+  ((C)->stats.walks++, (C)->stats.walked += (N))
+#  define DS_STATS_SIZE(C, N)                                                 \
+  ((C)->stats.high_water < (N) ? (C)->stats.high_water = (N) : 0)
+
+/**
+** @brief Declare and define NAME_stats, for a container whose number of
+**  elements and capacity are the fields COUNT and CAPACITY.
+*/
+#  define DS_STATS_HEADER(NAME)                                               \
+  void NAME##_stats(NAME* container, FILE* out);
+
+#  define DS_STATS_SOURCE(TYPE, NAME, COUNT, CAPACITY)                        \
+  void NAME##_stats(NAME* container, FILE* out)                               \
+  {                                                                           \
+    ds_stats_print(&container->stats, #NAME, container->COUNT,                \
+                   container->CAPACITY, sizeof (TYPE), out);                  \
+  }
+
+# else
+
+#  define DS_STATS_MEMBER
+#  define DS_STATS_INIT(C) ((void)0)
+#  define DS_STATS_START(T)
+#  define DS_STATS_STOP(C, OP, T) ((void)0)
+#  define DS_STATS_COUNT(C, OP) ((void)0)
+#  define DS_STATS_REALLOC(C, BYTES) ((void)0)
+#  define DS_STATS_WALK(C, N) ((void)0)
+#  define DS_STATS_SIZE(C, N) ((void)0)
+#  define DS_STATS_HEADER(NAME)
+#  define DS_STATS_SOURCE(TYPE, NAME, COUNT, CAPACITY)
+
+# endif /* !DS_STATS */
+
+#endif /* !STATS_HXX_ */
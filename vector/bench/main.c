@@ -0,0 +1,124 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for large vectors                                       **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "vec.h"
+
+/// @brief Number of elements of a vector of one GB.
+#define GB ((1u << 30) / sizeof (uint64_t))
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+/// @brief This macro will be replaced by the benchmark of the vector NAME :
+//  fill it with n elements pushed one by one from the default capacity,
+//  then sum them in a linear scan (reading the array directly, so that the
+//  loop is as tight as it can be).
+//
+//  @return TRUE with the elapsed seconds in fill and scan, or FALSE if the
+//  vector could not grow that much.
+#define BENCH_VECTOR(NAME)                                                    \
+  static bool                                                                 \
+  bench_##NAME(unsigned n, double* fill, double* scan)                        \
+  {                                                                           \
+    NAME* vector = NAME##_create();                                           \
+    uint64_t sum = 0;                                                         \
+                                                                              \
+    *fill = now();                                                            \
+    for (unsigned i = 0; i < n; i++)                                          \
+      NAME##_push_back(vector, i);                                            \
+    *fill = now() - *fill;                                                    \
+                                                                              \
+    if (NAME##_size(vector) != n)                                             \
+    {                                                                         \
+      NAME##_delete(vector, NULL);                                            \
+      return FALSE;                                                           \
+    }                                                                         \
+                                                                              \
+    *scan = now();                                                            \
+    for (unsigned i = 0; i < n; i++)                                          \
+      sum += vector->array[i];                                                \
+    *scan = now() - *scan;                                                    \
+                                                                              \
+    fprintf(stderr, "%lu\r", (unsigned long)sum);                             \
+    NAME##_delete(vector, NULL);                                              \
+    return TRUE;                                                              \
+  }
+
+BENCH_VECTOR(heap_vector)
+BENCH_VECTOR(big_vector)
+
+
+/// @brief Print the fill time (s) and the scan bandwidth (GB/s) of one run.
+static void
+print(bool ok, double fill, double scan, unsigned gb)
+{
+  if (ok)
+    printf("   %8.2f %8.2f", fill, gb / scan);
+  else
+    printf("   %8s %8s", "failed", "-");
+}
+
+
+/// @brief Main function to benchmark vectors of 1 GB to max GB (16 by
+//  default, the most that unsigned indices can address with 8 bytes
+//  elements), plain against large-vector mode.
+//  Usage : ./bench [max]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned max = 16;
+  double fill = 0;
+  double scan = 0;
+  bool ok = FALSE;
+
+  if (argc > 1)
+    max = strtoul(argv[1], NULL, 10);
+  if (max > 16)
+    max = 16;
+
+  printf("\033[33m > Vectors of uint64_t, realloc vs mmap/mremap "
+         "(fill in s, scan in GB/s)\033[37m :\n\n");
+  printf("%4s   %8s %8s   %8s %8s\n", "GB", "realloc", "scan", "mremap",
+         "scan");
+
+  for (unsigned gb = 1; gb <= max; gb *= 2)
+  {
+    printf("%4u", gb);
+    ok = bench_heap_vector(gb * GB, &fill, &scan);
+    print(ok, fill, scan, gb);
+    ok = bench_big_vector(gb * GB, &fill, &scan);
+    print(ok, fill, scan, gb);
+    printf("\n");
+    fflush(stdout);
+  }
+
+  return 0;
+}
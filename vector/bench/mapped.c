@@ -0,0 +1,27 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for large vectors                                       **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+/// @brief Arrays of 64 MB and more are mapped and grown with mremap.
+#define VECTOR_MMAP_THRESHOLD (64 << 20)
+
+#include "vec.h"
+
+/// @brief This macro call will be replaced at compile-time by the
+//  definitions of the functions of the vector in large-vector mode.
+VECTOR_SOURCE(uint64_t, big_vector)
@@ -0,0 +1,118 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for large vectors                                       **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <stdint.h>
+#include "../vector.hxx"
+
+/// @brief This macro calls will be replaced at compile-time by the numeric
+//  vector of uint64_t and its kernels.
+VECTOR_NUMERIC_HEADER(uint64_t, num_vector)
+VECTOR_NUMERIC_SOURCE(uint64_t, num_vector)
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+/// @brief Visitor adding each element to the sum at data.
+static void
+add(uint64_t elt, void* data)
+{
+  *(uint64_t*)data += elt;
+}
+
+
+/// @brief Print the bandwidth (GB/s) of a scan of n elements that took
+//  seconds, after its result.
+static void
+print(const char* what, uint64_t result, unsigned n, double seconds)
+{
+  fprintf(stderr, "%lu\r", (unsigned long)result);
+  printf("%-24s %8.2f\n", what, n * sizeof (uint64_t) / seconds / 1e9);
+  fflush(stdout);
+}
+
+
+/// @brief Main function to benchmark the scans of a vector of n elements
+//  (100M by default) : NAME_visit, then each kernel on pools of 1, 2, 4...
+//  threads, up to the number of online processors.
+//  Usage : ./scan [n]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned n = 100000000;
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  num_vector* vector = NULL;
+  uint64_t sum = 0;
+  double t = 0;
+  char what[32];
+
+  if (argc > 1)
+    n = strtoul(argv[1], NULL, 10);
+  if (!(vector = num_vector_ncreate(n)))
+    return 1;
+  for (unsigned i = 0; i < n; i++)
+    num_vector_push_back(vector, i);
+
+  printf("\033[33m > Scans of %u uint64_t (GB/s)\033[37m :\n\n", n);
+
+  t = now();
+  num_vector_visit(vector, add, &sum);
+  print("visit", sum, n, now() - t);
+
+  for (unsigned threads = 1; threads <= online || threads == 1; threads *= 2)
+  {
+    struct ds_pool* pool = ds_pool_create(threads);
+
+    t = now();
+    sum = num_vector_sum(vector, pool);
+    sprintf(what, "sum, %u threads", threads);
+    print(what, sum, n, now() - t);
+
+    t = now();
+    sum = num_vector_max(vector, pool);
+    sprintf(what, "max, %u threads", threads);
+    print(what, sum, n, now() - t);
+
+    t = now();
+    sum = num_vector_count_if(vector, pool, n / 4, n / 2);
+    sprintf(what, "count_if, %u threads", threads);
+    print(what, sum, n, now() - t);
+
+    t = now();
+    sum = num_vector_find(vector, pool, n - 1);
+    sprintf(what, "find, %u threads", threads);
+    print(what, sum, n, now() - t);
+
+    ds_pool_delete(pool);
+  }
+
+  num_vector_delete(vector, NULL);
+  return 0;
+}
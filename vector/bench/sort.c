@@ -0,0 +1,160 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for the sorting of vectors                              **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <stdint.h>
+#include "../vector.hxx"
+
+/// @brief Compare unsigned 64 bits elements, as a macro (for the ordered
+//  vector) and as a function (for qsort and bsearch).
+#define CMP_U64(a, b) (((a) > (b)) - ((a) < (b)))
+
+static int
+cmp_u64(const void* a, const void* b)
+{
+  return CMP_U64(*(const uint64_t*)a, *(const uint64_t*)b);
+}
+
+/// @brief This macro calls will be replaced at compile-time by a numeric
+//  vector (radix sort) and an ordered vector (introsort) of uint64_t.
+VECTOR_NUMERIC_HEADER(uint64_t, num_vector)
+VECTOR_NUMERIC_SOURCE(uint64_t, num_vector)
+VECTOR_ORDERED_HEADER(uint64_t, CMP_U64, ord_vector)
+VECTOR_ORDERED_SOURCE(uint64_t, CMP_U64, ord_vector)
+
+/// @brief Number of lookups of the searches.
+#define LOOKUPS 10000000
+
+
+/// @brief splitmix64, to fill the vectors and pick the searched elements.
+static uint64_t
+mix(uint64_t i)
+{
+  uint64_t z = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+/// @brief Print the time (ns/element) of a sort of n elements that took
+//  seconds, and check that the array is sorted.
+static void
+print(const char* what, const uint64_t* elts, unsigned n, double seconds)
+{
+  for (unsigned i = 1; i < n; i++)
+    if (elts[i - 1] > elts[i])
+    {
+      printf("%-24s not sorted\n", what);
+      return;
+    }
+  printf("%-24s %8.2f\n", what, seconds * 1e9 / n);
+  fflush(stdout);
+}
+
+
+/// @brief Main function to benchmark the sorts of n random uint64_t (10M
+//  by default) : qsort, then the introsort of ordered vectors and the
+//  radix sort of numeric vectors on pools of 1, 2, 4... threads, up to the
+//  number of online processors. Then LOOKUPS searches with bsearch and
+//  NAME_lower_bound.
+//  Usage : ./sort [n]
+///
+/// @return 0 if all went ok, 1 otherwise
+int
+main(int argc, char** argv)
+{
+  unsigned n = 10000000;
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  num_vector* num = NULL;
+  ord_vector* ord = NULL;
+  uint64_t sum = 0;
+  uint64_t elt = 0;
+  double t = 0;
+  char what[32];
+
+  if (argc > 1)
+    n = strtoul(argv[1], NULL, 10);
+  if (!(num = num_vector_ncreate(n)) || !(ord = ord_vector_ncreate(n)))
+    return 1;
+  for (unsigned i = 0; i < n; i++)
+  {
+    num_vector_push_back(num, mix(i));
+    ord_vector_push_back(ord, mix(i));
+  }
+
+  printf("\033[33m > Sorts of %u uint64_t (ns/element)\033[37m :\n\n", n);
+
+  t = now();
+  qsort(num->array, n, sizeof (uint64_t), cmp_u64);
+  print("qsort", num->array, n, now() - t);
+
+  for (unsigned threads = 1; threads <= online || threads == 1; threads *= 2)
+  {
+    struct ds_pool* pool = ds_pool_create(threads);
+
+    for (unsigned i = 0; i < n; i++)
+      ord->array[i] = num->array[i] = mix(i);
+
+    t = now();
+    ord_vector_sort(ord, pool);
+    sprintf(what, "introsort, %u threads", threads);
+    print(what, ord->array, n, now() - t);
+
+    t = now();
+    num_vector_sort(num, pool);
+    sprintf(what, "radix, %u threads", threads);
+    print(what, num->array, n, now() - t);
+
+    ds_pool_delete(pool);
+  }
+
+  printf("\n\033[33m > %u lookups (ns/lookup)\033[37m :\n\n", LOOKUPS);
+
+  t = now();
+  for (unsigned i = 0; i < LOOKUPS; i++)
+  {
+    elt = mix(mix(i) % n);
+    sum += (uint64_t*)bsearch(&elt, num->array, n, sizeof (uint64_t),
+                              cmp_u64) - num->array;
+  }
+  printf("%-24s %8.2f\n", "bsearch", (now() - t) * 1e9 / LOOKUPS);
+
+  t = now();
+  for (unsigned i = 0; i < LOOKUPS; i++)
+    sum += num_vector_lower_bound(num, mix(mix(i) % n));
+  printf("%-24s %8.2f\n", "lower_bound", (now() - t) * 1e9 / LOOKUPS);
+  fprintf(stderr, "%lu\r", (unsigned long)sum);
+
+  num_vector_delete(num, NULL);
+  ord_vector_delete(ord, NULL);
+  return 0;
+}
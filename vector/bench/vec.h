@@ -0,0 +1,32 @@
+/******************************************************************************
+**                                                                           **
+**    Benchmark code for large vectors                                       **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+#ifndef VEC_H_
+# define VEC_H_
+
+# include <stdint.h>
+# include "../vector.hxx"
+
+/// @brief This macro calls will be replaced at compile-time by prototypes
+//  and struct declarations : heap_vector is a plain vector (heap.c) and
+//  big_vector the same one in large-vector mode (mapped.c).
+VECTOR_HEADER(uint64_t, heap_vector)
+VECTOR_HEADER(uint64_t, big_vector)
+
+#endif /* !VEC_H_ */
@@ -0,0 +1,351 @@
+/******************************************************************************
+**                                                                           **
+**    C++ front-end of the array-based, dynamic vector                       **
+**                                                                           **
+**    Copyright (C) 2011-2012  Remi BERSON                                   **
+**                                                                           **
+**    This program is free software: you can redistribute it and/or modify   **
+**    it under the terms of the GNU General Public License as published by   **
+**    the Free Software Foundation, either version 3 of the License, or      **
+**    (at your option) any later version.                                    **
+**                                                                           **
+**    This program is distributed in the hope that it will be useful,        **
+**    but WITHOUT ANY WARRANTY; without even the implied warranty of         **
+**    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          **
+**    GNU General Public License for more details.                           **
+**                                                                           **
+**    You should have received a copy of the GNU General Public License      **
+**    along with this program.  If not, see <http://www.gnu.org/licenses/>.  **
+**                                                                           **
+******************************************************************************/
+
+
+/**
+** @file vector.hpp
+**
+** @author Remi BERSON
+**
+** @brief This file contains ds::vector, the C++ counterpart of the vectors
+**  of vector.hxx (see cxx/memory.hpp for what the C++ containers have in
+**  common). Its members are the ones of the structure of VECTOR_HEADER :
+**  the array, its capacity, the number of elements, the length in bytes
+**  of the array and the snapshot pointer (always null here), but not the
+**  counters of -DDS_STATS. The array grows by Growth::grow, 1.5x by default
+**  as in VECTOR_GROW.
+**
+**  The C functions generated by the macros are not affected by this file,
+**  which does not include vector.hxx.
+*/
+
+
+#ifndef VECTOR_HPP_
+# define VECTOR_HPP_
+
+# include <algorithm>
+# include "../cxx/memory.hpp"
+
+namespace ds
+{
+  template <typename T, typename Alloc = malloc_allocator<T>,
+            typename Growth = vector_growth>
+  class vector : private Alloc
+  {
+    using traits = std::allocator_traits<Alloc>;
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = unsigned;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Construction / Destruction
+
+    /**
+    ** @brief Create an empty vector with room for size elements (as
+    **  NAME_ncreate does).
+    */
+    explicit vector(unsigned size = Growth::initial,
+                    const Alloc& alloc = Alloc())
+      : Alloc(alloc), array_(nullptr), capacity_(0), count_(0), bytes_(0),
+        snapshot_(nullptr)
+    {
+      reserve(Growth::grow(0, size));
+    }
+
+    vector(const vector& other)
+      : vector(other.count_, traits::select_on_container_copy_construction(
+                                static_cast<const Alloc&>(other)))
+    {
+      for (; count_ < other.count_; count_++)
+        new (array_ + count_) T(other.array_[count_]);
+    }
+
+    vector(vector&& other) noexcept
+      : Alloc(std::move(static_cast<Alloc&>(other))), array_(other.array_),
+        capacity_(other.capacity_), count_(other.count_),
+        bytes_(other.bytes_), snapshot_(nullptr)
+    {
+      other.array_ = nullptr;
+      other.capacity_ = 0;
+      other.count_ = 0;
+      other.bytes_ = 0;
+    }
+
+    vector& operator=(vector other) noexcept
+    {
+      swap(other);
+      return *this;
+    }
+
+    ~vector()
+    {
+      clear();
+      if (array_)
+        traits::deallocate(*this, array_, capacity_);
+    }
+
+    // Visiting
+
+    /**
+    ** @brief Call visit(elt) on each element, from the first one to the
+    **  last one. The visitor is a template parameter (a lambda, a function
+    **  object...) : its call is inlined in the loop.
+    */
+    template <typename Visitor>
+    void visit(Visitor&& visit)
+    {
+      for (unsigned i = 0; i < count_; i++)
+        visit(array_[i]);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visit) const
+    {
+      for (unsigned i = 0; i < count_; i++)
+        visit(static_cast<const T&>(array_[i]));
+    }
+
+    // Capacity
+
+    unsigned size() const noexcept
+    {
+      return count_;
+    }
+
+    unsigned capacity() const noexcept
+    {
+      return capacity_;
+    }
+
+    bool empty() const noexcept
+    {
+      return !count_;
+    }
+
+    /**
+    ** @brief Set the capacity to at least capacity elements.
+    */
+    void reserve(unsigned capacity)
+    {
+      if (capacity > capacity_ || !array_)
+        relocate(capacity);
+    }
+
+    /**
+    ** @brief Reduce the capacity to the number of elements.
+    */
+    void shrink_to_fit()
+    {
+      if (count_ < capacity_)
+        relocate(count_);
+    }
+
+    /**
+    ** @brief Destroy the elements past ns, or append copies of elt up to
+    **  ns elements.
+    */
+    void resize(unsigned ns, const T& elt = T())
+    {
+      if (ns > capacity_)
+        relocate(Growth::grow(capacity_, ns));
+      for (; count_ < ns; count_++)
+        new (array_ + count_) T(elt);
+      std::destroy(array_ + ns, array_ + count_);
+      count_ = ns;
+    }
+
+    // Element access
+
+    T& operator[](unsigned pos) noexcept
+    {
+      return array_[pos];
+    }
+
+    const T& operator[](unsigned pos) const noexcept
+    {
+      return array_[pos];
+    }
+
+    T& front() noexcept
+    {
+      return array_[0];
+    }
+
+    T& back() noexcept
+    {
+      return array_[count_ - 1];
+    }
+
+    T* data() noexcept
+    {
+      return array_;
+    }
+
+    iterator begin() noexcept
+    {
+      return array_;
+    }
+
+    iterator end() noexcept
+    {
+      return array_ + count_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+      return array_;
+    }
+
+    const_iterator end() const noexcept
+    {
+      return array_ + count_;
+    }
+
+    // Modifiers
+
+    void push_back(const T& elt)
+    {
+      emplace_back(elt);
+    }
+
+    void push_back(T&& elt)
+    {
+      emplace_back(std::move(elt));
+    }
+
+    /**
+    ** @brief Construct an element from args at the end of the vector. If
+    **  the array has to grow, the element is built before, as args may
+    **  refer to an element of the vector.
+    */
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+      if (count_ == capacity_)
+      {
+        T elt(std::forward<Args>(args)...);
+
+        relocate(Growth::grow(capacity_, count_ + 1));
+        return *new (array_ + count_++) T(std::move(elt));
+      }
+
+      return *new (array_ + count_++) T(std::forward<Args>(args)...);
+    }
+
+    void insert(unsigned pos, const T& elt)
+    {
+      emplace(pos, elt);
+    }
+
+    void insert(unsigned pos, T&& elt)
+    {
+      emplace(pos, std::move(elt));
+    }
+
+    /**
+    ** @brief Construct an element from args before position pos (at the
+    **  end if pos >= size). The following elements are moved by one.
+    */
+    template <typename... Args>
+    T& emplace(unsigned pos, Args&&... args)
+    {
+      if (pos >= count_)
+        return emplace_back(std::forward<Args>(args)...);
+
+      T elt(std::forward<Args>(args)...);
+
+      if (count_ == capacity_)
+        relocate(Growth::grow(capacity_, count_ + 1));
+
+      if constexpr (std::is_trivially_copyable_v<T>)
+      {
+        std::memmove(static_cast<void*>(array_ + pos + 1), array_ + pos,
+                     (count_ - pos) * sizeof (T));
+        new (array_ + pos) T(std::move(elt));
+      }
+      else
+      {
+        new (array_ + count_) T(std::move(array_[count_ - 1]));
+        std::move_backward(array_ + pos, array_ + count_ - 1,
+                           array_ + count_);
+        array_[pos] = std::move(elt);
+      }
+      count_++;
+
+      return array_[pos];
+    }
+
+    /**
+    ** @brief Remove len elements from position start.
+    */
+    void erase(unsigned start, unsigned len = 1)
+    {
+      std::move(array_ + start + len, array_ + count_, array_ + start);
+      std::destroy(array_ + count_ - len, array_ + count_);
+      count_ -= len;
+    }
+
+    void pop_back() noexcept
+    {
+      array_[--count_].~T();
+    }
+
+    void clear() noexcept
+    {
+      std::destroy(array_, array_ + count_);
+      count_ = 0;
+    }
+
+    void swap(vector& other) noexcept
+    {
+      std::swap(static_cast<Alloc&>(*this), static_cast<Alloc&>(other));
+      std::swap(array_, other.array_);
+      std::swap(capacity_, other.capacity_);
+      std::swap(count_, other.count_);
+      std::swap(bytes_, other.bytes_);
+    }
+
+  private:
+    /**
+    ** @brief Set the capacity to capacity elements. This is the only place
+    **  where the array is reallocated.
+    */
+    void relocate(unsigned capacity)
+    {
+      array_ = detail::relocate(static_cast<Alloc&>(*this), array_, count_,
+                                capacity_, capacity);
+      capacity_ = capacity;
+      bytes_ = std::size_t(capacity) * sizeof (T);
+    }
+
+    T*          array_;
+    unsigned    capacity_;
+    unsigned    count_;
+    std::size_t bytes_;
+    [[maybe_unused]]
+    void*       snapshot_;
+  };
+}
+
+#endif /* !VECTOR_HPP_ */
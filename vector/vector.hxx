@@ -38,7 +38,12 @@
 #ifndef VECTOR_HXX_
 # define VECTOR_HXX_
 
+# include <limits.h>
+# include <stdint.h>
 # include <stdlib.h>
+# include <string.h>
+# include "../snapshot/snapshot.hxx"
+# include "../stats/stats.hxx"
 
 /**
 ** @brief Defines a "boolean" type. This is much pleasant to use.
@@ -48,12 +53,190 @@ typedef char bool;
 /**
 ** @brief Defines the value TRUE to use with the boolean type.
 */
-# define TRUE 1;
+# define TRUE 1
 
 /**
 ** @brief Defines the value FALSE to use with the boolean type.
 */
-# define FALSE 0;
+# define FALSE 0
+
+/**
+** @brief Large-vector mode. Define VECTOR_MMAP_THRESHOLD (in bytes) before
+**  including vector.hxx where VECTOR_SOURCE is expanded, and the arrays of
+**  at least this size are not allocated with malloc any more : they are
+**  mapped, in multiples of VECTOR_HUGE_PAGE bytes, and advised to use
+**  transparent huge pages. Such arrays grow and shrink with mremap, which
+**  moves pages instead of copying the elements, and NAME_shrink_to_fit
+**  gives their unused pages back to the system.
+**
+**  mremap is Linux specific and needs _GNU_SOURCE to be defined before any
+**  include (compile with -D_GNU_SOURCE). Without it, a mapped array that
+**  grows is copied to a new mapping.
+*/
+# ifdef VECTOR_MMAP_THRESHOLD
+#  include <sys/mman.h>
+#  ifndef VECTOR_HUGE_PAGE
+#   define VECTOR_HUGE_PAGE (2 << 20)
+#  endif
+# endif
+
+
+/**
+** @brief Threads. Define VECTOR_THREADS before including vector.hxx (or
+**  compile with -DVECTOR_THREADS and -pthread) and NAME_parallel_visit,
+**  NAME_parallel_reduce and NAME_sort share their work between the threads
+**  of the pool they are given (see pool/pool.hxx). Without it, vectors only
+**  need the C library : the pools are ignored (pass NULL) and the calling
+**  thread does all the work.
+*/
+# ifdef VECTOR_THREADS
+#  include <stdatomic.h>
+#  include "../pool/pool.hxx"
+typedef atomic_uint vector_counter;
+# else
+struct ds_pool;
+typedef unsigned vector_counter;
+# endif
+
+
+/**
+** @brief Number of threads of the pool, counting the calling one.
+*/
+static inline unsigned vector_threads(struct ds_pool* pool)
+{
+# ifdef VECTOR_THREADS
+  return ds_pool_threads(pool);
+# else
+  (void)pool;
+  return 1;
+# endif
+}
+
+
+/**
+** @brief Call job(arg, i, threads) on each thread i of the pool, as
+**  ds_pool_run does.
+*/
+static inline void vector_run(struct ds_pool* pool,
+                              void (*job)(void*, unsigned, unsigned),
+                              void* arg)
+{
+# ifdef VECTOR_THREADS
+  ds_pool_run(pool, job, arg);
+# else
+  (void)pool;
+  job(arg, 0, 1);
+# endif
+}
+
+
+/**
+** @brief In large-vector mode, return the length of the mapping holding an
+**  array of bytes bytes : bytes rounded up to the huge page size, or 0 if
+**  such an array belongs to malloc.
+*/
+static inline size_t vector_mapping(size_t bytes)
+{
+# ifdef VECTOR_MMAP_THRESHOLD
+  bytes = (bytes + VECTOR_HUGE_PAGE - 1) & ~((size_t)VECTOR_HUGE_PAGE - 1);
+  if (bytes >= (size_t)VECTOR_MMAP_THRESHOLD)
+    return bytes;
+# endif
+  (void)bytes;
+  return 0;
+}
+
+
+/**
+** @brief When set, called with the length of every allocation done by
+**  vector_realloc (malloc, realloc, mmap or mremap). These helpers are
+**  compiled where vector.hxx is included, before a harness can redefine
+**  malloc and realloc, so this is how it counts them.
+*/
+static void (*vector_alloc_hook)(size_t bytes) = NULL;
+
+
+/**
+** @brief Resize array from size bytes to *bytes bytes, as realloc does. A
+**  mapped array gets *bytes rounded up to the length of its mapping, and
+**  arrays crossing the threshold move between malloc and a mapping.
+**
+** @return the new array, or NULL if the allocation failed (array is then
+**  left untouched).
+*/
+static inline void* vector_realloc(void* array, size_t size, size_t* bytes)
+{
+# ifdef VECTOR_MMAP_THRESHOLD
+  size_t from = vector_mapping(size);
+  size_t to = vector_mapping(*bytes);
+  void* mapped = MAP_FAILED;
+
+  if (to)
+  {
+#  ifdef MREMAP_MAYMOVE
+    if (from)
+      mapped = mremap(array, from, to, MREMAP_MAYMOVE);
+    else
+#  endif
+    {
+      mapped = mmap(NULL, to, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mapped != MAP_FAILED && array)
+      {
+        memcpy(mapped, array, size < to ? size : to);
+        if (from)
+          munmap(array, from);
+        else
+          free(array);
+      }
+    }
+
+    if (mapped == MAP_FAILED)
+      return NULL;
+    if (vector_alloc_hook)
+      vector_alloc_hook(to);
+#  ifdef MADV_HUGEPAGE
+    madvise(mapped, to, MADV_HUGEPAGE);
+#  endif
+    *bytes = to;
+    return mapped;
+  }
+
+  if (from)
+  {
+    if ((mapped = malloc(*bytes ? *bytes : 1)))
+    {
+      if (vector_alloc_hook)
+        vector_alloc_hook(*bytes);
+      memcpy(mapped, array, *bytes < size ? *bytes : size);
+      munmap(array, from);
+    }
+    return mapped;
+  }
+# endif
+
+  (void)size;
+  if (vector_alloc_hook)
+    vector_alloc_hook(*bytes);
+  return realloc(array, *bytes ? *bytes : 1);
+}
+
+
+/**
+** @brief Free an array of size bytes allocated by vector_realloc.
+*/
+static inline void vector_free(void* array, size_t size)
+{
+# ifdef VECTOR_MMAP_THRESHOLD
+  if (vector_mapping(size))
+  {
+    munmap(array, vector_mapping(size));
+    return;
+  }
+# endif
+  (void)size;
+  free(array);
+}
 
 
 /**
@@ -79,19 +262,29 @@ typedef char bool;
     TYPE* array;                                                              \
     unsigned capacity;                                                        \
     unsigned count;                                                           \
+    size_t bytes;                                                             \
+    struct ds_snapshot* snapshot;                                             \
+    DS_STATS_MEMBER                                                           \
   } NAME;                                                                     \
                                                                               \
   typedef void (*visitor_func)(TYPE, void*);                                  \
   typedef void (*destructor_func)(TYPE);                                      \
+  typedef void (*NAME##_reduce_func)(TYPE const*, unsigned, void*);           \
+  typedef void (*NAME##_combine_func)(void*, const void*);                    \
                                                                               \
   VECTOR_CREATE_HEADER(TYPE, NAME);                                           \
   VECTOR_NCREATE_HEADER(TYPE, NAME);                                          \
   VECTOR_DELETE_HEADER(TYPE, NAME);                                           \
+  DS_SNAPSHOT_HEADER(VECTOR, TYPE, NAME)                                      \
+  VECTOR_VISIT_HEADER(TYPE, NAME);                                            \
+  VECTOR_PARALLEL_VISIT_HEADER(TYPE, NAME);                                   \
+  VECTOR_PARALLEL_REDUCE_HEADER(TYPE, NAME);                                  \
   VECTOR_SIZE_HEADER(TYPE, NAME);                                             \
   VECTOR_RESIZE_HEADER(TYPE, NAME);                                           \
   VECTOR_CAPACITY_HEADER(TYPE, NAME);                                         \
   VECTOR_EMPTY_HEADER(TYPE, NAME);                                            \
   VECTOR_RESERVE_HEADER(TYPE, NAME);                                          \
+  VECTOR_SHRINK_TO_FIT_HEADER(TYPE, NAME);                                    \
   VECTOR_FRONT_HEADER(TYPE, NAME);                                            \
   VECTOR_BACK_HEADER(TYPE, NAME);                                             \
   VECTOR_AT_HEADER(TYPE, NAME);                                               \
@@ -100,9 +293,14 @@ typedef char bool;
   VECTOR_PUSH_FRONT_HEADER(TYPE, NAME);                                       \
   VECTOR_INSERT_HEADER(TYPE, NAME);                                           \
   VECTOR_ERASE_HEADER(TYPE, NAME);                                            \
+  VECTOR_APPEND_N_HEADER(TYPE, NAME);                                         \
+  VECTOR_INSERT_N_HEADER(TYPE, NAME);                                         \
+  VECTOR_ERASE_RANGE_HEADER(TYPE, NAME);                                      \
+  VECTOR_ASSIGN_RANGE_HEADER(TYPE, NAME);                                     \
   VECTOR_CLEAR_HEADER(TYPE, NAME);                                            \
   VECTOR_SWAP_VECT_HEADER(TYPE, NAME);                                        \
-  VECTOR_SWAP_HEADER(TYPE, NAME);
+  VECTOR_SWAP_HEADER(TYPE, NAME);                                             \
+  DS_STATS_HEADER(NAME)
 
 
 
@@ -114,14 +312,24 @@ typedef char bool;
 **  call the macro with the *same arguments* as in the header.
 */
 # define VECTOR_SOURCE(TYPE, NAME)                                            \
+  VECTOR_REALLOC(TYPE, NAME)                                                  \
+  VECTOR_GROW(TYPE, NAME)                                                     \
+  VECTOR_OWN(TYPE, NAME)                                                      \
+  VECTOR_OFFSET(TYPE, NAME)                                                   \
   VECTOR_CREATE(TYPE, NAME)                                                   \
   VECTOR_NCREATE(TYPE, NAME)                                                  \
   VECTOR_DELETE(TYPE, NAME)                                                   \
+  DS_SNAPSHOT_SOURCE(VECTOR, TYPE, NAME)                                      \
+  VECTOR_VISIT(TYPE, NAME)                                                    \
+  VECTOR_PARALLEL_JOBS(TYPE, NAME)                                            \
+  VECTOR_PARALLEL_VISIT(TYPE, NAME)                                           \
+  VECTOR_PARALLEL_REDUCE(TYPE, NAME)                                          \
   VECTOR_SIZE(TYPE, NAME)                                                     \
   VECTOR_RESIZE(TYPE, NAME)                                                   \
   VECTOR_CAPACITY(TYPE, NAME)                                                 \
   VECTOR_EMPTY(TYPE, NAME)                                                    \
   VECTOR_RESERVE(TYPE, NAME)                                                  \
+  VECTOR_SHRINK_TO_FIT(TYPE, NAME)                                            \
   VECTOR_FRONT(TYPE, NAME)                                                    \
   VECTOR_BACK(TYPE, NAME)                                                     \
   VECTOR_AT(TYPE, NAME)                                                       \
@@ -130,9 +338,14 @@ typedef char bool;
   VECTOR_PUSH_FRONT(TYPE, NAME)                                               \
   VECTOR_INSERT(TYPE, NAME)                                                   \
   VECTOR_ERASE(TYPE, NAME)                                                    \
+  VECTOR_APPEND_N(TYPE, NAME)                                                 \
+  VECTOR_INSERT_N(TYPE, NAME)                                                 \
+  VECTOR_ERASE_RANGE(TYPE, NAME)                                              \
+  VECTOR_ASSIGN_RANGE(TYPE, NAME)                                             \
   VECTOR_CLEAR(TYPE, NAME)                                                    \
   VECTOR_SWAP_VECT(TYPE, NAME)                                                \
-  VECTOR_SWAP(TYPE, NAME)
+  VECTOR_SWAP(TYPE, NAME)                                                     \
+  DS_STATS_SOURCE(TYPE, NAME, count, capacity)
 
 
 
@@ -153,6 +366,29 @@ typedef char bool;
 # define VECTOR_DELETE_HEADER(TYPE, NAME)                                     \
   void NAME##_delete(NAME* vector, destructor_func dest)
 
+// Snapshots
+
+# define VECTOR_SAVE_HEADER(TYPE, NAME)                                       \
+  bool NAME##_save(NAME* vector, int fd)
+
+# define VECTOR_MAP_HEADER(TYPE, NAME)                                        \
+  NAME* NAME##_map(const char* path, int flags)
+
+// Visiting
+
+# define VECTOR_VISIT_HEADER(TYPE, NAME)                                      \
+  void NAME##_visit(NAME* vector, visitor_func v, void* data)
+
+# define VECTOR_PARALLEL_VISIT_HEADER(TYPE, NAME)                             \
+  void NAME##_parallel_visit(NAME* vector, struct ds_pool* pool,              \
+                             visitor_func v, void* data)
+
+# define VECTOR_PARALLEL_REDUCE_HEADER(TYPE, NAME)                            \
+  void NAME##_parallel_reduce(NAME* vector, struct ds_pool* pool,             \
+                              NAME##_reduce_func reduce,                      \
+                              NAME##_combine_func combine,                    \
+                              void* acc, size_t size)
+
 // Capacity
 
 # define VECTOR_SIZE_HEADER(TYPE, NAME)                                       \
@@ -170,6 +406,9 @@ typedef char bool;
 # define VECTOR_RESERVE_HEADER(TYPE, NAME)                                    \
   void NAME##_reserve(NAME* vector, unsigned rs)
 
+# define VECTOR_SHRINK_TO_FIT_HEADER(TYPE, NAME)                              \
+  void NAME##_shrink_to_fit(NAME* vector)
+
 // Element access
 
 # define VECTOR_FRONT_HEADER(TYPE, NAME)                                      \
@@ -199,6 +438,21 @@ typedef char bool;
   void NAME##_erase(NAME* vector, unsigned start, unsigned len,               \
                     destructor_func d)
 
+# define VECTOR_APPEND_N_HEADER(TYPE, NAME)                                   \
+  void NAME##_append_n(NAME* vector, const TYPE* elts, unsigned n)
+
+# define VECTOR_INSERT_N_HEADER(TYPE, NAME)                                   \
+  void NAME##_insert_n(NAME* vector, unsigned pos, const TYPE* elts,          \
+                       unsigned n)
+
+# define VECTOR_ERASE_RANGE_HEADER(TYPE, NAME)                                \
+  void NAME##_erase_range(NAME* vector, unsigned first, unsigned last,        \
+                          destructor_func d)
+
+# define VECTOR_ASSIGN_RANGE_HEADER(TYPE, NAME)                               \
+  void NAME##_assign_range(NAME* vector, unsigned pos, const TYPE* elts,      \
+                           unsigned n)
+
 # define VECTOR_SWAP_VECT_HEADER(TYPE, NAME)                                  \
   void NAME##_swap_vect(NAME* vector1, NAME* vector2)
 
@@ -223,6 +477,111 @@ typedef char bool;
 // Construction / Destruction
 
 
+/**
+** @brief Set the capacity of the vector to (at least) capacity elements.
+**  This is the only place where the array is reallocated. An array mapped
+**  from a snapshot is copied to a new one, and the snapshot is unmapped.
+**  The capacity is at most UINT_MAX, so the length of the array as
+**  allocated (a mapping in large-vector mode) is kept in bytes.
+**
+** @return 0 if all went ok, 1 if the allocation failed (the vector is left
+**  untouched).
+*/
+# define VECTOR_REALLOC(TYPE, NAME)                                           \
+  static int NAME##_realloc(NAME* vector, unsigned capacity)                  \
+  {                                                                           \
+    size_t bytes = (size_t)capacity * sizeof (TYPE);                          \
+    TYPE* array = NULL;                                                       \
+                                                                              \
+    if (!vector->snapshot)                                                    \
+      array = vector_realloc(vector->array, vector->bytes, &bytes);           \
+    else if ((array = vector_realloc(NULL, 0, &bytes)))                       \
+    {                                                                         \
+      memcpy(array, vector->array,                                            \
+             (vector->count < capacity ? vector->count : capacity)            \
+             * sizeof (TYPE));                                                \
+      ds_snapshot_unmap(vector->snapshot);                                    \
+      vector->snapshot = NULL;                                                \
+    }                                                                         \
+                                                                              \
+    if (!array)                                                               \
+      return 1;                                                               \
+                                                                              \
+    DS_STATS_REALLOC(vector, (size_t)vector->capacity * sizeof (TYPE));       \
+    vector->array = array;                                                    \
+    vector->bytes = bytes;                                                    \
+    if (bytes / sizeof (TYPE) > UINT_MAX)                                     \
+      vector->capacity = UINT_MAX;                                            \
+    else                                                                      \
+      vector->capacity = bytes / sizeof (TYPE);                               \
+    return 0;                                                                 \
+  }
+
+
+/**
+** @brief Make room for at least n elements with a single reallocation. The
+**  capacity grows by at least 1.5x, so that appending batches one after
+**  the other stays amortized O(1) per element. A vector mapped from a
+**  snapshot is always copied to the heap.
+**
+** @return 0 if all went ok, 1 if the allocation failed (the vector is left
+**  untouched).
+*/
+# define VECTOR_GROW(TYPE, NAME)                                              \
+  static int NAME##_grow(NAME* vector, unsigned n)                            \
+  {                                                                           \
+    unsigned capacity = vector->capacity + vector->capacity / 2;              \
+                                                                              \
+    if (n <= vector->capacity && !vector->snapshot)                           \
+      return 0;                                                               \
+    if (capacity < vector->capacity)                                          \
+      capacity = UINT_MAX;                                                    \
+    if (capacity < n)                                                         \
+      capacity = n;                                                           \
+                                                                              \
+    return NAME##_realloc(vector, capacity);                                  \
+  }
+
+
+/**
+** @brief Copy an array mapped from a snapshot to the heap, as the first
+**  insertion does, before it is modified in place : the mapping may be
+**  read-only.
+**
+** @return 0 if the array can be written, 1 if the copy failed (the vector
+**  is left untouched).
+*/
+# define VECTOR_OWN(TYPE, NAME)                                               \
+  static int NAME##_own(NAME* vector)                                         \
+  {                                                                           \
+    if (!vector->snapshot)                                                    \
+      return 0;                                                               \
+                                                                              \
+    return NAME##_realloc(vector, vector->capacity);                          \
+  }
+
+
+/**
+** @brief Find the position of elts inside the vector, for the bulk
+**  modifiers that are given a range of the vector itself : the range must
+**  be found again once the array has been reallocated.
+**
+** @return The position of elts, or the size of the vector if elts does not
+**  point to one of its elements.
+*/
+# define VECTOR_OFFSET(TYPE, NAME)                                            \
+  static unsigned NAME##_offset(NAME* vector, const void* elts)               \
+  {                                                                           \
+    const char* array = (const char*) vector->array;                          \
+    const char* elt = elts;                                                   \
+                                                                              \
+    if (elt < array || elt >= array + vector->count * sizeof (TYPE))          \
+      return vector->count;                                                   \
+                                                                              \
+    return (elt - array) / sizeof (TYPE);                                     \
+  }
+
+
 # define VECTOR_CREATE(TYPE, NAME)                                            \
   NAME* NAME##_create()                                                       \
   {                                                                           \
@@ -238,13 +597,17 @@ typedef char bool;
     if (!(new_vector = malloc(sizeof (NAME))))                                \
       return NULL;                                                            \
                                                                               \
-    new_vector->capacity = size;                                              \
+    new_vector->array = NULL;                                                 \
+    new_vector->capacity = 0;                                                 \
     new_vector->count = 0;                                                    \
-    if (!(new_vector->array = malloc(sizeof (TYPE) * size)))                  \
+    new_vector->bytes = 0;                                                    \
+    new_vector->snapshot = NULL;                                              \
+    if (NAME##_realloc(new_vector, size))                                     \
     {                                                                         \
       free(new_vector);                                                       \
       return NULL;                                                            \
     }                                                                         \
+    DS_STATS_INIT(new_vector);                                                \
                                                                               \
     return new_vector;                                                        \
   }
@@ -254,11 +617,195 @@ typedef char bool;
   void NAME##_delete(NAME* vector, destructor_func dest)                      \
   {                                                                           \
     NAME##_clear(vector, dest);                                               \
-    free(vector->array);                                                      \
+    if (vector->snapshot)                                                     \
+      ds_snapshot_unmap(vector->snapshot);                                    \
+    else                                                                      \
+      vector_free(vector->array, vector->bytes);                              \
     free(vector);                                                             \
   }
 
 
+// Snapshots
+
+
+/**
+** @brief Write a snapshot of the vector to fd (see snapshot.hxx). TYPE must
+**  not hold pointers.
+**
+** @return TRUE (1) if all went ok, FALSE (0) if a write failed.
+*/
+# define VECTOR_SAVE(TYPE, NAME)                                              \
+  bool NAME##_save(NAME* vector, int fd)                                      \
+  {                                                                           \
+    return ds_snapshot_save(fd, sizeof (TYPE), vector->array, vector->count,  \
+                            NULL, 0);                                         \
+  }
+
+
+/**
+** @brief Create a vector whose array is the snapshot at path, mapped
+**  read-only or copy-on-write (flags are described in snapshot.hxx). The
+**  first insertion or modification copies the elements to the heap.
+**
+** @return a pointer on the new vector. If the file could not be mapped or
+**  is not a snapshot of TYPE elements, a NULL pointer is returned.
+*/
+# define VECTOR_MAP(TYPE, NAME)                                               \
+  NAME* NAME##_map(const char* path, int flags)                               \
+  {                                                                           \
+    NAME* new_vector = NULL;                                                  \
+    struct ds_snapshot* snapshot = NULL;                                      \
+    size_t count = 0;                                                         \
+                                                                              \
+    if (!(snapshot = ds_snapshot_map(path, sizeof (TYPE), flags, &count)))    \
+      return NULL;                                                            \
+    if (count > UINT_MAX || !(new_vector = malloc(sizeof (NAME))))            \
+    {                                                                         \
+      ds_snapshot_unmap(snapshot);                                            \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    new_vector->array = (TYPE*)(snapshot + 1);                                \
+    new_vector->capacity = count;                                             \
+    new_vector->count = count;                                                \
+    new_vector->bytes = 0;                                                    \
+    new_vector->snapshot = snapshot;                                          \
+    DS_STATS_INIT(new_vector);                                                \
+                                                                              \
+    return new_vector;                                                        \
+  }
+
+
+// Visiting
+
+
+/**
+** @brief Call the visitor function on each element of the vector, from the
+**  first one to the last one.
+**
+** @param data is a pointer that will be passed to the visitor at each call.
+*/
+# define VECTOR_VISIT(TYPE, NAME)                                             \
+  void NAME##_visit(NAME* vector, visitor_func v, void* data)                 \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    for (unsigned i = 0; i < vector->count; i++)                              \
+      v(vector->array[i], data);                                              \
+    DS_STATS_STOP(vector, VISIT, stats_start);                                \
+  }
+
+
+/**
+** @brief A parallel visit or reduction, as given to ds_pool_run. The array
+**  is split in as many contiguous chunks as the pool has threads, thread i
+**  takes the i-th one. The partial results of the threads 1 to n - 1 are
+**  stored one per cache line in partials, thread 0 works directly on acc.
+*/
+# define VECTOR_PARALLEL_JOBS(TYPE, NAME)                                     \
+  struct NAME##_job                                                           \
+  {                                                                           \
+    NAME* vector;                                                             \
+    visitor_func visit;                                                       \
+    void* data;                                                               \
+    NAME##_reduce_func reduce;                                                \
+    void* acc;                                                                \
+    char* partials;                                                           \
+    size_t stride;                                                            \
+  };                                                                          \
+                                                                              \
+  static void NAME##_visit_job(void* arg, unsigned index, unsigned threads)   \
+  {                                                                           \
+    struct NAME##_job* job = arg;                                             \
+    unsigned first = (size_t)job->vector->count * index / threads;            \
+    unsigned last = (size_t)job->vector->count * (index + 1) / threads;       \
+                                                                              \
+    for (unsigned i = first; i < last; i++)                                   \
+      job->visit(job->vector->array[i], job->data);                           \
+  }                                                                           \
+                                                                              \
+  static void NAME##_reduce_job(void* arg, unsigned index, unsigned threads)  \
+  {                                                                           \
+    struct NAME##_job* job = arg;                                             \
+    unsigned first = (size_t)job->vector->count * index / threads;            \
+    unsigned last = (size_t)job->vector->count * (index + 1) / threads;       \
+                                                                              \
+    if (first < last)                                                         \
+      job->reduce(job->vector->array + first, last - first,                   \
+                  index ? job->partials + (index - 1) * job->stride           \
+                        : job->acc);                                          \
+  }
+
+
+/**
+** @brief Same as NAME_visit, with the array split between the threads of
+**  the pool : the visitor is called concurrently, in no particular order
+**  across the chunks, and must be safe to call so.
+*/
+# define VECTOR_PARALLEL_VISIT(TYPE, NAME)                                    \
+  void NAME##_parallel_visit(NAME* vector, struct ds_pool* pool,              \
+                             visitor_func v, void* data)                      \
+  {                                                                           \
+    struct NAME##_job job = { vector, v, data, NULL, NULL, NULL, 0 };         \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    vector_run(pool, NAME##_visit_job, &job);                                 \
+    DS_STATS_STOP(vector, VISIT, stats_start);                                \
+  }
+
+
+/**
+** @brief Reduce the vector into acc, with the threads of the pool. Each
+**  thread calls reduce once, on its chunk of the array and on its own copy
+**  of the size bytes at acc : reduce folds the n elements into it, in a
+**  loop that the compiler can inline and vectorize (there is no call per
+**  element). The partial results are then folded into acc by combine, in
+**  the order of the chunks, so the result does not depend on the timing of
+**  the threads. Empty chunks are not reduced.
+**
+** @param acc is the initial value of every partial result : it must be
+**  neutral for combine (0 for a sum, for instance).
+**
+**  If the partial results could not be allocated, the vector is reduced by
+**  the calling thread alone.
+*/
+# define VECTOR_PARALLEL_REDUCE(TYPE, NAME)                                   \
+  static void NAME##_reduce(NAME* vector, struct ds_pool* pool,               \
+                            NAME##_reduce_func reduce,                        \
+                            NAME##_combine_func combine,                      \
+                            void* acc, size_t size)                           \
+  {                                                                           \
+    unsigned threads = vector_threads(pool);                                  \
+    struct NAME##_job job = { vector, NULL, NULL, reduce, acc, NULL,          \
+                              (size + 63) & ~(size_t)63 };                    \
+                                                                              \
+    if (threads > 1                                                           \
+        && !(job.partials = aligned_alloc(64, (threads - 1) * job.stride)))   \
+      pool = NULL;                                                            \
+    if (pool)                                                                 \
+      for (unsigned i = 0; i + 1 < threads; i++)                              \
+        memcpy(job.partials + i * job.stride, acc, size);                     \
+                                                                              \
+    vector_run(pool, NAME##_reduce_job, &job);                                \
+                                                                              \
+    if (pool)                                                                 \
+      for (unsigned i = 0; i + 1 < threads; i++)                              \
+        combine(acc, job.partials + i * job.stride);                          \
+    free(job.partials);                                                       \
+  }                                                                           \
+                                                                              \
+  void NAME##_parallel_reduce(NAME* vector, struct ds_pool* pool,             \
+                              NAME##_reduce_func reduce,                      \
+                              NAME##_combine_func combine,                    \
+                              void* acc, size_t size)                         \
+  {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    NAME##_reduce(vector, pool, reduce, combine, acc, size);                  \
+    DS_STATS_STOP(vector, VISIT, stats_start);                                \
+  }
+
+
 // Capacity
 
 
@@ -272,16 +819,8 @@ typedef char bool;
 # define VECTOR_RESIZE(TYPE, NAME)                                            \
   void NAME##_resize(NAME* vector, unsigned ns, TYPE c, destructor_func dest) \
   {                                                                           \
-    if (ns > vector->capacity)                                                \
-    {                                                                         \
-      if (ns > (vector->capacity * 1.5))                                      \
-        vector->capacity = ns + 1;                                            \
-      else                                                                    \
-        vector->capacity += vector->capacity / 2;                             \
-                                                                              \
-      vector->array = realloc(vector->array, vector->capacity                 \
-                      * sizeof (TYPE));                                       \
-    }                                                                         \
+    if (NAME##_grow(vector, ns))                                              \
+      return;                                                                 \
                                                                               \
     if (ns < vector->count)                                                   \
     {                                                                         \
@@ -296,6 +835,7 @@ typedef char bool;
     }                                                                         \
                                                                               \
     vector->count = ns;                                                       \
+    DS_STATS_SIZE(vector, ns);                                                \
   }
 
 
@@ -317,10 +857,20 @@ typedef char bool;
   void NAME##_reserve(NAME* vector, unsigned rs)                              \
   {                                                                           \
     if (rs > vector->capacity)                                                \
-    {                                                                         \
-      vector->capacity = ++rs;                                                \
-      vector->array = realloc(vector->array, rs * sizeof (TYPE));             \
-    }                                                                         \
+      NAME##_realloc(vector, rs + 1);                                         \
+  }
+
+
+/**
+** @brief Reduce the capacity of the vector to its size. In large-vector
+**  mode, the pages of a mapped array past its last element are given back
+**  to the system.
+*/
+# define VECTOR_SHRINK_TO_FIT(TYPE, NAME)                                     \
+  void NAME##_shrink_to_fit(NAME* vector)                                     \
+  {                                                                           \
+    if (vector->count < vector->capacity)                                     \
+      NAME##_realloc(vector, vector->count);                                  \
   }
 
 
@@ -330,6 +880,7 @@ typedef char bool;
 # define VECTOR_FRONT(TYPE, NAME)                                             \
   TYPE NAME##_front(NAME* vector)                                             \
   {                                                                           \
+    DS_STATS_COUNT(vector, ACCESS);                                           \
     return vector->array[0];                                                  \
   }
 
@@ -337,6 +888,7 @@ typedef char bool;
 # define VECTOR_BACK(TYPE, NAME)                                              \
   TYPE NAME##_back(NAME* vector)                                              \
   {                                                                           \
+    DS_STATS_COUNT(vector, ACCESS);                                           \
     return vector->array[vector->count - 1];                                  \
   }
 
@@ -344,6 +896,7 @@ typedef char bool;
 # define VECTOR_AT(TYPE, NAME)                                                \
   TYPE NAME##_at(NAME* vector, unsigned pos)                                  \
   {                                                                           \
+    DS_STATS_COUNT(vector, ACCESS);                                           \
     return vector->array[pos];                                                \
   }
 
@@ -356,7 +909,7 @@ typedef char bool;
   {                                                                           \
     if (n >= vector->count)                                                   \
       NAME##_push_back(vector, elt);                                          \
-    else                                                                      \
+    else if (!NAME##_own(vector))                                             \
       vector->array[n] = elt;                                                 \
   }
 
@@ -364,14 +917,15 @@ typedef char bool;
 # define VECTOR_PUSH_BACK(TYPE, NAME)                                         \
   void NAME##_push_back(NAME* vector, TYPE elt)                               \
   {                                                                           \
-    if (vector->count >= vector->capacity)                                    \
-    {                                                                         \
-      vector->capacity += vector->capacity / 2;                               \
-      vector->array = realloc(vector->array, vector->capacity                 \
-                      * sizeof (TYPE));                                       \
-    }                                                                         \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if ((vector->count >= vector->capacity || vector->snapshot)               \
+        && NAME##_grow(vector, vector->count + 1))                            \
+      return;                                                                 \
                                                                               \
     vector->array[vector->count++] = elt;                                     \
+    DS_STATS_STOP(vector, INSERT, stats_start);                               \
+    DS_STATS_SIZE(vector, vector->count);                                     \
   }
 
 
@@ -385,17 +939,17 @@ typedef char bool;
 # define VECTOR_INSERT(TYPE, NAME)                                            \
   void NAME##_insert(NAME* vector, unsigned pos, TYPE elt)                    \
   {                                                                           \
-    if (vector->count >= vector->capacity)                                    \
-    {                                                                         \
-      vector->capacity += vector->capacity / 2;                               \
-      vector->array = realloc(vector->array, vector->capacity                 \
-                      * sizeof (TYPE));                                       \
-    }                                                                         \
+    DS_STATS_START(stats_start);                                              \
                                                                               \
-    for (unsigned i = vector->count++; i > pos; i--)                          \
-      vector->array[i] = vector->array[i - 1];                                \
+    if ((vector->count >= vector->capacity || vector->snapshot)               \
+        && NAME##_grow(vector, vector->count + 1))                            \
+      return;                                                                 \
                                                                               \
+    memmove(vector->array + pos + 1, vector->array + pos,                     \
+            (vector->count++ - pos) * sizeof (TYPE));                         \
     vector->array[pos] = elt;                                                 \
+    DS_STATS_STOP(vector, INSERT, stats_start);                               \
+    DS_STATS_SIZE(vector, vector->count);                                     \
   }
 
 
@@ -403,13 +957,126 @@ typedef char bool;
   void NAME##_erase(NAME* vector, unsigned start, unsigned len,               \
                     destructor_func d)                                        \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if (NAME##_own(vector))                                                   \
+      return;                                                                 \
     if (d)                                                                    \
       for (unsigned i = start; i < start + len; i++)                          \
         d(vector->array[i]);                                                  \
-    for (unsigned i = start + len; i < vector->count; i++)                    \
-      vector->array[i - len] = vector->array[i];                              \
-                                                                              \
+    memmove(vector->array + start, vector->array + start + len,               \
+            (vector->count - start - len) * sizeof (TYPE));                   \
     vector->count -= len;                                                     \
+    DS_STATS_STOP(vector, ERASE, stats_start);                                \
+  }
+
+
+// Bulk modifiers
+
+
+/**
+** @brief Append the n elements of elts at the end of the vector. elts may
+**  point inside the vector itself.
+*/
+# define VECTOR_APPEND_N(TYPE, NAME)                                          \
+  void NAME##_append_n(NAME* vector, const TYPE* elts, unsigned n)            \
+  {                                                                           \
+    unsigned offset = NAME##_offset(vector, elts);                            \
+    const void* src = elts;                                                   \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if (n > UINT_MAX - vector->count                                          \
+        || NAME##_grow(vector, vector->count + n))                            \
+      return;                                                                 \
+                                                                              \
+    if (offset < vector->count)                                               \
+      src = vector->array + offset;                                           \
+    memcpy(vector->array + vector->count, src, n * sizeof (TYPE));            \
+    vector->count += n;                                                       \
+    DS_STATS_STOP(vector, INSERT, stats_start);                               \
+    DS_STATS_SIZE(vector, vector->count);                                     \
+  }
+
+
+/**
+** @brief Insert the n elements of elts before position pos (at the end if
+**  pos >= size). Following elements are moved once, with memmove. elts
+**  may point inside the vector itself.
+*/
+# define VECTOR_INSERT_N(TYPE, NAME)                                          \
+  void NAME##_insert_n(NAME* vector, unsigned pos, const TYPE* elts,          \
+                       unsigned n)                                            \
+  {                                                                           \
+    unsigned offset = NAME##_offset(vector, elts);                            \
+    unsigned head = 0;                                                        \
+    const void* src = elts;                                                   \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if (pos > vector->count)                                                  \
+      pos = vector->count;                                                    \
+    if (n > UINT_MAX - vector->count                                          \
+        || NAME##_grow(vector, vector->count + n))                            \
+      return;                                                                 \
+                                                                              \
+    memmove(vector->array + pos + n, vector->array + pos,                     \
+            (vector->count - pos) * sizeof (TYPE));                           \
+    if (offset < vector->count)                                               \
+    {                                                                         \
+      /* The elements from pos on have just been moved n places further */    \
+      if (offset < pos)                                                       \
+        head = offset + n > pos ? pos - offset : n;                           \
+      memcpy(vector->array + pos, vector->array + offset,                     \
+             head * sizeof (TYPE));                                           \
+      src = vector->array + offset + head + n;                                \
+    }                                                                         \
+    memcpy(vector->array + pos + head, src, (n - head) * sizeof (TYPE));      \
+    vector->count += n;                                                       \
+    DS_STATS_STOP(vector, INSERT, stats_start);                               \
+    DS_STATS_SIZE(vector, vector->count);                                     \
+  }
+
+
+/**
+** @brief Remove the elements in [first, last[, calling the destructor on
+**  each of them if one is given.
+*/
+# define VECTOR_ERASE_RANGE(TYPE, NAME)                                       \
+  void NAME##_erase_range(NAME* vector, unsigned first, unsigned last,        \
+                          destructor_func d)                                  \
+  {                                                                           \
+    if (last > vector->count)                                                 \
+      last = vector->count;                                                   \
+    if (first < last)                                                         \
+      NAME##_erase(vector, first, last - first, d);                           \
+  }
+
+
+/**
+** @brief Overwrite the elements from position pos with the n elements of
+**  elts. As NAME_assign, the elements that fall after the end of the
+**  vector are appended (pos is clamped to the size of the vector). elts may
+**  point inside the vector itself.
+*/
+# define VECTOR_ASSIGN_RANGE(TYPE, NAME)                                      \
+  void NAME##_assign_range(NAME* vector, unsigned pos, const TYPE* elts,      \
+                           unsigned n)                                        \
+  {                                                                           \
+    unsigned offset = NAME##_offset(vector, elts);                            \
+    const void* src = elts;                                                   \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if (pos > vector->count)                                                  \
+      pos = vector->count;                                                    \
+    if (n > UINT_MAX - pos || NAME##_grow(vector, pos + n))                   \
+      return;                                                                 \
+                                                                              \
+    if (offset < vector->count)                                               \
+      src = vector->array + offset;                                           \
+    memmove(vector->array + pos, src, n * sizeof (TYPE));                     \
+    if (pos + n > vector->count)                                              \
+      vector->count = pos + n;                                                \
+    DS_STATS_STOP(vector, INSERT, stats_start);                               \
+    DS_STATS_SIZE(vector, vector->count);                                     \
   }
 
 
@@ -417,15 +1084,21 @@ typedef char bool;
   void NAME##_swap_vect(NAME* vector1, NAME* vector2)                         \
   {                                                                           \
     TYPE* tmp_a = vector1->array;                                             \
+    struct ds_snapshot* tmp_s = vector1->snapshot;                            \
     unsigned tmp_cap = vector1->capacity, tmp_count = vector1->count;         \
+    size_t tmp_bytes = vector1->bytes;                                        \
                                                                               \
     vector1->array = vector2->array;                                          \
     vector1->count = vector2->count;                                          \
     vector1->capacity = vector2->capacity;                                    \
+    vector1->bytes = vector2->bytes;                                          \
+    vector1->snapshot = vector2->snapshot;                                    \
                                                                               \
     vector2->array = tmp_a;                                                   \
     vector2->count = tmp_count;                                               \
     vector2->capacity = tmp_cap;                                              \
+    vector2->bytes = tmp_bytes;                                               \
+    vector2->snapshot = tmp_s;                                                \
   }
 
 
@@ -434,6 +1107,8 @@ typedef char bool;
   {                                                                           \
     TYPE elt = vector->array[a];                                              \
                                                                               \
+    if (NAME##_own(vector))                                                   \
+      return;                                                                 \
     vector->array[a] = vector->array[b];                                      \
     vector->array[b] = elt;                                                   \
   }
@@ -442,10 +1117,884 @@ typedef char bool;
 # define VECTOR_CLEAR(TYPE, NAME)                                             \
   void NAME##_clear(NAME* vector, destructor_func dest)                       \
   {                                                                           \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
     if (dest)                                                                 \
       for (unsigned i = 0; i < vector->count; i++)                            \
         dest(vector->array[i]);                                               \
     vector->count = 0;                                                        \
+    DS_STATS_STOP(vector, CLEAR, stats_start);                                \
+  }
+
+
+
+/*
+ *
+ * NUMERIC VECTOR
+ *
+ */
+
+
+/**
+** @brief Number of independent accumulators of the numeric kernels. The
+**  kernels process the array by blocks of VECTOR_LANES elements, lane l of
+**  a block going to accumulator l : there is no dependency between the
+**  lanes, so the compiler turns each block into a few SIMD instructions
+**  (with -O2 and later GCC or clang, at the width allowed by -march).
+*/
+# ifndef VECTOR_LANES
+#  define VECTOR_LANES 16
+# endif
+
+
+/**
+** @brief Same as VECTOR_HEADER, for vectors of a numeric TYPE (an integer
+**  or floating point type). In addition to the functions of VECTOR_HEADER,
+**  the following ones are declared :
+**
+**    ~ NAME_sum
+**    ~ NAME_min
+**    ~ NAME_max
+**    ~ NAME_count_if
+**    ~ NAME_find
+**    ~ NAME_sort
+**    ~ NAME_lower_bound
+**    ~ NAME_binary_search
+**
+**  Each of the scans and NAME_sort take a pool (see pool.hxx) and split the
+**  array between its threads, or work alone if the pool is NULL. The
+**  sorted vector functions are defined at the end of this file.
+*/
+# define VECTOR_NUMERIC_HEADER(TYPE, NAME)                                    \
+  VECTOR_HEADER(TYPE, NAME)                                                   \
+  VECTOR_SUM_HEADER(TYPE, NAME);                                              \
+  VECTOR_MIN_HEADER(TYPE, NAME);                                              \
+  VECTOR_MAX_HEADER(TYPE, NAME);                                              \
+  VECTOR_COUNT_IF_HEADER(TYPE, NAME);                                         \
+  VECTOR_FIND_HEADER(TYPE, NAME);                                             \
+  VECTOR_SORT_HEADER(TYPE, NAME);                                             \
+  VECTOR_LOWER_BOUND_HEADER(TYPE, NAME);                                      \
+  VECTOR_BINARY_SEARCH_HEADER(TYPE, NAME);
+
+
+/**
+** @brief Same as VECTOR_SOURCE, for vectors declared with
+**  VECTOR_NUMERIC_HEADER.
+*/
+# define VECTOR_NUMERIC_SOURCE(TYPE, NAME)                                    \
+  VECTOR_SOURCE(TYPE, NAME)                                                   \
+  VECTOR_SUM(TYPE, NAME)                                                      \
+  VECTOR_EXTREMUM(TYPE, NAME, min, <)                                         \
+  VECTOR_EXTREMUM(TYPE, NAME, max, >)                                         \
+  VECTOR_COUNT_IF(TYPE, NAME)                                                 \
+  VECTOR_FIND(TYPE, NAME)                                                     \
+  VECTOR_INTROSORT(TYPE, VECTOR_NUMERIC_CMP, NAME)                            \
+  VECTOR_RADIX_SORT(TYPE, NAME)                                               \
+  VECTOR_NUMERIC_SORT(TYPE, NAME)                                             \
+  VECTOR_LOWER_BOUND(TYPE, VECTOR_NUMERIC_CMP, NAME)                          \
+  VECTOR_BINARY_SEARCH(TYPE, VECTOR_NUMERIC_CMP, NAME)
+
+
+# define VECTOR_SUM_HEADER(TYPE, NAME)                                        \
+  TYPE NAME##_sum(NAME* vector, struct ds_pool* pool)
+
+# define VECTOR_MIN_HEADER(TYPE, NAME)                                        \
+  TYPE NAME##_min(NAME* vector, struct ds_pool* pool)
+
+# define VECTOR_MAX_HEADER(TYPE, NAME)                                        \
+  TYPE NAME##_max(NAME* vector, struct ds_pool* pool)
+
+# define VECTOR_COUNT_IF_HEADER(TYPE, NAME)                                   \
+  unsigned NAME##_count_if(NAME* vector, struct ds_pool* pool,                \
+                           TYPE lo, TYPE hi)
+
+# define VECTOR_FIND_HEADER(TYPE, NAME)                                       \
+  unsigned NAME##_find(NAME* vector, struct ds_pool* pool, TYPE elt)
+
+
+/**
+** @brief Sum of the elements (0 if the vector is empty). Integers wrap
+**  around as TYPE does, and floating point elements are not added in the
+**  order of the array : the result may differ from a sequential loop by
+**  rounding, but it is the same from one call to the other with the same
+**  number of threads.
+*/
+# define VECTOR_SUM(TYPE, NAME)                                               \
+  static void NAME##_sum_chunk(const TYPE* elts, unsigned n, void* acc)       \
+  {                                                                           \
+    TYPE lanes[VECTOR_LANES] = { 0 };                                         \
+    TYPE sum = *(TYPE*)acc;                                                   \
+    unsigned i = 0;                                                           \
+                                                                              \
+    for (; i < n - n % VECTOR_LANES; i += VECTOR_LANES)                       \
+      for (unsigned l = 0; l < VECTOR_LANES; l++)                             \
+        lanes[l] += elts[i + l];                                              \
+    for (unsigned l = 0; l < VECTOR_LANES; l++)                               \
+      sum += lanes[l];                                                        \
+    for (; i < n; i++)                                                        \
+      sum += elts[i];                                                         \
+                                                                              \
+    *(TYPE*)acc = sum;                                                        \
+  }                                                                           \
+                                                                              \
+  static void NAME##_sum_combine(void* acc, const void* other)                \
+  {                                                                           \
+    *(TYPE*)acc += *(const TYPE*)other;                                       \
+  }                                                                           \
+                                                                              \
+  TYPE NAME##_sum(NAME* vector, struct ds_pool* pool)                         \
+  {                                                                           \
+    TYPE sum = 0;                                                             \
+                                                                              \
+    NAME##_parallel_reduce(vector, pool, NAME##_sum_chunk,                    \
+                           NAME##_sum_combine, &sum, sizeof (sum));           \
+    return sum;                                                               \
+  }
+
+
+/**
+** @brief Smallest (WHICH is min, OP is <) or greatest (max, >) element,
+**  or 0 if the vector is empty. The result is unspecified if the vector
+**  holds NaNs.
+*/
+# define VECTOR_EXTREMUM(TYPE, NAME, WHICH, OP)                               \
+  struct NAME##_##WHICH##_acc                                                 \
+  {                                                                           \
+    TYPE value;                                                               \
+    int seen;                                                                 \
+  };                                                                          \
+                                                                              \
+  static void NAME##_##WHICH##_chunk(const TYPE* elts, unsigned n, void* acc) \
+  {                                                                           \
+    struct NAME##_##WHICH##_acc* result = acc;                                \
+    TYPE lanes[VECTOR_LANES];                                                 \
+    TYPE best = result->seen ? result->value : elts[0];                       \
+    unsigned i = 0;                                                           \
+                                                                              \
+    for (unsigned l = 0; l < VECTOR_LANES; l++)                               \
+      lanes[l] = best;                                                        \
+    for (; i < n - n % VECTOR_LANES; i += VECTOR_LANES)                       \
+      for (unsigned l = 0; l < VECTOR_LANES; l++)                             \
+        lanes[l] = elts[i + l] OP lanes[l] ? elts[i + l] : lanes[l];          \
+    for (unsigned l = 0; l < VECTOR_LANES; l++)                               \
+      best = lanes[l] OP best ? lanes[l] : best;                              \
+    for (; i < n; i++)                                                        \
+      best = elts[i] OP best ? elts[i] : best;                                \
+                                                                              \
+    result->value = best;                                                     \
+    result->seen = 1;                                                         \
+  }                                                                           \
+                                                                              \
+  static void NAME##_##WHICH##_combine(void* acc, const void* other)          \
+  {                                                                           \
+    struct NAME##_##WHICH##_acc* result = acc;                                \
+    const struct NAME##_##WHICH##_acc* partial = other;                       \
+                                                                              \
+    if (partial->seen                                                         \
+        && (!result->seen || partial->value OP result->value))                \
+      *result = *partial;                                                     \
+  }                                                                           \
+                                                                              \
+  TYPE NAME##_##WHICH(NAME* vector, struct ds_pool* pool)                     \
+  {                                                                           \
+    struct NAME##_##WHICH##_acc result = { 0, 0 };                            \
+                                                                              \
+    NAME##_parallel_reduce(vector, pool, NAME##_##WHICH##_chunk,              \
+                           NAME##_##WHICH##_combine, &result,                 \
+                           sizeof (result));                                  \
+    return result.value;                                                      \
+  }
+
+
+/**
+** @brief Count the elements x such that lo <= x <= hi : give lo == hi to
+**  count the occurrences of a value, or the smallest (greatest) value of
+**  TYPE as lo (hi) for a one-sided test.
+*/
+# define VECTOR_COUNT_IF(TYPE, NAME)                                          \
+  struct NAME##_count_if_acc                                                  \
+  {                                                                           \
+    TYPE lo;                                                                  \
+    TYPE hi;                                                                  \
+    unsigned count;                                                           \
+  };                                                                          \
+                                                                              \
+  static void NAME##_count_if_chunk(const TYPE* elts, unsigned n, void* acc)  \
+  {                                                                           \
+    struct NAME##_count_if_acc* count = acc;                                  \
+    unsigned lanes[VECTOR_LANES] = { 0 };                                     \
+    TYPE lo = count->lo;                                                      \
+    TYPE hi = count->hi;                                                      \
+    unsigned i = 0;                                                           \
+                                                                              \
+    for (; i < n - n % VECTOR_LANES; i += VECTOR_LANES)                       \
+      for (unsigned l = 0; l < VECTOR_LANES; l++)                             \
+        lanes[l] += (elts[i + l] >= lo) & (elts[i + l] <= hi);                \
+    for (unsigned l = 0; l < VECTOR_LANES; l++)                               \
+      count->count += lanes[l];                                               \
+    for (; i < n; i++)                                                        \
+      count->count += (elts[i] >= lo) & (elts[i] <= hi);                      \
+  }                                                                           \
+                                                                              \
+  static void NAME##_count_if_combine(void* acc, const void* other)           \
+  {                                                                           \
+    ((struct NAME##_count_if_acc*)acc)->count +=                              \
+      ((const struct NAME##_count_if_acc*)other)->count;                      \
+  }                                                                           \
+                                                                              \
+  unsigned NAME##_count_if(NAME* vector, struct ds_pool* pool,                \
+                           TYPE lo, TYPE hi)                                  \
+  {                                                                           \
+    struct NAME##_count_if_acc count = { lo, hi, 0 };                         \
+                                                                              \
+    NAME##_parallel_reduce(vector, pool, NAME##_count_if_chunk,               \
+                           NAME##_count_if_combine, &count, sizeof (count));  \
+    return count.count;                                                       \
+  }
+
+
+/**
+** @brief Find the first element equal to elt. Blocks of VECTOR_LANES
+**  elements are compared at once, and only the block that matches is
+**  searched one element at a time. Each thread of the pool stops at the
+**  first match in its chunk.
+**
+** @return the position of the element, or the size of the vector if there
+**  is none.
+*/
+# define VECTOR_FIND(TYPE, NAME)                                              \
+  struct NAME##_find_acc                                                      \
+  {                                                                           \
+    TYPE elt;                                                                 \
+    const TYPE* found;                                                        \
+  };                                                                          \
+                                                                              \
+  static void NAME##_find_chunk(const TYPE* elts, unsigned n, void* acc)      \
+  {                                                                           \
+    struct NAME##_find_acc* find = acc;                                       \
+    TYPE elt = find->elt;                                                     \
+    unsigned i = 0;                                                           \
+                                                                              \
+    for (; i < n - n % VECTOR_LANES; i += VECTOR_LANES)                       \
+    {                                                                         \
+      int hit = 0;                                                            \
+                                                                              \
+      for (unsigned l = 0; l < VECTOR_LANES; l++)                             \
+        hit |= elts[i + l] == elt;                                            \
+      if (hit)                                                                \
+        break;                                                                \
+    }                                                                         \
+    for (; i < n; i++)                                                        \
+      if (elts[i] == elt)                                                     \
+      {                                                                       \
+        find->found = elts + i;                                               \
+        return;                                                               \
+      }                                                                       \
+  }                                                                           \
+                                                                              \
+  static void NAME##_find_combine(void* acc, const void* other)               \
+  {                                                                           \
+    struct NAME##_find_acc* find = acc;                                       \
+                                                                              \
+    if (!find->found)                                                         \
+      find->found = ((const struct NAME##_find_acc*)other)->found;            \
+  }                                                                           \
+                                                                              \
+  unsigned NAME##_find(NAME* vector, struct ds_pool* pool, TYPE elt)          \
+  {                                                                           \
+    struct NAME##_find_acc find = { elt, NULL };                              \
+                                                                              \
+    NAME##_parallel_reduce(vector, pool, NAME##_find_chunk,                   \
+                           NAME##_find_combine, &find, sizeof (find));        \
+    return find.found ? find.found - vector->array : vector->count;           \
+  }
+
+
+
+/*
+ *
+ * SORTED VECTOR
+ *
+ */
+
+
+/**
+** @brief Ranges of at most VECTOR_INSERTION_SORT elements are sorted by
+**  insertion (by introsort), and buckets of at most VECTOR_RADIX_CUTOFF
+**  elements are not split further (by radix sort). NAME_sort only uses the
+**  threads of the pool for vectors of at least VECTOR_PARALLEL_SORT
+**  elements.
+*/
+# define VECTOR_INSERTION_SORT 24
+# define VECTOR_RADIX_CUTOFF 64
+# ifndef VECTOR_PARALLEL_SORT
+#  define VECTOR_PARALLEL_SORT 65536
+# endif
+
+/**
+** @brief Comparison of numeric elements, used by numeric vectors wherever
+**  the ordered ones use CMP.
+*/
+# define VECTOR_NUMERIC_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+
+/**
+** @brief Ask for the cache line holding p in advance.
+*/
+static inline void vector_prefetch(const void* p)
+{
+# if defined(__GNUC__)
+  __builtin_prefetch(p);
+# else
+  (void)p;
+# endif
+}
+
+
+/**
+** @brief Same as VECTOR_HEADER, for vectors whose elements are ordered by
+**  CMP, a function (or a macro) that returns a negative number, 0 or a
+**  positive number when a is lower, equal or greater than b (see
+**  btree_cmp_int). In addition to the functions of VECTOR_HEADER, the
+**  following ones are declared :
+**
+**    ~ NAME_sort
+**    ~ NAME_lower_bound
+**    ~ NAME_binary_search
+**
+**  CMP is expanded in the loops of the sort and of the search : there is
+**  no call through a pointer per comparison, as with qsort.
+*/
+# define VECTOR_ORDERED_HEADER(TYPE, CMP, NAME)                               \
+  VECTOR_HEADER(TYPE, NAME)                                                   \
+  VECTOR_SORT_HEADER(TYPE, NAME);                                             \
+  VECTOR_LOWER_BOUND_HEADER(TYPE, NAME);                                      \
+  VECTOR_BINARY_SEARCH_HEADER(TYPE, NAME);
+
+
+/**
+** @brief Same as VECTOR_SOURCE, for vectors declared with
+**  VECTOR_ORDERED_HEADER.
+*/
+# define VECTOR_ORDERED_SOURCE(TYPE, CMP, NAME)                               \
+  VECTOR_SOURCE(TYPE, NAME)                                                   \
+  VECTOR_INTROSORT(TYPE, CMP, NAME)                                           \
+  VECTOR_MERGE_JOBS(TYPE, CMP, NAME)                                          \
+  VECTOR_SORT(TYPE, CMP, NAME)                                                \
+  VECTOR_LOWER_BOUND(TYPE, CMP, NAME)                                         \
+  VECTOR_BINARY_SEARCH(TYPE, CMP, NAME)
+
+
+# define VECTOR_SORT_HEADER(TYPE, NAME)                                       \
+  void NAME##_sort(NAME* vector, struct ds_pool* pool)
+
+# define VECTOR_LOWER_BOUND_HEADER(TYPE, NAME)                                \
+  unsigned NAME##_lower_bound(NAME* vector, TYPE elt)
+
+# define VECTOR_BINARY_SEARCH_HEADER(TYPE, NAME)                              \
+  bool NAME##_binary_search(NAME* vector, TYPE elt)
+
+
+/**
+** @brief Introsort of the n elements at elts : quicksort (median of three
+**  pivot, Hoare partition), where the smaller side is sorted first so that
+**  the stack stays in O(log(n)), and which switches to heapsort once depth
+**  partitions went by, so that the worst case stays in O(n log(n)). Small
+**  ranges are left to an insertion sort.
+*/
+# define VECTOR_INTROSORT(TYPE, CMP, NAME)                                    \
+  static void NAME##_insertion_sort(TYPE* elts, size_t n)                     \
+  {                                                                           \
+    TYPE elt;                                                                 \
+    size_t j = 0;                                                             \
+                                                                              \
+    for (size_t i = 1; i < n; i++)                                            \
+    {                                                                         \
+      elt = elts[i];                                                          \
+      for (j = i; j > 0 && CMP(elt, elts[j - 1]) < 0; j--)                    \
+        elts[j] = elts[j - 1];                                                \
+      elts[j] = elt;                                                          \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static void NAME##_sift_down(TYPE* elts, size_t pos, size_t n, TYPE elt)    \
+  {                                                                           \
+    size_t child = 0;                                                         \
+                                                                              \
+    while ((child = 2 * pos + 1) < n)                                         \
+    {                                                                         \
+      if (child + 1 < n && CMP(elts[child], elts[child + 1]) < 0)             \
+        child++;                                                              \
+      if (CMP(elt, elts[child]) >= 0)                                         \
+        break;                                                                \
+      elts[pos] = elts[child];                                                \
+      pos = child;                                                            \
+    }                                                                         \
+    elts[pos] = elt;                                                          \
+  }                                                                           \
+                                                                              \
+  static void NAME##_heapsort(TYPE* elts, size_t n)                           \
+  {                                                                           \
+    TYPE elt;                                                                 \
+                                                                              \
+    for (size_t i = n / 2; i--; )                                             \
+      NAME##_sift_down(elts, i, n, elts[i]);                                  \
+    for (size_t i = n; i-- > 1; )                                             \
+    {                                                                         \
+      elt = elts[i];                                                          \
+      elts[i] = elts[0];                                                      \
+      NAME##_sift_down(elts, 0, i, elt);                                      \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static void NAME##_introsort(TYPE* elts, size_t n, unsigned depth)          \
+  {                                                                           \
+    TYPE pivot;                                                               \
+    TYPE tmp;                                                                 \
+    size_t mid = 0;                                                           \
+    size_t i = 0;                                                             \
+    size_t j = 0;                                                             \
+                                                                              \
+    while (n > VECTOR_INSERTION_SORT)                                         \
+    {                                                                         \
+      if (!depth--)                                                           \
+      {                                                                       \
+        NAME##_heapsort(elts, n);                                             \
+        return;                                                               \
+      }                                                                       \
+                                                                              \
+      mid = (n - 1) / 2;                                                      \
+      if (CMP(elts[mid], elts[0]) < 0)                                        \
+        tmp = elts[0], elts[0] = elts[mid], elts[mid] = tmp;                  \
+      if (CMP(elts[n - 1], elts[mid]) < 0)                                    \
+      {                                                                       \
+        tmp = elts[mid], elts[mid] = elts[n - 1], elts[n - 1] = tmp;          \
+        if (CMP(elts[mid], elts[0]) < 0)                                      \
+          tmp = elts[0], elts[0] = elts[mid], elts[mid] = tmp;                \
+      }                                                                       \
+                                                                              \
+      pivot = elts[mid];                                                      \
+      for (i = 0, j = n - 1; ; i++, j--)                                      \
+      {                                                                       \
+        while (CMP(elts[i], pivot) < 0)                                       \
+          i++;                                                                \
+        while (CMP(pivot, elts[j]) < 0)                                       \
+          j--;                                                                \
+        if (i >= j)                                                           \
+          break;                                                              \
+        tmp = elts[i], elts[i] = elts[j], elts[j] = tmp;                      \
+      }                                                                       \
+                                                                              \
+      if (j + 1 < n - j - 1)                                                  \
+      {                                                                       \
+        NAME##_introsort(elts, j + 1, depth);                                 \
+        elts += j + 1;                                                        \
+        n -= j + 1;                                                           \
+      }                                                                       \
+      else                                                                    \
+      {                                                                       \
+        NAME##_introsort(elts + j + 1, n - j - 1, depth);                     \
+        n = j + 1;                                                            \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    NAME##_insertion_sort(elts, n);                                           \
+  }                                                                           \
+                                                                              \
+  static unsigned NAME##_depth(size_t n)                                      \
+  {                                                                           \
+    unsigned depth = 0;                                                       \
+                                                                              \
+    for (; n > 1; n /= 2)                                                     \
+      depth += 2;                                                             \
+    return depth;                                                             \
+  }
+
+
+/**
+** @brief Parallel sort of ordered vectors, as given to ds_pool_run : each
+**  thread first sorts its chunk of the array (chunks are split as for
+**  NAME_parallel_reduce), then sorted runs of width chunks are merged two
+**  by two from src to dst, width doubling at each round. Every thread
+**  takes part in every round : the output of a merge is split between the
+**  2 * width threads that owned its runs, and each one finds where its
+**  part starts in both runs with a binary search.
+*/
+# define VECTOR_MERGE_JOBS(TYPE, CMP, NAME)                                   \
+  struct NAME##_sort_job                                                      \
+  {                                                                           \
+    TYPE* src;                                                                \
+    TYPE* dst;                                                                \
+    size_t count;                                                             \
+    unsigned width;                                                           \
+  };                                                                          \
+                                                                              \
+  static void NAME##_sort_chunk(void* arg, unsigned index, unsigned threads)  \
+  {                                                                           \
+    struct NAME##_sort_job* job = arg;                                        \
+    size_t first = job->count * index / threads;                              \
+    size_t last = job->count * (index + 1) / threads;                         \
+                                                                              \
+    NAME##_introsort(job->src + first, last - first,                          \
+                     NAME##_depth(last - first));                             \
+  }                                                                           \
+                                                                              \
+  static size_t NAME##_corank(size_t k, const TYPE* a, size_t na,             \
+                              const TYPE* b, size_t nb)                       \
+  {                                                                           \
+    size_t lo = k > nb ? k - nb : 0;                                          \
+    size_t hi = k < na ? k : na;                                              \
+    size_t mid = 0;                                                           \
+                                                                              \
+    while (lo < hi)                                                           \
+    {                                                                         \
+      mid = lo + (hi - lo) / 2;                                               \
+      if (CMP(b[k - mid - 1], a[mid]) < 0)                                    \
+        hi = mid;                                                             \
+      else                                                                    \
+        lo = mid + 1;                                                         \
+    }                                                                         \
+                                                                              \
+    return lo;                                                                \
+  }                                                                           \
+                                                                              \
+  static void NAME##_merge_job(void* arg, unsigned index, unsigned threads)   \
+  {                                                                           \
+    struct NAME##_sort_job* job = arg;                                        \
+    unsigned run = index / (2 * job->width) * (2 * job->width);               \
+    unsigned mid = run + job->width < threads ? run + job->width : threads;   \
+    unsigned end = run + 2 * job->width < threads ? run + 2 * job->width      \
+                                                  : threads;                  \
+    size_t first = job->count * run / threads;                                \
+    size_t na = job->count * mid / threads - first;                           \
+    size_t nb = job->count * end / threads - first - na;                      \
+    const TYPE* a = job->src + first;                                         \
+    const TYPE* b = a + na;                                                   \
+    TYPE* out = job->dst + first;                                             \
+    size_t k = (na + nb) * (index - run) / (end - run);                       \
+    size_t last = (na + nb) * (index - run + 1) / (end - run);                \
+    size_t i = NAME##_corank(k, a, na, b, nb);                                \
+    size_t j = k - i;                                                         \
+                                                                              \
+    for (; k < last && i < na && j < nb; k++)                                 \
+      out[k] = CMP(b[j], a[i]) < 0 ? b[j++] : a[i++];                         \
+    for (; k < last && i < na; k++)                                           \
+      out[k] = a[i++];                                                        \
+    for (; k < last; k++)                                                     \
+      out[k] = b[j++];                                                        \
+  }
+
+
+/**
+** @brief Sort the vector in increasing order according to CMP, with an
+**  introsort (see above). The order of equal elements is not kept.
+**
+**  With a pool of several threads, vectors of at least VECTOR_PARALLEL_SORT
+**  elements are sorted by chunks then merged (see above), which needs a
+**  second array of the size of the vector : if it could not be allocated,
+**  the calling thread sorts the vector alone.
+**
+**  A vector mapped from a snapshot is first copied to the heap.
+*/
+# define VECTOR_SORT(TYPE, CMP, NAME)                                         \
+  void NAME##_sort(NAME* vector, struct ds_pool* pool)                        \
+  {                                                                           \
+    struct NAME##_sort_job job = { NULL, NULL, vector->count, 1 };            \
+    unsigned threads = vector_threads(pool);                                  \
+    TYPE* tmp = NULL;                                                         \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if (NAME##_own(vector))                                                   \
+      return;                                                                 \
+    job.src = vector->array;                                                  \
+    if (threads < 2 || job.count < VECTOR_PARALLEL_SORT                       \
+        || !(job.dst = malloc(job.count * sizeof (TYPE))))                    \
+    {                                                                         \
+      NAME##_introsort(job.src, job.count, NAME##_depth(job.count));          \
+      DS_STATS_STOP(vector, VISIT, stats_start);                              \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    vector_run(pool, NAME##_sort_chunk, &job);                                \
+    for (; job.width < threads; job.width *= 2)                               \
+    {                                                                         \
+      vector_run(pool, NAME##_merge_job, &job);                               \
+      tmp = job.src;                                                          \
+      job.src = job.dst;                                                      \
+      job.dst = tmp;                                                          \
+    }                                                                         \
+                                                                              \
+    if (job.src != vector->array)                                             \
+      memcpy(vector->array, job.src, job.count * sizeof (TYPE));              \
+    free(job.src == vector->array ? job.dst : job.src);                       \
+    DS_STATS_STOP(vector, VISIT, stats_start);                                \
+  }
+
+
+/**
+** @brief Position of the first element of a sorted vector that is not
+**  lower than elt, or the size of the vector if there is none. The search
+**  has no branch to mispredict : the range is halved by a conditional move
+**  at each step, and both elements that the next step may compare are
+**  prefetched, so that the misses of the steps overlap on big vectors.
+*/
+# define VECTOR_LOWER_BOUND(TYPE, CMP, NAME)                                  \
+  unsigned NAME##_lower_bound(NAME* vector, TYPE elt)                         \
+  {                                                                           \
+    const TYPE* base = vector->array;                                         \
+    unsigned n = vector->count;                                               \
+    unsigned half = 0;                                                        \
+                                                                              \
+    DS_STATS_COUNT(vector, ACCESS);                                           \
+    if (!n)                                                                   \
+      return 0;                                                               \
+                                                                              \
+    while (n > 1)                                                             \
+    {                                                                         \
+      half = n / 2;                                                           \
+      vector_prefetch(base + (n - half) / 2);                                 \
+      vector_prefetch(base + half + (n - half) / 2);                          \
+      base = CMP(base[half], elt) < 0 ? base + half : base;                   \
+      n -= half;                                                              \
+    }                                                                         \
+                                                                              \
+    return (base - vector->array) + (CMP(*base, elt) < 0);                    \
+  }
+
+
+/**
+** @brief Whether a sorted vector holds an element equal to elt.
+*/
+# define VECTOR_BINARY_SEARCH(TYPE, CMP, NAME)                                \
+  bool NAME##_binary_search(NAME* vector, TYPE elt)                           \
+  {                                                                           \
+    unsigned pos = NAME##_lower_bound(vector, elt);                           \
+                                                                              \
+    return pos < vector->count && !CMP(vector->array[pos], elt);              \
+  }
+
+
+/**
+** @brief Radix sort of numeric vectors. Each element is mapped to an
+**  unsigned key of 64 bits, in the same order as the elements : the sign
+**  bit of signed integers is flipped, and so is the sign bit of positive
+**  floating point numbers, while every bit of the negative ones is flipped.
+**  NaNs end up before (negative ones) or after (positive ones) every other
+**  element.
+**
+**  The array is then sorted in place one byte of the keys at a time, from
+**  the most significant one (American flag sort) : the elements are counted
+**  by byte value, moved into their bucket by following cycles of swaps,
+**  and each bucket is sorted on the next byte. Small buckets are sorted by
+**  insertion. The leading bytes that are the same in all the keys (the
+**  high bytes of small integers) are skipped.
+*/
+# define VECTOR_RADIX_SORT(TYPE, NAME)                                        \
+  static inline uint64_t NAME##_key(TYPE elt)                                 \
+  {                                                                           \
+    uint64_t sign = (uint64_t)1 << ((8 * sizeof (TYPE) - 1) & 63);            \
+    uint64_t bits = 0;                                                        \
+                                                                              \
+    if (sizeof (TYPE) == 1)                                                   \
+    {                                                                         \
+      uint8_t b;                                                              \
+      memcpy(&b, &elt, 1);                                                    \
+      bits = b;                                                               \
+    }                                                                         \
+    else if (sizeof (TYPE) == 2)                                              \
+    {                                                                         \
+      uint16_t b;                                                             \
+      memcpy(&b, &elt, 2);                                                    \
+      bits = b;                                                               \
+    }                                                                         \
+    else if (sizeof (TYPE) == 4)                                              \
+    {                                                                         \
+      uint32_t b;                                                             \
+      memcpy(&b, &elt, 4);                                                    \
+      bits = b;                                                               \
+    }                                                                         \
+    else                                                                      \
+      memcpy(&bits, &elt, 8);                                                 \
+                                                                              \
+    if ((TYPE)0.5 != 0)                                                       \
+      return bits & sign ? ~bits & (sign | (sign - 1)) : bits | sign;         \
+    if ((TYPE)-1 < (TYPE)1)                                                   \
+      return bits ^ sign;                                                     \
+    return bits;                                                              \
+  }                                                                           \
+                                                                              \
+  static void NAME##_radix_pass(TYPE* elts, unsigned n, unsigned shift,       \
+                                unsigned* bounds)                             \
+  {                                                                           \
+    unsigned heads[256];                                                      \
+    unsigned digit = 0;                                                       \
+    TYPE elt;                                                                 \
+    TYPE other;                                                               \
+                                                                              \
+    memset(bounds, 0, 257 * sizeof (unsigned));                               \
+    for (unsigned i = 0; i < n; i++)                                          \
+      bounds[(NAME##_key(elts[i]) >> shift & 255) + 1]++;                     \
+    for (unsigned b = 0; b < 256; b++)                                        \
+      if (bounds[b + 1] == n)                                                 \
+      {                                                                       \
+        for (unsigned c = b + 1; c < 257; c++)                                \
+          bounds[c] = n;                                                      \
+        return;                                                               \
+      }                                                                       \
+    for (unsigned b = 0; b < 256; b++)                                        \
+      bounds[b + 1] += bounds[b];                                             \
+    memcpy(heads, bounds, sizeof (heads));                                    \
+                                                                              \
+    for (unsigned b = 0; b < 256; b++)                                        \
+      for (; heads[b] < bounds[b + 1]; heads[b]++)                            \
+      {                                                                       \
+        elt = elts[heads[b]];                                                 \
+        while ((digit = NAME##_key(elt) >> shift & 255) != b)                 \
+        {                                                                     \
+          other = elts[heads[digit]];                                         \
+          elts[heads[digit]++] = elt;                                         \
+          elt = other;                                                        \
+        }                                                                     \
+        elts[heads[b]] = elt;                                                 \
+      }                                                                       \
+  }                                                                           \
+                                                                              \
+  static void NAME##_radix(TYPE* elts, unsigned n, unsigned shift)            \
+  {                                                                           \
+    unsigned bounds[257];                                                     \
+    TYPE elt;                                                                 \
+    unsigned j = 0;                                                           \
+                                                                              \
+    if (n <= VECTOR_RADIX_CUTOFF)                                             \
+    {                                                                         \
+      for (unsigned i = 1; i < n; i++)                                        \
+      {                                                                       \
+        elt = elts[i];                                                        \
+        for (j = i; j > 0 && NAME##_key(elt) < NAME##_key(elts[j - 1]); j--)  \
+          elts[j] = elts[j - 1];                                              \
+        elts[j] = elt;                                                        \
+      }                                                                       \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    NAME##_radix_pass(elts, n, shift, bounds);                                \
+    if (shift)                                                                \
+      for (unsigned b = 0; b < 256; b++)                                      \
+        if (bounds[b + 1] - bounds[b] > 1)                                    \
+          NAME##_radix(elts + bounds[b], bounds[b + 1] - bounds[b],           \
+                       shift - 8);                                            \
+  }                                                                           \
+                                                                              \
+  struct NAME##_radix_acc                                                     \
+  {                                                                           \
+    uint64_t first;                                                           \
+    uint64_t diff;                                                            \
+  };                                                                          \
+                                                                              \
+  static void NAME##_radix_chunk(const TYPE* elts, unsigned n, void* acc)     \
+  {                                                                           \
+    struct NAME##_radix_acc* result = acc;                                    \
+    uint64_t lanes[VECTOR_LANES] = { 0 };                                     \
+    uint64_t first = result->first;                                           \
+    unsigned i = 0;                                                           \
+                                                                              \
+    for (; i < n - n % VECTOR_LANES; i += VECTOR_LANES)                       \
+      for (unsigned l = 0; l < VECTOR_LANES; l++)                             \
+        lanes[l] |= NAME##_key(elts[i + l]) ^ first;                          \
+    for (unsigned l = 0; l < VECTOR_LANES; l++)                               \
+      result->diff |= lanes[l];                                               \
+    for (; i < n; i++)                                                        \
+      result->diff |= NAME##_key(elts[i]) ^ first;                            \
+  }                                                                           \
+                                                                              \
+  static void NAME##_radix_combine(void* acc, const void* other)              \
+  {                                                                           \
+    ((struct NAME##_radix_acc*)acc)->diff |=                                  \
+      ((const struct NAME##_radix_acc*)other)->diff;                          \
+  }                                                                           \
+                                                                              \
+  struct NAME##_radix_job                                                     \
+  {                                                                           \
+    TYPE* elts;                                                               \
+    unsigned* bounds;                                                         \
+    unsigned shift;                                                           \
+    vector_counter next;                                                      \
+  };                                                                          \
+                                                                              \
+  static void NAME##_radix_job(void* arg, unsigned index, unsigned threads)   \
+  {                                                                           \
+    struct NAME##_radix_job* job = arg;                                       \
+    unsigned* bounds = job->bounds;                                           \
+                                                                              \
+    (void)index;                                                              \
+    (void)threads;                                                            \
+    /* job->next++ is an atomic increment with VECTOR_THREADS */              \
+    for (unsigned b = job->next++; b < 256; b = job->next++)                  \
+      if (bounds[b + 1] - bounds[b] > 1)                                      \
+        NAME##_radix(job->elts + bounds[b], bounds[b + 1] - bounds[b],        \
+                     job->shift - 8);                                         \
+  }
+
+
+/**
+** @brief Sort the vector in increasing order with the radix sort above
+**  (TYPEs of more than 8 bytes, such as long double, are sorted by
+**  introsort instead).
+**
+**  With a pool of several threads, vectors of at least VECTOR_PARALLEL_SORT
+**  elements are split into buckets on their first distinct byte by the
+**  calling thread, then the threads take the buckets one after the other
+**  and sort them. No memory is allocated.
+**
+**  A vector mapped from a snapshot is first copied to the heap.
+*/
+# define VECTOR_NUMERIC_SORT(TYPE, NAME)                                      \
+  void NAME##_sort(NAME* vector, struct ds_pool* pool)                        \
+  {                                                                           \
+    struct NAME##_radix_acc keys = { 0, 0 };                                  \
+    struct NAME##_radix_job job;                                              \
+    unsigned bounds[257];                                                     \
+    unsigned shift = 56;                                                      \
+    DS_STATS_START(stats_start);                                              \
+                                                                              \
+    if (NAME##_own(vector))                                                   \
+      return;                                                                 \
+    if (sizeof (TYPE) > 8 || vector->count < 2)                               \
+    {                                                                         \
+      NAME##_introsort(vector->array, vector->count,                          \
+                       NAME##_depth(vector->count));                          \
+      DS_STATS_STOP(vector, VISIT, stats_start);                              \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    keys.first = NAME##_key(vector->array[0]);                                \
+    NAME##_reduce(vector, pool, NAME##_radix_chunk, NAME##_radix_combine,     \
+                  &keys, sizeof (keys));                                      \
+    if (!keys.diff)                                                           \
+    {                                                                         \
+      DS_STATS_STOP(vector, VISIT, stats_start);                              \
+      return;                                                                 \
+    }                                                                         \
+    while (!(keys.diff >> shift))                                             \
+      shift -= 8;                                                             \
+                                                                              \
+    if (vector_threads(pool) < 2 || vector->count < VECTOR_PARALLEL_SORT)     \
+    {                                                                         \
+      NAME##_radix(vector->array, vector->count, shift);                      \
+      DS_STATS_STOP(vector, VISIT, stats_start);                              \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    NAME##_radix_pass(vector->array, vector->count, shift, bounds);           \
+    if (shift)                                                                \
+    {                                                                         \
+      job.elts = vector->array;                                               \
+      job.bounds = bounds;                                                    \
+      job.shift = shift;                                                      \
+      job.next = 0;                                                           \
+      vector_run(pool, NAME##_radix_job, &job);                               \
+    }                                                                         \
+    DS_STATS_STOP(vector, VISIT, stats_start);                                \
   }
 
 #endif /* !VECTOR_HXX_ */